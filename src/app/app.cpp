@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2025  Igara Studio S.A.
+// Copyright (C) 2018-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -15,6 +15,7 @@
 #include "app/app_mod.h"
 #include "app/check_update.h"
 #include "app/cli/app_options.h"
+#include "app/cli/batch_server.h"
 #include "app/cli/cli_processor.h"
 #include "app/cli/default_cli_delegate.h"
 #include "app/cli/preview_cli_delegate.h"
@@ -56,6 +57,7 @@
 #include "app/ui/workspace.h"
 #include "app/ui_context.h"
 #include "app/util/clipboard.h"
+#include "base/chrono.h"
 #include "base/exception.h"
 #include "base/fs.h"
 #include "base/platform.h"
@@ -68,6 +70,7 @@
 #include "os/system.h"
 #include "os/window.h"
 #include "render/render.h"
+#include "trace/trace.h"
 #include "ui/intern.h"
 #include "ui/ui.h"
 #include "updater/user_agent.h"
@@ -103,6 +106,27 @@ namespace app {
 
 using namespace ui;
 
+namespace {
+
+// Measures the time to initialize each part of the program. Phases
+// are reported with --verbose (and recorded as zones with --trace),
+// so we can see what makes the startup slow (e.g. in CLI runs).
+class StartupPhase {
+public:
+  explicit StartupPhase(const char* name) : m_name(name), m_zone(name) {}
+  ~StartupPhase()
+  {
+    LOG(INFO, "APP: %s initialized in %.2f ms\n", m_name, m_chrono.elapsed() * 1000.0);
+  }
+
+private:
+  const char* m_name;
+  base::Chrono m_chrono;
+  trace::Zone m_zone;
+};
+
+} // anonymous namespace
+
 #ifdef ENABLE_SCRIPTING
 
 namespace {
@@ -133,10 +157,13 @@ public:
   FileSystemModule m_file_system_module;
   Extensions m_extensions;
   Strings m_strings; // Load main language (after loading the extensions)
-  tools::ToolBox m_toolbox;
-  tools::ActiveToolManager m_activeToolManager;
+  // The tools and the recent files are created on demand, so CLI
+  // runs that don't use them (e.g. just exporting files) don't have
+  // to load the tools from gui.xml or the list of recent files.
+  std::unique_ptr<tools::ToolBox> m_toolbox;
+  std::unique_ptr<tools::ActiveToolManager> m_activeToolManager;
   Commands m_commands;
-  RecentFiles m_recent_files;
+  std::unique_ptr<RecentFiles> m_recent_files;
   InputChain m_inputChain;
   Clipboard m_clipboard;
 #ifdef ENABLE_DATA_RECOVERY
@@ -149,8 +176,6 @@ public:
   Modules(const bool createLogInDesktop, Preferences& pref)
     : m_loggerModule(createLogInDesktop)
     , m_strings(pref, m_extensions)
-    , m_activeToolManager(&m_toolbox)
-    , m_recent_files(pref.general.recentItems())
 #ifdef ENABLE_DATA_RECOVERY
     , m_recovery(nullptr)
 #endif
@@ -164,6 +189,32 @@ public:
 #endif
   }
 
+  tools::ToolBox* toolBox()
+  {
+    if (!m_toolbox) {
+      const StartupPhase phase("Tools");
+      m_toolbox = std::make_unique<tools::ToolBox>();
+      m_activeToolManager = std::make_unique<tools::ActiveToolManager>(m_toolbox.get());
+    }
+    return m_toolbox.get();
+  }
+
+  tools::ActiveToolManager* activeToolManager()
+  {
+    toolBox();
+    return m_activeToolManager.get();
+  }
+
+  RecentFiles* recentFiles()
+  {
+    if (!m_recent_files) {
+      const StartupPhase phase("Recent files");
+      m_recent_files =
+        std::make_unique<RecentFiles>(Preferences::instance().general.recentItems());
+    }
+    return m_recent_files.get();
+  }
+
   app::crash::DataRecovery* recovery()
   {
 #ifdef ENABLE_DATA_RECOVERY
@@ -238,6 +289,7 @@ App::App(AppMod* mod)
   , m_legacy(nullptr)
   , m_isGui(false)
   , m_isShell(false)
+  , m_isBatchServer(false)
   , m_backupIndicator(nullptr)
 #ifdef ENABLE_SCRIPTING
   , m_engine(new script::Engine)
@@ -249,6 +301,7 @@ App::App(AppMod* mod)
 
 int App::initialize(const AppOptions& options)
 {
+  const base::Chrono startupChrono;
   const os::SystemRef system = os::System::instance();
 
   // Without Skia backend we don't have GUI.
@@ -273,7 +326,22 @@ int App::initialize(const AppOptions& options)
 #endif
 
   m_isShell = options.startShell();
-  m_coreModules = std::make_unique<CoreModules>();
+  m_isBatchServer = options.startBatchServer();
+
+  bool createLogInDesktop = false;
+  switch (options.verboseLevel()) {
+    case AppOptions::kNoVerbose: base::set_log_level(ERROR); break;
+    case AppOptions::kVerbose:   base::set_log_level(INFO); break;
+    case AppOptions::kHighlyVerbose:
+      base::set_log_level(VERBOSE);
+      createLogInDesktop = true;
+      break;
+  }
+
+  {
+    const StartupPhase phase("Core modules");
+    m_coreModules = std::make_unique<CoreModules>();
+  }
 
   auto& pref = preferences();
 
@@ -311,17 +379,19 @@ int App::initialize(const AppOptions& options)
   if (m_isGui)
     m_uiSystem.reset(new ui::UISystem);
 
-  bool createLogInDesktop = false;
-  switch (options.verboseLevel()) {
-    case AppOptions::kNoVerbose: base::set_log_level(ERROR); break;
-    case AppOptions::kVerbose:   base::set_log_level(INFO); break;
-    case AppOptions::kHighlyVerbose:
-      base::set_log_level(VERBOSE);
-      createLogInDesktop = true;
-      break;
+  // Record hot paths from the beginning with --trace <filename>, the
+  // trace is saved when the program exits.
+  for (const auto& value : options.values()) {
+    if (value.option() == &options.trace()) {
+      m_traceFilename = value.value();
+      trace::start();
+    }
   }
 
-  initialize_color_spaces(pref);
+  {
+    const StartupPhase phase("Color spaces");
+    initialize_color_spaces(pref);
+  }
 
 #ifdef ENABLE_DRM
   LOG("APP: Initializing DRM...\n");
@@ -335,10 +405,18 @@ int App::initialize(const AppOptions& options)
 #endif
 
   // Load modules
-  m_modules = std::make_unique<Modules>(createLogInDesktop, pref);
-  m_legacy = std::make_unique<LegacyModules>(isGui() ? REQUIRE_INTERFACE : 0);
-  m_appMenus = std::make_unique<AppMenus>(recentFiles());
-  m_brushes = std::make_unique<AppBrushes>();
+  {
+    const StartupPhase phase("Modules");
+    m_modules = std::make_unique<Modules>(createLogInDesktop, pref);
+  }
+  {
+    const StartupPhase phase("Legacy modules");
+    m_legacy = std::make_unique<LegacyModules>(isGui() ? REQUIRE_INTERFACE : 0);
+  }
+  // In CLI mode the recent files and brushes are loaded on demand
+  m_appMenus = std::make_unique<AppMenus>(isGui() ? recentFiles() : nullptr);
+  if (isGui())
+    brushes();
 
   // Data recovery is enabled only in GUI mode
   if (isGui() && pref.general.dataRecovery())
@@ -349,7 +427,10 @@ int App::initialize(const AppOptions& options)
 
   // Load or create the default palette, or migrate the default
   // palette from an old format palette to the new one, etc.
-  load_default_palette();
+  {
+    const StartupPhase phase("Default palette");
+    load_default_palette();
+  }
 
   // Initialize GUI interface
   if (isGui()) {
@@ -368,10 +449,13 @@ int App::initialize(const AppOptions& options)
     manager->invalidate();
 
     // Create the main window.
-    m_mainWindow.reset(new MainWindow);
-    m_mainWindow->initialize();
-    if (m_mod)
-      m_mod->modMainWindow(m_mainWindow.get());
+    {
+      const StartupPhase phase("Main window");
+      m_mainWindow.reset(new MainWindow);
+      m_mainWindow->initialize();
+      if (m_mod)
+        m_mod->modMainWindow(m_mainWindow.get());
+    }
 
     // Data recovery is enabled only in GUI mode
     if (pref.general.dataRecovery())
@@ -405,9 +489,17 @@ int App::initialize(const AppOptions& options)
 #ifdef ENABLE_SCRIPTING
   // Call the init() function from all plugins
   LOG("APP: Initializing scripts...\n");
-  extensions().executeInitActions();
+  {
+    const StartupPhase phase("Scripts");
+    extensions().executeInitActions();
+  }
 #endif
 
+  LOG(INFO,
+      "APP: Startup done in %.2f ms (%s mode)\n",
+      startupChrono.elapsed() * 1000.0,
+      isGui() ? "GUI" : "CLI");
+
   // Process options
   LOG("APP: Processing options...\n");
   int code;
@@ -582,6 +674,12 @@ void App::run(const bool runGuiManager)
   }
 #endif // ENABLE_SCRIPTING
 
+  // Process batch jobs from stdin.
+  if (m_isBatchServer) {
+    BatchServer server(context());
+    server.run(std::cin, std::cout);
+  }
+
   // ----------------------------------------------------------------------
 
 #ifdef ENABLE_SCRIPTING
@@ -614,6 +712,12 @@ App::~App()
     LOG("APP: Exit\n");
     ASSERT(m_instance == this);
 
+    if (!m_traceFilename.empty()) {
+      trace::stop();
+      if (!trace::save_chrome_json(m_traceFilename))
+        LOG(ERROR, "APP: Cannot save trace file %s\n", m_traceFilename.c_str());
+    }
+
 #ifdef ENABLE_SCRIPTING
     // Destroy scripting engine calling a method (instead of using
     // reset()) because we need to keep the "m_engine" pointer valid
@@ -693,23 +797,33 @@ bool App::isPortable()
 tools::ToolBox* App::toolBox() const
 {
   ASSERT(m_modules != NULL);
-  return &m_modules->m_toolbox;
+  return m_modules->toolBox();
 }
 
 tools::Tool* App::activeTool() const
 {
-  return m_modules->m_activeToolManager.activeTool();
+  return m_modules->activeToolManager()->activeTool();
 }
 
 tools::ActiveToolManager* App::activeToolManager() const
 {
-  return &m_modules->m_activeToolManager;
+  return m_modules->activeToolManager();
 }
 
 RecentFiles* App::recentFiles() const
 {
   ASSERT(m_modules != nullptr);
-  return &m_modules->m_recent_files;
+  return m_modules->recentFiles();
+}
+
+AppBrushes& App::brushes()
+{
+  // User brushes are loaded on demand in CLI mode
+  if (!m_brushes) {
+    const StartupPhase phase("Brushes");
+    m_brushes = std::make_unique<AppBrushes>();
+  }
+  return *m_brushes;
 }
 
 Workspace* App::workspace() const
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -98,11 +98,7 @@ public:
   Extensions& extensions() const;
   crash::DataRecovery* dataRecovery() const;
 
-  AppBrushes& brushes()
-  {
-    ASSERT(m_brushes.get());
-    return *m_brushes;
-  }
+  AppBrushes& brushes();
 
   void showNotification(INotificationDelegate* del);
   void showBackupNotification(bool state);
@@ -139,6 +135,7 @@ private:
   std::unique_ptr<AppMenus> m_appMenus;
   bool m_isGui;
   bool m_isShell;
+  bool m_isBatchServer;
 #if !LAF_SKIA
   bool m_showCliOnlyWarning = false;
 #endif
@@ -156,6 +153,9 @@ private:
   // Set the memory dump filename to show in the Preferences dialog
   // or the "send crash" dialog. It's set by the SendCrash class.
   std::string m_memoryDumpFilename;
+
+  // File where the trace is saved at exit (--trace option).
+  std::string m_traceFilename;
 };
 
 void app_refresh_screen();
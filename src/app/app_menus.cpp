@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2025  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -313,7 +313,9 @@ AppMenus::AppMenus(RecentFiles* recentFiles) : m_recentFilesPlaceholder(nullptr)
 {
   ASSERT(s_instance == nullptr);
   s_instance = this;
-  m_recentFilesConn = recentFiles->Changed.connect([this] { rebuildRecentList(); });
+  // The recent files can be nullptr in CLI mode (as there are no menus)
+  if (recentFiles)
+    m_recentFilesConn = recentFiles->Changed.connect([this] { rebuildRecentList(); });
 }
 
 AppMenus::~AppMenus()
@@ -21,6 +21,7 @@ AppOptions::AppOptions(int argc, const char* argv[])
   : m_exeName(base::get_file_name(argv[0]))
   , m_startUI(true)
   , m_startShell(false)
+  , m_startBatchServer(false)
   , m_previewCLI(false)
   , m_showHelp(false)
   , m_showVersion(false)
@@ -29,6 +30,9 @@ AppOptions::AppOptions(int argc, const char* argv[])
   , m_shell(m_po.add("shell").description("Start an interactive console to execute scripts"))
 #endif
   , m_batch(m_po.add("batch").mnemonic('b').description("Do not start the UI"))
+  , m_batchServer(m_po.add("batch-server")
+                    .description("Do not start the UI and process jobs from stdin,\n"
+                                 "one command line per job"))
   , m_preview(m_po.add("preview").mnemonic('p').description(
       "Do not execute actions, just print what will be\ndone"))
   , m_saveAs(m_po.add("save-as")
@@ -168,6 +172,10 @@ AppOptions::AppOptions(int argc, const char* argv[])
       m_po.add("export-tileset").description("Export only tilesets from visible tilemap layers"))
   , m_verbose(m_po.add("verbose").mnemonic('v').description("Explain what is being done"))
   , m_debug(m_po.add("debug").description("Extreme verbose mode and\ncopy log to desktop"))
+  , m_trace(m_po.add("trace")
+              .requiresValue("<filename>")
+              .description("Record hot paths (render, save, tools, etc.)\nand save them "
+                           "as a Chrome trace JSON file\nat exit"))
 #ifdef ENABLE_STEAM
   , m_noInApp(m_po.add("noinapp").description(
       "Disable \"in game\" visibility on Steam\nDoesn't count playtime"))
@@ -189,11 +197,13 @@ AppOptions::AppOptions(int argc, const char* argv[])
 #ifdef ENABLE_SCRIPTING
     m_startShell = m_po.enabled(m_shell);
 #endif
+    m_startBatchServer = m_po.enabled(m_batchServer);
     m_previewCLI = m_po.enabled(m_preview);
     m_showHelp = m_po.enabled(m_help);
     m_showVersion = m_po.enabled(m_version);
 
-    if (m_startShell || m_showHelp || m_showVersion || m_po.enabled(m_batch)) {
+    if (m_startShell || m_startBatchServer || m_showHelp || m_showVersion ||
+        m_po.enabled(m_batch)) {
       m_startUI = false;
     }
   }
@@ -36,6 +36,7 @@ public:
 
   bool startUI() const { return m_startUI; }
   bool startShell() const { return m_startShell; }
+  bool startBatchServer() const { return m_startBatchServer; }
   bool previewCLI() const { return m_previewCLI; }
   bool showHelp() const { return m_showHelp; }
   bool showVersion() const { return m_showVersion; }
@@ -94,6 +95,7 @@ public:
   const Option& listSlices() const { return m_listSlices; }
   const Option& oneFrame() const { return m_oneFrame; }
   const Option& exportTileset() const { return m_exportTileset; }
+  const Option& trace() const { return m_trace; }
 
   bool hasExporterParams() const;
 #ifdef ENABLE_STEAM
@@ -110,6 +112,7 @@ private:
   base::ProgramOptions m_po;
   bool m_startUI;
   bool m_startShell;
+  bool m_startBatchServer;
   bool m_previewCLI;
   bool m_showHelp;
   bool m_showVersion;
@@ -119,6 +122,7 @@ private:
   Option& m_shell;
 #endif
   Option& m_batch;
+  Option& m_batchServer;
   Option& m_preview;
   Option& m_saveAs;
   Option& m_palette;
@@ -173,6 +177,7 @@ private:
 
   Option& m_verbose;
   Option& m_debug;
+  Option& m_trace;
 #ifdef ENABLE_STEAM
   Option& m_noInApp;
 #endif
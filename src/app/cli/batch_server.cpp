@@ -0,0 +1,131 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/cli/batch_server.h"
+
+#include "app/cli/app_options.h"
+#include "app/cli/cli_processor.h"
+#include "app/cli/default_cli_delegate.h"
+#include "app/context.h"
+#include "app/doc.h"
+#include "base/log.h"
+#include "base/trim_string.h"
+#include "ver/info.h"
+
+#include <istream>
+#include <ostream>
+
+namespace app {
+
+BatchServer::BatchServer(Context* ctx) : m_ctx(ctx)
+{
+}
+
+void BatchServer::run(std::istream& in, std::ostream& out)
+{
+  out << "ready" << std::endl;
+
+  std::string line;
+  while (std::getline(in, line)) {
+    base::trim_string(line, line);
+    if (line.empty() || line[0] == '#')
+      continue;
+    if (line == "exit")
+      break;
+
+    LOG(INFO, "BATCH: Processing job: %s\n", line.c_str());
+
+    int code = 0;
+    std::string error;
+    try {
+      code = processJob(ParseJobArgs(line));
+    }
+    catch (const std::exception& ex) {
+      error = ex.what();
+    }
+    closeAllDocs();
+
+    if (error.empty())
+      out << "done " << code << std::endl;
+    else
+      out << "error " << error << std::endl;
+  }
+}
+
+// static
+std::vector<std::string> BatchServer::ParseJobArgs(const std::string& line)
+{
+  std::vector<std::string> args;
+  std::string arg;
+  bool inArg = false;
+  bool inQuotes = false;
+
+  for (std::size_t i = 0; i < line.size(); ++i) {
+    const char chr = line[i];
+    if (inQuotes) {
+      if (chr == '"')
+        inQuotes = false;
+      else if (chr == '\\' && i + 1 < line.size() && (line[i + 1] == '"' || line[i + 1] == '\\'))
+        arg.push_back(line[++i]);
+      else
+        arg.push_back(chr);
+    }
+    else if (chr == '"') {
+      inArg = true;
+      inQuotes = true;
+    }
+    else if (chr == ' ' || chr == '\t') {
+      if (inArg) {
+        args.push_back(arg);
+        arg.clear();
+        inArg = false;
+      }
+    }
+    else {
+      inArg = true;
+      arg.push_back(chr);
+    }
+  }
+  if (inArg)
+    args.push_back(arg);
+  return args;
+}
+
+int BatchServer::processJob(const std::vector<std::string>& args)
+{
+  // Jobs are executed in batch mode
+  std::vector<const char*> argv;
+  argv.push_back(get_app_name());
+  argv.push_back("--batch");
+  for (const auto& arg : args)
+    argv.push_back(arg.c_str());
+
+  AppOptions options(int(argv.size()), argv.data());
+  DefaultCliDelegate delegate;
+  CliProcessor cli(&delegate, options);
+  cli.setDocCache(&m_docCache);
+  return cli.process(m_ctx);
+}
+
+void BatchServer::closeAllDocs()
+{
+  // Copy the list because closing a document removes it from the
+  // context.
+  std::vector<Doc*> docs;
+  for (Doc* doc : m_ctx->documents())
+    docs.push_back(doc);
+
+  for (Doc* doc : docs) {
+    doc->close();
+    delete doc;
+  }
+}
+
+} // namespace app
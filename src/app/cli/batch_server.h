@@ -0,0 +1,58 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_CLI_BATCH_SERVER_H_INCLUDED
+#define APP_CLI_BATCH_SERVER_H_INCLUDED
+#pragma once
+
+#include "app/cli/doc_cache.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace app {
+
+class Context;
+
+// Processes jobs from an input stream (stdin with --batch-server)
+// reusing the same initialized app, scripting engine, and a cache of
+// the loaded documents. This avoids paying the whole startup time for
+// each small --batch job.
+//
+// Each line of the input is a job with the same arguments of the
+// command line (e.g. "--script file.lua --script-param a=b" or
+// "file.aseprite --save-as file.png"). When a job finishes, all its
+// documents are closed and the following line is written in the
+// output:
+//
+//   done <exit code>
+//   error <message>
+//
+// Empty lines and lines starting with # are ignored, and "exit"
+// stops the server.
+class BatchServer {
+public:
+  explicit BatchServer(Context* ctx);
+
+  void run(std::istream& in, std::ostream& out);
+
+  // Splits a job line into arguments. Arguments are separated by
+  // spaces, and double quotes can be used to include spaces (and
+  // escaped \" or \\ characters) in one argument.
+  static std::vector<std::string> ParseJobArgs(const std::string& line);
+
+private:
+  int processJob(const std::vector<std::string>& args);
+  void closeAllDocs();
+
+  Context* m_ctx;
+  DocCache m_docCache;
+};
+
+} // namespace app
+
+#endif
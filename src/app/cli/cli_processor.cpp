@@ -13,6 +13,7 @@
 
 #include "app/cli/app_options.h"
 #include "app/cli/cli_delegate.h"
+#include "app/cli/doc_cache.h"
 #include "app/commands/commands.h"
 #include "app/commands/params.h"
 #include "app/console.h"
@@ -645,24 +646,37 @@ bool CliProcessor::openFile(Context* ctx, CliOpenFile& cof)
   m_delegate->beforeOpenFile(cof);
 
   Doc* oldDoc = ctx->activeDocument();
+  Doc* doc = nullptr;
+  base::paths usedFiles;
 
-  m_batch.open(ctx, cof.filename, cof.oneFrame);
+  if (m_docCache && !cof.oneFrame)
+    doc = m_docCache->open(ctx, cof.filename, usedFiles);
+
+  if (doc) {
+    ctx->setActiveDocument(doc);
+  }
+  else {
+    m_batch.open(ctx, cof.filename, cof.oneFrame);
+    usedFiles = m_batch.usedFiles();
+
+    doc = ctx->activeDocument();
+    // If the active document is equal to the previous one, it
+    // means that we couldn't open this specific document.
+    if (doc == oldDoc)
+      doc = nullptr;
+    else if (doc && m_docCache && !cof.oneFrame)
+      m_docCache->add(cof.filename, doc, usedFiles);
+  }
 
   // Mark used file names as "already processed" so we don't try to
   // open then again
-  for (const auto& usedFn : m_batch.usedFiles()) {
+  for (const auto& usedFn : usedFiles) {
     auto fn = base::normalize_path(usedFn);
     m_usedFiles.insert(fn);
 
     os::System::instance()->markCliFileAsProcessed(fn);
   }
 
-  Doc* doc = ctx->activeDocument();
-  // If the active document is equal to the previous one, it
-  // means that we couldn't open this specific document.
-  if (doc == oldDoc)
-    doc = nullptr;
-
   cof.document = doc;
 
   if (doc) {
@@ -28,6 +28,7 @@ namespace app {
 
 class AppOptions;
 class Context;
+class DocCache;
 class DocExporter;
 
 class CliProcessor {
@@ -35,6 +36,10 @@ public:
   CliProcessor(CliDelegate* delegate, const AppOptions& options);
   int process(Context* ctx);
 
+  // Documents are taken from/stored in the given cache instead of
+  // loading them each time (used by the batch server).
+  void setDocCache(DocCache* docCache) { m_docCache = docCache; }
+
   // Public so it can be tested
   static void FilterLayers(const doc::Sprite* sprite,
                            // By value because these vectors will be modified inside
@@ -61,6 +66,7 @@ private:
   // load a sequence of files) so we don't ask for them again.
   std::set<std::string> m_usedFiles;
   OpenBatchOfFiles m_batch;
+  DocCache* m_docCache = nullptr;
 };
 
 } // namespace app
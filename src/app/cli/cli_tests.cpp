@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2019  Igara Studio S.A.
+// Copyright (C) 2018-2026  Igara Studio S.A.
 // Copyright (C) 2016-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -8,10 +8,19 @@
 #include "tests/app_test.h"
 
 #include "app/cli/app_options.h"
+#include "app/cli/batch_server.h"
 #include "app/cli/cli_processor.h"
+#include "app/cli/doc_cache.h"
+#include "app/context.h"
+#include "app/doc.h"
 #include "app/doc_exporter.h"
+#include "app/file/file.h"
+#include "base/fs.h"
+#include "doc/sprite.h"
 
+#include <fstream>
 #include <initializer_list>
+#include <iterator>
 
 using namespace app;
 
@@ -92,3 +101,73 @@ TEST(Cli, Version)
   p.process(nullptr);
   EXPECT_TRUE(d.versionWasShown());
 }
+
+TEST(Cli, BatchServer)
+{
+  auto a = args({ "--batch-server" });
+  EXPECT_TRUE(a->startBatchServer());
+  EXPECT_FALSE(a->startUI());
+}
+
+TEST(Cli, BatchServerJobArgs)
+{
+  using Args = std::vector<std::string>;
+  EXPECT_EQ(Args(), BatchServer::ParseJobArgs(""));
+  EXPECT_EQ(Args({ "a.aseprite", "--save-as", "b.png" }),
+            BatchServer::ParseJobArgs("a.aseprite  --save-as\tb.png"));
+  EXPECT_EQ(Args({ "a.aseprite", "--save-as", "b.png" }),
+            BatchServer::ParseJobArgs("a.aseprite \t--save-as b.png "));
+  EXPECT_EQ(Args({ "--script-param", "name=a b", "c d.png" }),
+            BatchServer::ParseJobArgs("--script-param name=\"a b\" \"c d.png\""));
+  EXPECT_EQ(Args({ "say \"hi\"", "" }), BatchServer::ParseJobArgs("\"say \\\"hi\\\"\" \"\""));
+}
+
+static std::vector<char> read_file_bytes(const std::string& fn)
+{
+  std::ifstream f(fn, std::ios::binary);
+  return std::vector<char>((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+}
+
+TEST(Cli, DocCacheSameOutput)
+{
+  app::Context ctx;
+  const std::string fn = "_test_doc_cache.aseprite";
+  {
+    std::unique_ptr<Doc> doc(ctx.documents().add(32, 16, doc::ColorMode::RGB, 256));
+    doc->sprite()->setPixelRatio(doc::PixelRatio(2, 1));
+    doc->sprite()->setGridBounds(gfx::Rect(1, 2, 8, 4));
+    doc->setFilename(fn);
+    save_document(&ctx, doc.get());
+    doc->close();
+  }
+
+  std::unique_ptr<Doc> loaded(load_document(&ctx, fn));
+  ASSERT_TRUE(loaded != nullptr);
+
+  DocCache cache;
+  base::paths usedFiles;
+  cache.add(fn, loaded.get(), { fn });
+  std::unique_ptr<Doc> cached(cache.open(&ctx, fn, usedFiles));
+  ASSERT_TRUE(cached != nullptr);
+  EXPECT_EQ(base::paths({ fn }), usedFiles);
+  EXPECT_EQ(loaded->sprite()->pixelRatio(), cached->sprite()->pixelRatio());
+  EXPECT_EQ(loaded->sprite()->gridBounds(), cached->sprite()->gridBounds());
+  EXPECT_EQ(loaded->formatOptions(), cached->formatOptions());
+  EXPECT_EQ(loaded->isAssociatedToFile(), cached->isAssociatedToFile());
+  EXPECT_EQ(loaded->isReadOnly(), cached->isReadOnly());
+
+  // Saving the cached document must give the same file as saving the
+  // document loaded from the file
+  const std::string loadedFn = "_test_doc_cache_loaded.aseprite";
+  const std::string cachedFn = "_test_doc_cache_cached.aseprite";
+  loaded->setFilename(loadedFn);
+  save_document(&ctx, loaded.get());
+  cached->setFilename(cachedFn);
+  save_document(&ctx, cached.get());
+  EXPECT_EQ(read_file_bytes(loadedFn), read_file_bytes(cachedFn));
+
+  loaded->close();
+  cached->close();
+  for (const auto& f : { fn, loadedFn, cachedFn })
+    base::delete_file(f);
+}
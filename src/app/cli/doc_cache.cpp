@@ -0,0 +1,127 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/cli/doc_cache.h"
+
+#include "app/context.h"
+#include "app/doc.h"
+#include "base/fs.h"
+#include "doc/sprite.h"
+
+#include <memory>
+
+namespace app {
+
+// Doc::duplicate() doesn't copy all the state of the document (e.g.
+// the pixel ratio or the format options), so we copy the rest here to
+// get the same document (and the same output) that we get loading the
+// file again.
+static Doc* copy_doc(const Doc* src)
+{
+  std::unique_ptr<Doc> doc(src->duplicate(DuplicateExactCopy));
+
+  const Sprite* srcSprite = src->sprite();
+  Sprite* sprite = doc->sprite();
+  sprite->setPixelRatio(srcSprite->pixelRatio());
+  sprite->setGridBounds(srcSprite->gridBounds());
+  sprite->useLayerUuids(srcSprite->useLayerUuids());
+
+  doc->setFormatOptions(src->formatOptions());
+  doc->setInhibitBackup(src->inhibitBackup());
+  if (src->isReadOnly())
+    doc->markAsReadOnly();
+  if (src->isAssociatedToFile())
+    doc->markAsSaved();
+  return doc.release();
+}
+
+DocCache::DocCache(const int maxDocs) : m_maxDocs(maxDocs)
+{
+}
+
+DocCache::~DocCache()
+{
+  clear();
+}
+
+Doc* DocCache::open(Context* ctx, const std::string& filename, base::paths& usedFiles)
+{
+  for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+    if (it->filename != filename)
+      continue;
+
+    if (!isValid(*it)) {
+      m_entries.erase(it);
+      return nullptr;
+    }
+
+    // Move to the front of the LRU list
+    m_entries.splice(m_entries.begin(), m_entries, it);
+
+    const Entry& entry = m_entries.front();
+    usedFiles.clear();
+    for (const File& file : entry.files)
+      usedFiles.push_back(file.filename);
+
+    Doc* doc = copy_doc(entry.doc.get());
+    doc->markAsSaved();
+    doc->setContext(ctx);
+    return doc;
+  }
+  return nullptr;
+}
+
+void DocCache::add(const std::string& filename, const Doc* doc, const base::paths& usedFiles)
+{
+  if (m_maxDocs <= 0)
+    return;
+
+  // Remove the old entry of this same file
+  for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+    if (it->filename == filename) {
+      m_entries.erase(it);
+      break;
+    }
+  }
+
+  Entry entry;
+  entry.filename = filename;
+  entry.doc.reset(copy_doc(doc));
+  for (const auto& fn : usedFiles)
+    entry.files.push_back({ fn, base::get_modification_time(fn), base::file_size(fn) });
+  if (entry.files.empty())
+    entry.files.push_back(
+      { filename, base::get_modification_time(filename), base::file_size(filename) });
+
+  m_entries.push_front(std::move(entry));
+  while (int(m_entries.size()) > m_maxDocs)
+    m_entries.pop_back();
+}
+
+void DocCache::clear()
+{
+  m_entries.clear();
+}
+
+// static
+bool DocCache::isValid(const Entry& entry)
+{
+  for (const File& file : entry.files) {
+    if (!base::is_file(file.filename) || base::file_size(file.filename) != file.size)
+      return false;
+
+    const base::Time time = base::get_modification_time(file.filename);
+    if (time < file.time || file.time < time)
+      return false;
+  }
+  return true;
+}
+
+} // namespace app
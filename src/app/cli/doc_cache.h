@@ -0,0 +1,72 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_CLI_DOC_CACHE_H_INCLUDED
+#define APP_CLI_DOC_CACHE_H_INCLUDED
+#pragma once
+
+#include "base/paths.h"
+#include "base/time.h"
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace app {
+
+class Context;
+class Doc;
+
+// Cache of documents loaded from the CLI (used by the batch server
+// to avoid decoding the same files in each job).
+//
+// The cache keeps a pristine copy of each loaded document, and each
+// job receives a new copy of it (so the job can modify its document
+// freely). An entry is discarded when one of the files used to load
+// the document was modified.
+class DocCache {
+public:
+  static constexpr int kDefaultMaxDocs = 16;
+
+  explicit DocCache(int maxDocs = kDefaultMaxDocs);
+  ~DocCache();
+
+  // Adds a copy of the given document to the context if the
+  // "filename" is in the cache. Returns the new document or nullptr
+  // if it's not in the cache. "usedFiles" is filled with the files
+  // that were used to load the original document.
+  Doc* open(Context* ctx, const std::string& filename, base::paths& usedFiles);
+
+  // Stores a copy of the given document, which was just loaded from
+  // the given files.
+  void add(const std::string& filename, const Doc* doc, const base::paths& usedFiles);
+
+  void clear();
+  std::size_t size() const { return m_entries.size(); }
+
+private:
+  struct File {
+    std::string filename;
+    base::Time time;
+    std::size_t size;
+  };
+  struct Entry {
+    std::string filename;
+    std::unique_ptr<Doc> doc;
+    std::vector<File> files;
+  };
+
+  static bool isValid(const Entry& entry);
+
+  std::list<Entry> m_entries; // Most recently used first
+  int m_maxDocs;
+};
+
+} // namespace app
+
+#endif
@@ -1,4 +1,5 @@
 // Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -15,7 +16,6 @@
 #include "app/doc_event.h"
 #include "doc/cel.h"
 #include "doc/layer.h"
-#include "doc/primitives.h"
 #include "doc/sprite.h"
 
 namespace app { namespace cmd {
@@ -43,8 +43,12 @@ void AddFrame::onExecute()
   else {
     LayerImage* bglayer = sprite->backgroundLayer();
     if (bglayer) {
-      ImageRef bgimage(Image::create(sprite->pixelFormat(), sprite->width(), sprite->height()));
-      clear_image(bgimage.get(), doc->bgColor(bglayer));
+      // The pixels of the new background cel are created only when
+      // they're modified (so sprites with lots of frames over a solid
+      // background don't need memory for each one).
+      ImageRef bgimage(Image::createUniform(
+        ImageSpec(sprite->colorMode(), sprite->width(), sprite->height()),
+        doc->bgColor(bglayer)));
       Cel* cel = new Cel(m_newFrame, bgimage);
       m_addCel.reset(new cmd::AddCel(bglayer, cel));
       m_addCel->execute(context());
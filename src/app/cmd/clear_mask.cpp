@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2020  Igara Studio S.A.
+// Copyright (C) 2020-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -102,6 +102,7 @@ void ClearMask::clear()
                                  mask,
                                  m_bgcolor,
                                  (cel->image()->isTilemap() ? &grid : nullptr));
+  cel->image()->incrementVersion();
 }
 
 void ClearMask::restore()
@@ -111,6 +112,7 @@ void ClearMask::restore()
 
   Cel* cel = this->cel();
   copy_image(cel->image(), m_copy.get(), m_cropPos.x, m_cropPos.y);
+  cel->image()->incrementVersion();
 }
 
 }} // namespace app::cmd
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2025  Igara Studio S.A.
+// Copyright (C) 2025-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -85,11 +85,13 @@ void ClearRect::clear()
             m_offsetX + m_copy->width() - 1,
             m_offsetY + m_copy->height() - 1,
             m_bgcolor);
+  m_dstImage->image()->incrementVersion();
 }
 
 void ClearRect::restore()
 {
   copy_image(m_dstImage->image(), m_copy.get(), m_offsetX, m_offsetY);
+  m_dstImage->image()->incrementVersion();
 }
 
 }} // namespace app::cmd
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2024  Igara Studio S.A.
+// Copyright (C) 2024-2026  Igara Studio S.A.
 //
 // This program is distributed under the terms of
 // the End-User License Agreement for Aseprite.
@@ -127,6 +127,7 @@ void ClearSlices::clear()
                                      &sc.mask,
                                      sc.bgcolor,
                                      (sc.cel()->image()->isTilemap() ? &grid : nullptr));
+      sc.cel()->image()->incrementVersion();
     }
   }
 }
@@ -138,6 +139,7 @@ void ClearSlices::restore()
       continue;
 
     copy_image(sc.cel()->image(), sc.copy.get(), sc.cropPos.x, sc.cropPos.y);
+    sc.cel()->image()->incrementVersion();
   }
 }
 
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2025  Igara Studio S.A.
+// Copyright (C) 2018-2026  Igara Studio S.A.
 //
 // This program is distributed under the terms of
 // the End-User License Agreement for Aseprite.
@@ -17,14 +17,26 @@
 #include "doc/cels_range.h"
 #include "doc/palette.h"
 #include "doc/sprite.h"
+#include "doc/task_scheduler.h"
 #include "os/color_space.h"
 #include "os/system.h"
 
+#include <utility>
+#include <vector>
+
 namespace app { namespace cmd {
 
-static doc::ImageRef convert_image_color_space(const doc::Image* srcImage,
-                                               const gfx::ColorSpaceRef& newCS,
-                                               os::ColorSpaceConversion* conversion)
+namespace {
+
+// Cels are converted in parallel when there are at least this number
+// of pixels.
+constexpr std::size_t kMinPixelsForThreads = 256 * 256;
+
+using ImagePairs = std::vector<std::pair<ImageRef, ImageRef>>;
+
+doc::ImageRef convert_image_color_space(const doc::Image* srcImage,
+                                        const gfx::ColorSpaceRef& newCS,
+                                        os::ColorSpaceConversion* conversion)
 {
   ImageSpec spec = srcImage->spec();
   spec.setColorSpace(newCS);
@@ -36,39 +48,76 @@ static doc::ImageRef convert_image_color_space(const doc::Image* srcImage,
   }
 
   if (spec.colorMode() == doc::ColorMode::RGB) {
-    for (int y = 0; y < spec.height(); ++y) {
-      conversion->convertRgba((uint32_t*)dstImage->getPixelAddress(0, y),
-                              (const uint32_t*)srcImage->getPixelAddress(0, y),
-                              spec.width());
+    // Convert all rows in one call when both images have the same
+    // row stride (the conversion processes several pixels at the
+    // same time, so it's faster with longer spans of pixels)
+    if (srcImage->rowBytes() == dstImage->rowBytes()) {
+      const int n = srcImage->rowPixels() * (spec.height() - 1) + spec.width();
+      conversion->convertRgba((uint32_t*)dstImage->getPixelAddress(0, 0),
+                              (const uint32_t*)srcImage->getPixelAddress(0, 0),
+                              n);
+    }
+    else {
+      for (int y = 0; y < spec.height(); ++y) {
+        conversion->convertRgba((uint32_t*)dstImage->getPixelAddress(0, y),
+                                (const uint32_t*)srcImage->getPixelAddress(0, y),
+                                spec.width());
+      }
     }
   }
   else if (spec.colorMode() == doc::ColorMode::GRAYSCALE) {
-    // TODO create a set of functions to create pixel format
-    // conversions (this should be available when we add new kind of
-    // pixel formats).
-    std::vector<uint8_t> buf(spec.width() * spec.height());
+    // There are only 256 gray values, so we convert all of them once
+    // and use the result as a lookup table.
+    uint8_t lut[256];
+    for (int i = 0; i < 256; ++i)
+      lut[i] = uint8_t(i);
+    conversion->convertGray(lut, lut, 256);
 
-    auto it = buf.begin();
     for (int y = 0; y < spec.height(); ++y) {
       auto srcPtr = (const uint16_t*)srcImage->getPixelAddress(0, y);
-      for (int x = 0; x < spec.width(); ++x, ++srcPtr, ++it)
-        *it = doc::graya_getv(*srcPtr);
+      auto dstPtr = (uint16_t*)dstImage->getPixelAddress(0, y);
+      for (int x = 0; x < spec.width(); ++x, ++dstPtr, ++srcPtr)
+        *dstPtr = doc::graya(lut[doc::graya_getv(*srcPtr)], doc::graya_geta(*srcPtr));
     }
+  }
 
-    conversion->convertGray(&buf[0], &buf[0], spec.width() * spec.height());
+  return dstImage;
+}
 
-    it = buf.begin();
-    for (int y = 0; y < spec.height(); ++y) {
-      auto srcPtr = (const uint16_t*)srcImage->getPixelAddress(0, y);
-      auto dstPtr = (uint16_t*)dstImage->getPixelAddress(0, y);
-      for (int x = 0; x < spec.width(); ++x, ++dstPtr, ++srcPtr, ++it)
-        *dstPtr = doc::graya(*it, doc::graya_geta(*srcPtr));
+// Converts the images of all unique cels of the sprite to the new
+// color space, in parallel when there are enough pixels. Returns
+// pairs of old/new images in the same order as
+// Sprite::uniqueCels().
+ImagePairs convert_cel_images(doc::Sprite* sprite,
+                              const gfx::ColorSpaceRef& newCS,
+                              os::ColorSpaceConversion* conversion)
+{
+  ImagePairs images;
+  std::size_t npixels = 0;
+  for (Cel* cel : sprite->uniqueCels()) {
+    ImageRef oldImage = cel->imageRef();
+    if (oldImage && oldImage->pixelFormat() != IMAGE_TILEMAP) {
+      npixels += std::size_t(oldImage->width()) * oldImage->height();
+      images.emplace_back(oldImage, nullptr);
     }
   }
 
-  return dstImage;
+  const int maxThreads = (npixels < kMinPixelsForThreads ? 1 : 0);
+
+  // The color space conversion doesn't modify its state, so the same
+  // conversion can be used from all threads.
+  doc::TaskScheduler::instance().parallelFor(
+    int(images.size()),
+    [&](const int i) {
+      images[i].second = convert_image_color_space(images[i].first.get(), newCS, conversion);
+    },
+    maxThreads);
+
+  return images;
 }
 
+} // anonymous namespace
+
 void convert_color_profile(doc::Sprite* sprite, const gfx::ColorSpaceRef& newCS)
 {
   ASSERT(sprite->colorSpace());
@@ -84,14 +133,8 @@ void convert_color_profile(doc::Sprite* sprite, const gfx::ColorSpaceRef& newCS)
 
   // Convert images
   if (sprite->pixelFormat() != doc::IMAGE_INDEXED) {
-    for (Cel* cel : sprite->uniqueCels()) {
-      ImageRef old_image = cel->imageRef();
-      if (old_image && old_image->pixelFormat() != IMAGE_TILEMAP) {
-        ImageRef new_image = convert_image_color_space(old_image.get(), newCS, conversion.get());
-
-        sprite->replaceImage(old_image->id(), new_image);
-      }
-    }
+    for (const auto& pair : convert_cel_images(sprite, newCS, conversion.get()))
+      sprite->replaceImage(pair.first->id(), pair.second);
   }
 
   if (conversion) {
@@ -175,14 +218,8 @@ ConvertColorProfile::ConvertColorProfile(doc::Sprite* sprite, const gfx::ColorSp
 
   // Convert images
   if (sprite->pixelFormat() != doc::IMAGE_INDEXED) {
-    for (Cel* cel : sprite->uniqueCels()) {
-      ImageRef old_image = cel->imageRef();
-      if (old_image && old_image->pixelFormat() != IMAGE_TILEMAP) {
-        ImageRef new_image = convert_image_color_space(old_image.get(), newCS, conversion.get());
-
-        m_seq.add(new cmd::ReplaceImage(sprite, old_image, new_image));
-      }
-    }
+    for (const auto& pair : convert_cel_images(sprite, newCS, conversion.get()))
+      m_seq.add(new cmd::ReplaceImage(sprite, pair.first, pair.second));
   }
 
   if (conversion) {
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2024  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -25,45 +25,73 @@
 #include "doc/palette.h"
 #include "doc/rgbmap.h"
 #include "doc/sprite.h"
+#include "doc/task_scheduler.h"
 #include "doc/tilesets.h"
 #include "render/quantization.h"
 #include "render/task_delegate.h"
 
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <thread>
+
 namespace app { namespace cmd {
 
 using namespace doc;
 
 namespace {
 
-class SuperDelegate : public render::TaskDelegate {
+// Images are converted in parallel when there are at least this
+// number of pixels, e.g. a few big images or a lot of small ones.
+constexpr std::size_t kMinPixelsForThreads = 256 * 256;
+
+// An RgbMap calculates all its entries (so it can be shared between
+// threads) only when it's used to convert at least this number of
+// pixels (the number of entries of the RgbMapRGB5A3).
+constexpr std::size_t kMinPixelsToCalculateAllEntries = 32 * 32 * 32 * 8;
+
+// Delegate for the threads that convert images. Only the thread that
+// creates the command uses the original delegate (which might not be
+// thread-safe), other threads just check if the task was canceled.
+class ConvertDelegate : public render::TaskDelegate {
 public:
-  SuperDelegate(int nimages, render::TaskDelegate* delegate)
-    : m_nimages(nimages)
-    , m_curImage(0)
+  ConvertDelegate(int nimages, render::TaskDelegate* delegate)
+    : m_nimages(std::max(1, nimages))
+    , m_done(0)
+    , m_canceled(false)
     , m_delegate(delegate)
+    , m_thread(std::this_thread::get_id())
   {
   }
 
   void notifyTaskProgress(double progress) override
   {
-    if (m_delegate)
-      m_delegate->notifyTaskProgress((progress + m_curImage) / m_nimages);
+    if (m_delegate && std::this_thread::get_id() == m_thread)
+      m_delegate->notifyTaskProgress(std::min(1.0, (progress + m_done) / m_nimages));
   }
 
   bool continueTask() override
   {
-    if (m_delegate)
-      return m_delegate->continueTask();
-    else
-      return true;
+    if (m_delegate && std::this_thread::get_id() == m_thread && !m_delegate->continueTask())
+      m_canceled = true;
+    return !m_canceled;
   }
 
-  void nextImage() { ++m_curImage; }
+  void cancel() { m_canceled = true; }
+
+  void imageDone()
+  {
+    ++m_done;
+    notifyTaskProgress(0.0);
+  }
 
 private:
   int m_nimages;
-  int m_curImage;
+  std::atomic<int> m_done;
+  std::atomic<bool> m_canceled;
   TaskDelegate* m_delegate;
+  std::thread::id m_thread;
 };
 
 } // anonymous namespace
@@ -82,41 +110,14 @@ SetPixelFormat::SetPixelFormat(Sprite* sprite,
   if (sprite->pixelFormat() == newFormat)
     return;
 
-  // Calculate the number of images to convert just to show a proper
-  // progress bar.
-  tile_index nimages = 0;
-  for (Cel* cel : sprite->uniqueCels())
-    if (!cel->layer()->isTilemap())
-      ++nimages;
-  if (sprite->hasTilesets()) {
-    for (Tileset* tileset : *sprite->tilesets()) {
-      if (tileset)
-        nimages += tileset->size();
-    }
-  }
-
-  SuperDelegate superDel(nimages, delegate);
-
-  // Convert cel images
+  // Cel images
+  std::vector<ImageToConvert> images;
   for (Cel* cel : sprite->uniqueCels()) {
-    if (cel->layer()->isTilemap())
-      continue;
-
-    ImageRef oldImage = cel->imageRef();
-    convertImage(sprite,
-                 dithering,
-                 oldImage,
-                 cel->frame(),
-                 cel->layer()->isBackground(),
-                 mapAlgorithm,
-                 toGray,
-                 &superDel,
-                 fitCriteria);
-
-    superDel.nextImage();
+    if (!cel->layer()->isTilemap())
+      images.push_back({ cel->imageRef(), cel->frame(), cel->layer()->isBackground() });
   }
 
-  // Convert tileset images
+  // Tileset images
   if (sprite->hasTilesets()) {
     for (Tileset* tileset : *sprite->tilesets()) {
       if (!tileset)
@@ -125,22 +126,24 @@ SetPixelFormat::SetPixelFormat(Sprite* sprite,
       for (tile_index i = 0; i < tileset->size(); ++i) {
         ImageRef oldImage = tileset->get(i);
         if (oldImage) {
-          convertImage(sprite,
-                       dithering,
-                       oldImage,
-                       0,     // TODO select a frame or generate other tilesets?
-                       false, // TODO is background? it depends of the layer where this tileset is
-                              // used
-                       mapAlgorithm,
-                       toGray,
-                       &superDel,
-                       fitCriteria);
+          images.push_back({ oldImage,
+                             0,       // TODO select a frame or generate other tilesets?
+                             false }); // TODO is background? it depends of the layer where this
+                                       // tileset is used
         }
-        superDel.nextImage();
       }
     }
   }
 
+  convertImages(sprite, images, dithering, mapAlgorithm, toGray, delegate, fitCriteria);
+
+  // Replace images in the same order (images that weren't converted
+  // because the task was canceled are kept)
+  for (const ImageToConvert& image : images) {
+    if (image.newImage)
+      m_pre.add(new cmd::ReplaceImage(sprite, image.oldImage, image.newImage));
+  }
+
   // By default, when converting to RGB or grayscale, the mask color
   // is always 0.
   int newMaskIndex = 0;
@@ -228,45 +231,108 @@ void SetPixelFormat::setFormat(PixelFormat format)
   doc->notify_observers<DocEvent&>(&DocObserver::onPixelFormatChanged, ev);
 }
 
-void SetPixelFormat::convertImage(doc::Sprite* sprite,
-                                  const render::Dithering& dithering,
-                                  const doc::ImageRef& oldImage,
-                                  const doc::frame_t frame,
-                                  const bool isBackground,
-                                  const doc::RgbMapAlgorithm mapAlgorithm,
-                                  doc::rgba_to_graya_func toGray,
-                                  render::TaskDelegate* delegate,
-                                  const doc::FitCriteria fitCriteria)
+void SetPixelFormat::convertImages(doc::Sprite* sprite,
+                                   std::vector<ImageToConvert>& images,
+                                   const render::Dithering& dithering,
+                                   const doc::RgbMapAlgorithm mapAlgorithm,
+                                   doc::rgba_to_graya_func toGray,
+                                   render::TaskDelegate* delegate,
+                                   const doc::FitCriteria fitCriteria)
 {
-  ASSERT(oldImage);
-  ASSERT(oldImage->pixelFormat() != IMAGE_TILEMAP);
-
-  // Making the RGBMap for Image->INDEXDED conversion.
-  // TODO: this is needed only when newImage
-  RgbMap* rgbmap;
-  int newMaskIndex = (isBackground ? -1 : 0);
-  if (m_newFormat == IMAGE_INDEXED) {
-    rgbmap = sprite->rgbMap(frame, sprite->rgbMapForSprite(), mapAlgorithm, fitCriteria);
-    if (m_oldFormat == IMAGE_INDEXED)
-      newMaskIndex = sprite->transparentColor();
-    else
-      newMaskIndex = rgbmap->maskIndex();
-  }
-  else {
-    rgbmap = nullptr;
+  std::size_t npixels = 0;
+  for (const ImageToConvert& image : images)
+    npixels += std::size_t(image.oldImage->width()) * image.oldImage->height();
+
+  TaskScheduler& scheduler = TaskScheduler::instance();
+  const int nthreads = std::min(scheduler.concurrency(), int(images.size()));
+  const bool parallel = (nthreads > 1 && npixels >= kMinPixelsForThreads);
+  const Sprite::RgbMapFor forLayer = sprite->rgbMapForSprite();
+
+  // RgbMap for each palette used in the conversion to indexed. If all
+  // the entries of the RgbMap are calculated, the same RgbMap is used
+  // (read-only) from all threads, in other case each thread creates
+  // its own RgbMap (they generate the same indexes, so the result is
+  // the same as converting the images one after the other).
+  struct PaletteRgbMap {
+    frame_t frame;
+    std::unique_ptr<RgbMap> rgbmap;
+    bool shared = false;
+  };
+  std::map<const Palette*, PaletteRgbMap> rgbmaps;
+  if (parallel && m_newFormat == IMAGE_INDEXED) {
+    for (const ImageToConvert& image : images) {
+      PaletteRgbMap& entry = rgbmaps[sprite->palette(image.frame)];
+      if (!entry.rgbmap) {
+        entry.frame = image.frame;
+        entry.rgbmap = sprite->createRgbMap(image.frame, forLayer, mapAlgorithm, fitCriteria);
+        if (entry.rgbmap && npixels >= kMinPixelsToCalculateAllEntries)
+          entry.shared = entry.rgbmap->calculateAllEntries();
+      }
+    }
   }
-  ImageRef newImage(render::convert_pixel_format(oldImage.get(),
-                                                 nullptr,
-                                                 m_newFormat,
-                                                 dithering,
-                                                 rgbmap,
-                                                 sprite->palette(frame),
-                                                 isBackground,
-                                                 newMaskIndex,
-                                                 toGray,
-                                                 delegate));
-
-  m_pre.add(new cmd::ReplaceImage(sprite, oldImage, newImage));
+
+  ConvertDelegate convertDel(int(images.size()), delegate);
+  std::atomic<int> next(0);
+
+  auto convert = [&]() {
+    // RgbMaps that are used only by this thread
+    std::map<const Palette*, std::unique_ptr<RgbMap>> localRgbmaps;
+
+    auto getRgbMap = [&](const frame_t frame) -> RgbMap* {
+      if (!parallel)
+        return sprite->rgbMap(frame, forLayer, mapAlgorithm, fitCriteria);
+
+      const Palette* palette = sprite->palette(frame);
+      const PaletteRgbMap& entry = rgbmaps.at(palette);
+      if (entry.shared)
+        return entry.rgbmap.get();
+
+      std::unique_ptr<RgbMap>& rgbmap = localRgbmaps[palette];
+      if (!rgbmap)
+        rgbmap = sprite->createRgbMap(entry.frame, forLayer, mapAlgorithm, fitCriteria);
+      return rgbmap.get();
+    };
+
+    try {
+      for (int i = next++; i < int(images.size()) && convertDel.continueTask(); i = next++) {
+        ImageToConvert& image = images[i];
+        ASSERT(image.oldImage);
+        ASSERT(image.oldImage->pixelFormat() != IMAGE_TILEMAP);
+
+        // Making the RGBMap for Image->INDEXDED conversion.
+        RgbMap* rgbmap = nullptr;
+        int newMaskIndex = (image.isBackground ? -1 : 0);
+        if (m_newFormat == IMAGE_INDEXED) {
+          rgbmap = getRgbMap(image.frame);
+          if (m_oldFormat == IMAGE_INDEXED)
+            newMaskIndex = sprite->transparentColor();
+          else
+            newMaskIndex = rgbmap->maskIndex();
+        }
+
+        image.newImage.reset(render::convert_pixel_format(image.oldImage.get(),
+                                                          nullptr,
+                                                          m_newFormat,
+                                                          dithering,
+                                                          rgbmap,
+                                                          sprite->palette(image.frame),
+                                                          image.isBackground,
+                                                          newMaskIndex,
+                                                          toGray,
+                                                          &convertDel));
+        convertDel.imageDone();
+      }
+    }
+    catch (...) {
+      convertDel.cancel();
+      throw;
+    }
+  };
+
+  // Each convert() call takes images until all of them are converted,
+  // so each thread uses its own RgbMaps.
+  const int ncalls = (parallel ? nthreads : 1);
+  scheduler.parallelFor(ncalls, [&](int) { convert(); }, ncalls);
 }
 
 }} // namespace app::cmd
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2024  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 // Copyright (C) 2001-2017  David Capello
 //
 // This program is distributed under the terms of
@@ -18,6 +18,8 @@
 #include "doc/pixel_format.h"
 #include "doc/rgbmap_algorithm.h"
 
+#include <vector>
+
 namespace doc {
 class Sprite;
 }
@@ -47,16 +49,23 @@ protected:
   size_t onMemSize() const override { return sizeof(*this) + m_pre.memSize() + m_post.memSize(); }
 
 private:
+  struct ImageToConvert {
+    doc::ImageRef oldImage;
+    doc::frame_t frame;
+    bool isBackground;
+    doc::ImageRef newImage;
+  };
+
   void setFormat(doc::PixelFormat format);
-  void convertImage(doc::Sprite* sprite,
-                    const render::Dithering& dithering,
-                    const doc::ImageRef& oldImage,
-                    const doc::frame_t frame,
-                    const bool isBackground,
-                    const doc::RgbMapAlgorithm mapAlgorithm,
-                    doc::rgba_to_graya_func toGray,
-                    render::TaskDelegate* delegate,
-                    const doc::FitCriteria fitCriteria = doc::FitCriteria::DEFAULT);
+
+  // Converts all the given images, in parallel when it's worth it.
+  void convertImages(doc::Sprite* sprite,
+                     std::vector<ImageToConvert>& images,
+                     const render::Dithering& dithering,
+                     const doc::RgbMapAlgorithm mapAlgorithm,
+                     doc::rgba_to_graya_func toGray,
+                     render::TaskDelegate* delegate,
+                     const doc::FitCriteria fitCriteria);
 
   doc::PixelFormat m_oldFormat;
   doc::PixelFormat m_newFormat;
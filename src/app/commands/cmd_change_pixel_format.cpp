@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2025  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -32,6 +32,7 @@
 #include "doc/image.h"
 #include "doc/layer.h"
 #include "doc/sprite.h"
+#include "doc/task_scheduler.h"
 #include "fmt/format.h"
 #include "render/dithering.h"
 #include "render/dithering_algorithm.h"
@@ -44,7 +45,6 @@
 #include "color_mode.xml.h"
 
 #include <string>
-#include <thread>
 
 namespace app {
 
@@ -62,37 +62,34 @@ rgba_to_graya_func get_gray_func(gen::ToGrayAlgorithm toGray)
   return nullptr;
 }
 
-class ConvertThread : public render::TaskDelegate {
+class ConvertTask : public render::TaskDelegate {
 public:
-  ConvertThread(const doc::ImageRef& dstImage,
-                const doc::Sprite* sprite,
-                const doc::frame_t frame,
-                const doc::ColorMode colorMode,
-                const render::Dithering& dithering,
-                const gen::ToGrayAlgorithm toGray,
-                const gfx::Point& pos,
-                const bool newBlend)
+  ConvertTask(const doc::ImageRef& dstImage,
+              const doc::Sprite* sprite,
+              const doc::frame_t frame,
+              const doc::ColorMode colorMode,
+              const render::Dithering& dithering,
+              const gen::ToGrayAlgorithm toGray,
+              const gfx::Point& pos,
+              const bool newBlend)
     : m_image(dstImage)
     , m_pos(pos)
     , m_running(true)
     , m_stopFlag(false)
     , m_progress(0.0)
-    , m_thread([this,
-                sprite,
-                frame,
-                colorMode,
-                dithering,
-                toGray,
-                newBlend]() { // Copy the matrix
-      run(sprite, frame, colorMode, dithering, toGray, newBlend);
-    })
+    , m_task(doc::TaskScheduler::instance().run(
+        [this, sprite, frame, colorMode, dithering, toGray, newBlend](
+          doc::TaskScheduler::Token&) { // Copy the matrix
+          run(sprite, frame, colorMode, dithering, toGray, newBlend);
+        }))
   {
   }
 
   void stop()
   {
     m_stopFlag = true;
-    m_thread.join();
+    m_task->cancel();
+    m_task->wait();
   }
 
   bool isRunning() const { return m_running; }
@@ -141,7 +138,7 @@ private:
   bool m_running;
   bool m_stopFlag;
   double m_progress;
-  std::thread m_thread;
+  doc::TaskScheduler::TokenRef m_task;
 };
 
 class ConversionItem : public ListItem {
@@ -336,9 +333,9 @@ private:
     m_editor->invalidate();
 
     m_timer.stop();
-    if (m_bgThread) {
-      m_bgThread->stop();
-      m_bgThread.reset(nullptr);
+    if (m_bgTask) {
+      m_bgTask->stop();
+      m_bgTask.reset(nullptr);
     }
   }
 
@@ -395,14 +392,14 @@ private:
     progress()->setVisible(false);
     layout();
 
-    m_bgThread.reset(new ConvertThread(m_image,
-                                       m_editor->sprite(),
-                                       m_editor->frame(),
-                                       dstColorMode,
-                                       dithering(),
-                                       toGray(),
-                                       visibleBounds.origin(),
-                                       Preferences::instance().experimental.newBlend()));
+    m_bgTask.reset(new ConvertTask(m_image,
+                                   m_editor->sprite(),
+                                   m_editor->frame(),
+                                   dstColorMode,
+                                   dithering(),
+                                   toGray(),
+                                   visibleBounds.origin(),
+                                   Preferences::instance().experimental.newBlend()));
 
     m_timer.start();
   }
@@ -423,20 +420,20 @@ private:
 
   void onMonitorProgress()
   {
-    ASSERT(m_bgThread);
-    if (!m_bgThread)
+    ASSERT(m_bgTask);
+    if (!m_bgTask)
       return;
 
-    if (!m_bgThread->isRunning()) {
+    if (!m_bgTask->isRunning()) {
       m_timer.stop();
-      m_bgThread->stop();
-      m_bgThread.reset(nullptr);
+      m_bgTask->stop();
+      m_bgTask.reset(nullptr);
 
       progress()->setVisible(false);
       layout();
     }
     else {
-      int v = int(100 * m_bgThread->progress());
+      int v = int(100 * m_bgTask->progress());
       if (v > 0) {
         progress()->setValue(v);
         if (!progress()->isVisible()) {
@@ -453,7 +450,7 @@ private:
   Editor* m_editor;
   doc::ImageRef m_image;
   doc::ImageBufferPtr m_imageBuffer;
-  std::unique_ptr<ConvertThread> m_bgThread;
+  std::unique_ptr<ConvertTask> m_bgTask;
   ConversionItem* m_selectedItem;
   DitheringSelector* m_ditheringSelector;
   RgbMapAlgorithmSelector* m_mapAlgorithmSelector;
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -20,12 +20,14 @@
 #include "app/doc.h"
 #include "app/i18n/strings.h"
 #include "app/ini_file.h"
+#include "app/job.h"
 #include "app/modules/gui.h"
 #include "app/tx.h"
 #include "app/ui/app_tooltips.h"
 #include "app/ui/color_bar.h"
 #include "app/ui/color_button.h"
 #include "app/ui/selection_mode_field.h"
+#include "doc/cancel_io.h"
 #include "doc/image.h"
 #include "doc/mask.h"
 #include "doc/sprite.h"
@@ -36,6 +38,9 @@
 #include "ui/widget.h"
 #include "ui/window.h"
 
+#include <functional>
+#include <memory>
+
 // Uncomment to see the performance of doc::MaskBoundaries ctor
 // #define SHOW_BOUNDARIES_GEN_PERFORMANCE
 
@@ -45,6 +50,10 @@ using namespace ui;
 
 static const char* ConfigSection = "MaskColor";
 
+// Minimum number of pixels to generate the mask in a background job
+// (showing a progress window to cancel the operation)
+static constexpr int kMinPixelsForJob = 4096 * 4096;
+
 struct MaskByColorParams : public NewParams {
   Param<bool> ui{ this, true, "ui" };
   Param<app::Color> color{ this, app::Color(), "color" };
@@ -152,6 +161,7 @@ private:
   SelModeField* m_selMode = nullptr;
 };
 
+// Returns nullptr if the operation is canceled with "cancel".
 static Mask* generateMask(const Mask& origMask,
                           bool isOrigMaskVisible,
                           const Image* image,
@@ -159,10 +169,12 @@ static Mask* generateMask(const Mask& origMask,
                           int ypos,
                           gen::SelectionMode mode,
                           int color,
-                          int tolerance)
+                          int tolerance,
+                          doc::CancelIO* cancel = nullptr)
 {
   std::unique_ptr<Mask> mask(new Mask());
-  mask->byColor(image, color, tolerance);
+  if (!mask->byColor(image, color, tolerance, cancel))
+    return nullptr;
   mask->offsetOrigin(xpos, ypos);
 
   if (!origMask.isEmpty() && isOrigMaskVisible) {
@@ -190,6 +202,30 @@ static Mask* generateMask(const Mask& origMask,
   return mask.release();
 }
 
+// Generates the mask in a background thread for huge images, so the
+// user can cancel the operation from the progress window.
+class MaskByColorJob : public Job,
+                       public doc::CancelIO {
+public:
+  MaskByColorJob(const std::function<Mask*(doc::CancelIO*)>& generate)
+    : Job(Strings::mask_by_color_title(), true)
+    , m_generate(generate)
+  {
+  }
+
+  Mask* releaseMask() { return m_mask.release(); }
+
+  // doc::CancelIO impl
+  bool isCanceled() override { return Job::isCanceled(); }
+
+private:
+  // [working thread]
+  void onJob() override { m_mask.reset(m_generate(this)); }
+
+  std::function<Mask*(doc::CancelIO*)> m_generate;
+  std::unique_ptr<Mask> m_mask;
+};
+
 class MaskByColorCommand : public CommandWithNewParams<MaskByColorParams> {
 public:
   MaskByColorCommand();
@@ -271,17 +307,38 @@ void MaskByColorCommand::onExecute(Context* context)
   if (apply) {
     int color = color_utils::color_for_image(params.color(), sprite->pixelFormat());
 
-    Tx tx(writer, "Mask by Color", DoesntModifyDocument);
-    std::unique_ptr<Mask> mask(generateMask(*document->mask(),
-                                            isOrigMaskVisible,
-                                            image,
-                                            xpos,
-                                            ypos,
-                                            params.mode(),
-                                            color,
-                                            params.tolerance()));
-    tx(new cmd::SetMask(document, mask.get()));
-    tx.commit();
+    auto generate = [&](doc::CancelIO* cancel) {
+      return generateMask(*document->mask(),
+                          isOrigMaskVisible,
+                          image,
+                          xpos,
+                          ypos,
+                          params.mode(),
+                          color,
+                          params.tolerance(),
+                          cancel);
+    };
+
+    std::unique_ptr<Mask> mask;
+    if (context->isUIAvailable() && image->width() * image->height() >= kMinPixelsForJob) {
+      MaskByColorJob job(generate);
+      job.startJob();
+      job.waitJob();
+      if (!job.isCanceled())
+        mask.reset(job.releaseMask());
+    }
+    else {
+      mask.reset(generate(nullptr));
+    }
+
+    if (mask) {
+      Tx tx(writer, "Mask by Color", DoesntModifyDocument);
+      tx(new cmd::SetMask(document, mask.get()));
+      tx.commit();
+    }
+    else {
+      document->generateMaskBoundaries();
+    }
   }
   else {
     document->generateMaskBoundaries();
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2025  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -37,6 +37,7 @@
 #include "doc/palette.h"
 #include "doc/sprite.h"
 #include "filters/filter.h"
+#include "trace/trace.h"
 #include "ui/manager.h"
 #include "ui/view.h"
 #include "ui/widget.h"
@@ -469,6 +470,7 @@ void FilterManagerImpl::init(Cel* cel)
 
 void FilterManagerImpl::applyToCel(Cel* cel)
 {
+  TRACE_ZONE("FilterManagerImpl::applyToCel");
   init(cel);
   apply();
 }
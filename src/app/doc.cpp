@@ -24,6 +24,7 @@
 #include "app/pref/preferences.h"
 #include "app/util/cel_ops.h"
 #include "base/memory.h"
+#include "dio/aseprite_lazy_cels.h"
 #include "doc/cel.h"
 #include "doc/layer.h"
 #include "doc/layer_tilemap.h"
@@ -460,6 +461,33 @@ void Doc::setFormatOptions(const FormatOptionsPtr& format_options)
   m_format_options = format_options;
 }
 
+//////////////////////////////////////////////////////////////////////
+// Cels loaded on demand
+
+void Doc::setLazyCels(const std::shared_ptr<dio::AsepriteLazyCels>& lazyCels)
+{
+  m_lazyCels = lazyCels;
+}
+
+void Doc::unloadLazyCels()
+{
+  ASSERT(ui::is_ui_thread());
+
+  // Only the cels of unmodified documents are unloaded, this is a
+  // conservative check to avoid losing changes (the version of each
+  // image is checked too).
+  if (!m_lazyCels || !m_lazyCels->exceedsMaxMemSize() || isModified())
+    return;
+
+  // Nobody else can be accessing the pixels while we hold the write lock
+  const LockResult lockResult = writeLock(0);
+  if (lockResult == LockResult::Fail)
+    return;
+
+  m_lazyCels->unloadImages();
+  unlock(lockResult);
+}
+
 //////////////////////////////////////////////////////////////////////
 // Boundaries
 
@@ -483,10 +511,8 @@ void Doc::generateMaskBoundaries(const Mask* mask)
 
   ASSERT(mask);
 
-  if (!mask->isEmpty()) {
-    m_maskBoundaries.regen(mask->bitmap());
-    m_maskBoundaries.offset(mask->bounds().x, mask->bounds().y);
-  }
+  if (!mask->isEmpty())
+    m_maskBoundaries.regen(mask);
 
   notifySelectionBoundariesChanged();
 }
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2025  Igara Studio S.A.
+// Copyright (C) 2018-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -29,6 +29,10 @@
 #include <memory>
 #include <string>
 
+namespace dio {
+class AsepriteLazyCels;
+}
+
 namespace doc {
 class Cel;
 class Layer;
@@ -193,6 +197,18 @@ public:
   void setFormatOptions(const FormatOptionsPtr& format_options);
   FormatOptionsPtr formatOptions() const { return m_format_options; }
 
+  //////////////////////////////////////////////////////////////////////
+  // Cels loaded on demand (see FileOpConfig::lazyCels)
+
+  void setLazyCels(const std::shared_ptr<dio::AsepriteLazyCels>& lazyCels);
+  const std::shared_ptr<dio::AsepriteLazyCels>& lazyCels() const { return m_lazyCels; }
+
+  // Unloads the cels that were loaded on demand if they are using
+  // more memory than the limit. It must be called from the UI thread
+  // and does nothing if the document cannot be locked immediately
+  // (e.g. a background thread is rendering it).
+  void unloadLazyCels();
+
   //////////////////////////////////////////////////////////////////////
   // Boundaries
 
@@ -286,6 +302,9 @@ private:
   // Data to save the file in the same format that it was loaded
   FormatOptionsPtr m_format_options;
 
+  // Cels which pixels are loaded from the file when they are needed
+  std::shared_ptr<dio::AsepriteLazyCels> m_lazyCels;
+
   // Extra cel used to draw extra stuff (e.g. editor's pen preview, pixels in movement, etc.)
   ExtraCelRef m_extraCel;
 
@@ -45,6 +45,7 @@
 #include "render/ordered_dither.h"
 #include "render/quantization.h"
 #include "render/render.h"
+#include "trace/trace.h"
 #include "ver/info.h"
 
 #include <algorithm>
@@ -754,6 +755,8 @@ void DocExporter::setDocImageBuffer(const doc::ImageBufferPtr& docBuf)
 
 Doc* DocExporter::exportSheet(Context* ctx, base::task_token& token)
 {
+  TRACE_ZONE("DocExporter::exportSheet");
+
   // We output the metadata to std::cout if the user didn't specify a file.
   std::ofstream fos;
   std::streambuf* osbuf = nullptr;
@@ -994,6 +997,7 @@ int DocExporter::addTilesetsSamples(Doc* doc, const doc::SelectedLayers* selLaye
 
 void DocExporter::captureSamples(Samples& samples, base::task_token& token)
 {
+  TRACE_ZONE("DocExporter::captureSamples");
   DX_TRACE("DX: Capture samples");
 
   for (auto& item : m_documents) {
@@ -1383,6 +1387,7 @@ void DocExporter::renderTexture(Context* ctx,
                                 Image* textureImage,
                                 base::task_token& token) const
 {
+  TRACE_ZONE("DocExporter::renderTexture");
   textureImage->clear(textureImage->maskColor());
 
   int i = 0;
@@ -1441,6 +1446,8 @@ void DocExporter::trimTexture(const Samples& samples, doc::Sprite* texture) cons
 
 void DocExporter::createDataFile(const Samples& samples, std::ostream& os, doc::Sprite* texture)
 {
+  TRACE_ZONE("DocExporter::createDataFile");
+
   std::string frames_begin;
   std::string frames_end;
   bool filename_as_key = false;
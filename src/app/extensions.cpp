@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2020-2025  Igara Studio S.A.
+// Copyright (C) 2020-2026  Igara Studio S.A.
 // Copyright (C) 2017-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -19,10 +19,12 @@
 #include "app/context.h"
 #include "app/doc.h"
 #include "app/doc_undo.h"
+#include "app/extensions_cache.h"
 #include "app/ini_file.h"
 #include "app/load_matrix.h"
 #include "app/pref/preferences.h"
 #include "app/resource_finder.h"
+#include "base/chrono.h"
 #include "base/exception.h"
 #include "base/file_content.h"
 #include "base/file_handle.h"
@@ -1060,6 +1062,16 @@ Extensions::Extensions()
     LOG("EXT: User extensions path '%s'\n", m_userExtensionsPath.c_str());
   }
 
+  // Parsed package.json files from the previous session
+  std::string cacheFn;
+  {
+    ResourceFinder rf2;
+    rf2.includeUserDir("extensions-cache.json");
+    cacheFn = rf2.getFirstOrCreateDefault();
+  }
+  ExtensionsCache cache(cacheFn);
+  base::Chrono chrono;
+
   ResourceFinder rf;
   rf.includeUserDir("extensions");
   rf.includeDataDir("extensions");
@@ -1088,13 +1100,21 @@ Extensions::Extensions()
       }
 
       try {
-        loadExtension(dir, fullFn, isBuiltinExtension);
+        loadExtension(dir, fullFn, isBuiltinExtension, &cache);
       }
       catch (const std::exception& ex) {
         LOG("EXT: Error loading JSON file: %s\n", ex.what());
       }
     }
   }
+
+  cache.save();
+
+  LOG(INFO,
+      "EXT: %d extensions loaded in %.2f ms (%d from cache)\n",
+      int(m_extensions.size()),
+      chrono.elapsed() * 1000.0,
+      cache.hits());
 }
 
 Extensions::~Extensions()
@@ -1353,10 +1373,15 @@ Extension* Extensions::installCompressedExtension(const std::string& zipFn,
 
 Extension* Extensions::loadExtension(const std::string& path,
                                      const std::string& fullPackageFilename,
-                                     const bool isBuiltinExtension)
+                                     const bool isBuiltinExtension,
+                                     ExtensionsCache* cache)
 {
   json11::Json json;
-  read_json_file(fullPackageFilename, json);
+  if (!cache || !cache->get(fullPackageFilename, json)) {
+    read_json_file(fullPackageFilename, json);
+    if (cache)
+      cache->set(fullPackageFilename, json);
+  }
   const auto& name = json["name"].string_value();
   const auto& version = json["version"].string_value();
   const auto& displayName = json["displayName"].string_value();
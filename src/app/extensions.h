@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2020-2024  Igara Studio S.A.
+// Copyright (C) 2020-2026  Igara Studio S.A.
 // Copyright (C) 2017-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -35,6 +35,7 @@ using ExtensionItems = std::map<std::string, std::string>;
 
 class Extensions;
 class Doc;
+class ExtensionsCache;
 
 struct ExtensionInfo {
   std::string name;
@@ -253,7 +254,8 @@ public:
 private:
   Extension* loadExtension(const std::string& path,
                            const std::string& fullPackageFilename,
-                           bool isBuiltinExtension);
+                           bool isBuiltinExtension,
+                           ExtensionsCache* cache = nullptr);
   void generateExtensionSignals(Extension* extension);
 
   List m_extensions;
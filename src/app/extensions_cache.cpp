@@ -0,0 +1,151 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/extensions_cache.h"
+
+#include "base/file_content.h"
+#include "base/fs.h"
+#include "base/fstream_path.h"
+#include "base/log.h"
+#include "base/process.h"
+#include "base/time.h"
+#include "fmt/format.h"
+
+#include <fstream>
+#include <stdexcept>
+
+namespace app {
+
+namespace {
+
+// Increment this number if the format of the cache file changes
+constexpr int kCacheVersion = 1;
+
+// Key to identify the current version of the given file
+std::string file_key(const std::string& filename)
+{
+  const base::Time t = base::get_modification_time(filename);
+  return fmt::format("{} {:04}{:02}{:02}{:02}{:02}{:02}",
+                     base::file_size(filename),
+                     t.year,
+                     t.month,
+                     t.day,
+                     t.hour,
+                     t.minute,
+                     t.second);
+}
+
+} // anonymous namespace
+
+ExtensionsCache::ExtensionsCache(const std::string& filename) : m_filename(filename)
+{
+  if (m_filename.empty() || !base::is_file(m_filename))
+    return;
+
+  try {
+    const base::buffer buf = base::read_file_content(m_filename);
+    std::string err;
+    const json11::Json json = json11::Json::parse(std::string(buf.begin(), buf.end()), err);
+    if (!err.empty() || json["version"].int_value() != kCacheVersion)
+      return;
+
+    for (const auto& item : json["packages"].object_items()) {
+      Entry& entry = m_entries[item.first];
+      entry.key = item.second["key"].string_value();
+      entry.json = item.second["json"];
+    }
+  }
+  catch (const std::exception& ex) {
+    LOG(ERROR, "EXT: Error loading extensions cache '%s': %s\n", m_filename.c_str(), ex.what());
+    m_entries.clear();
+  }
+}
+
+bool ExtensionsCache::get(const std::string& packageFn, json11::Json& json)
+{
+  auto it = m_entries.find(packageFn);
+  if (it == m_entries.end() || it->second.key != file_key(packageFn)) {
+    ++m_misses;
+    return false;
+  }
+
+  ++m_hits;
+  it->second.used = true;
+  json = it->second.json;
+  return true;
+}
+
+void ExtensionsCache::set(const std::string& packageFn, const json11::Json& json)
+{
+  Entry& entry = m_entries[packageFn];
+  entry.key = file_key(packageFn);
+  entry.json = json;
+  entry.used = true;
+  m_modified = true;
+}
+
+void ExtensionsCache::save()
+{
+  json11::Json::object packages;
+  for (const auto& item : m_entries) {
+    if (item.second.used) {
+      packages[item.first] = json11::Json::object{
+        { "key",  item.second.key  },
+        { "json", item.second.json }
+      };
+    }
+    else {
+      // An extension was removed
+      m_modified = true;
+    }
+  }
+
+  if (!m_modified || m_filename.empty())
+    return;
+
+  const json11::Json json = json11::Json::object{
+    { "version",  kCacheVersion },
+    { "packages", packages      }
+  };
+  std::string text;
+  json.dump(text);
+
+  // Write a temporary file and then rename it, so other processes
+  // (e.g. several "aseprite -b" running at the same time) never read
+  // an incomplete cache, and a crash doesn't leave it corrupted.
+  const std::string tmp = fmt::format("{}.{}.tmp", m_filename, base::get_current_process_id());
+  try {
+    {
+      std::ofstream out(FSTREAM_PATH(tmp), std::ofstream::binary);
+      out.write(text.c_str(), text.size());
+      if (!out)
+        throw std::runtime_error("Error writing file");
+    }
+#ifdef _WIN32
+    // MoveFile() doesn't replace existing files
+    if (base::is_file(m_filename))
+      base::delete_file(m_filename);
+#endif
+    base::move_file(tmp, m_filename);
+  }
+  catch (const std::exception& ex) {
+    LOG(ERROR, "EXT: Error saving extensions cache '%s': %s\n", m_filename.c_str(), ex.what());
+    if (base::is_file(tmp)) {
+      try {
+        base::delete_file(tmp);
+      }
+      catch (const std::exception&) {
+      }
+    }
+  }
+  m_modified = false;
+}
+
+} // namespace app
@@ -0,0 +1,57 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_EXTENSIONS_CACHE_H_INCLUDED
+#define APP_EXTENSIONS_CACHE_H_INCLUDED
+#pragma once
+
+#include "json11.hpp"
+
+#include <map>
+#include <string>
+
+namespace app {
+
+// Cache of the parsed package.json files of all extensions stored in
+// one file, so we don't need to read and parse each package.json
+// file again on each launch.
+//
+// Each entry is validated with the size and modification time of its
+// package.json file. Only the entries used in the current session are
+// saved again (so entries of removed extensions are discarded).
+class ExtensionsCache {
+public:
+  explicit ExtensionsCache(const std::string& filename);
+
+  // Returns true if the given package.json file is in the cache and
+  // it wasn't modified, in that case "json" is its parsed content.
+  bool get(const std::string& packageFn, json11::Json& json);
+
+  void set(const std::string& packageFn, const json11::Json& json);
+
+  // Saves the cache file if it needs to be updated.
+  void save();
+
+  int hits() const { return m_hits; }
+  int misses() const { return m_misses; }
+
+private:
+  struct Entry {
+    std::string key;
+    json11::Json json;
+    bool used = false;
+  };
+
+  std::string m_filename;
+  std::map<std::string, Entry> m_entries;
+  int m_hits = 0;
+  int m_misses = 0;
+  bool m_modified = false;
+};
+
+} // namespace app
+
+#endif
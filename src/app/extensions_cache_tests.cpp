@@ -0,0 +1,129 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#include "tests/app_test.h"
+
+#include "app/extensions_cache.h"
+#include "base/fs.h"
+#include "base/process.h"
+#include "fmt/format.h"
+
+#include <fstream>
+
+using namespace app;
+
+static const char* kCacheFile = "_extensions_cache.json";
+static const char* kPackageA = "_extensions_package_a.json";
+static const char* kPackageB = "_extensions_package_b.json";
+
+static void write_file(const char* fn, const char* content)
+{
+  std::ofstream f(fn, std::ofstream::binary);
+  f << content;
+}
+
+TEST(ExtensionsCache, SaveAndLoad)
+{
+  if (base::is_file(kCacheFile))
+    base::delete_file(kCacheFile);
+  write_file(kPackageA, "{\"name\":\"a\"}");
+  write_file(kPackageB, "{\"name\":\"b\"}");
+
+  {
+    ExtensionsCache cache(kCacheFile);
+    json11::Json json;
+    EXPECT_FALSE(cache.get(kPackageA, json));
+    cache.set(kPackageA, json11::Json::object{ { "name", "a" } });
+    EXPECT_FALSE(cache.get(kPackageB, json));
+    cache.set(kPackageB, json11::Json::object{ { "name", "b" } });
+    EXPECT_EQ(0, cache.hits());
+    EXPECT_EQ(2, cache.misses());
+    cache.save();
+  }
+  ASSERT_TRUE(base::is_file(kCacheFile));
+
+  // Only "a" is used in this session, so "b" is removed from the cache
+  {
+    ExtensionsCache cache(kCacheFile);
+    json11::Json json;
+    ASSERT_TRUE(cache.get(kPackageA, json));
+    EXPECT_EQ("a", json["name"].string_value());
+    EXPECT_EQ(1, cache.hits());
+    cache.save();
+  }
+  {
+    ExtensionsCache cache(kCacheFile);
+    json11::Json json;
+    EXPECT_TRUE(cache.get(kPackageA, json));
+    EXPECT_FALSE(cache.get(kPackageB, json));
+  }
+
+  base::delete_file(kCacheFile);
+  base::delete_file(kPackageA);
+  base::delete_file(kPackageB);
+}
+
+TEST(ExtensionsCache, ModifiedPackage)
+{
+  if (base::is_file(kCacheFile))
+    base::delete_file(kCacheFile);
+  write_file(kPackageA, "{\"name\":\"a\"}");
+
+  {
+    ExtensionsCache cache(kCacheFile);
+    cache.set(kPackageA, json11::Json::object{ { "name", "a" } });
+    cache.save();
+  }
+
+  // A package.json with a different size is parsed again
+  write_file(kPackageA, "{\"name\":\"abc\"}");
+  {
+    ExtensionsCache cache(kCacheFile);
+    json11::Json json;
+    EXPECT_FALSE(cache.get(kPackageA, json));
+    EXPECT_EQ(1, cache.misses());
+  }
+
+  base::delete_file(kCacheFile);
+  base::delete_file(kPackageA);
+}
+
+TEST(ExtensionsCache, InvalidCacheFile)
+{
+  write_file(kCacheFile, "{ invalid json");
+  write_file(kPackageA, "{\"name\":\"a\"}");
+
+  ExtensionsCache cache(kCacheFile);
+  json11::Json json;
+  EXPECT_FALSE(cache.get(kPackageA, json));
+
+  base::delete_file(kCacheFile);
+  base::delete_file(kPackageA);
+}
+
+TEST(ExtensionsCache, SaveReplacesFile)
+{
+  write_file(kCacheFile, "{ invalid json");
+  write_file(kPackageA, "{\"name\":\"a\"}");
+
+  {
+    ExtensionsCache cache(kCacheFile);
+    cache.set(kPackageA, json11::Json::object{ { "name", "a" } });
+    cache.save();
+  }
+
+  // The cache is written in a temporary file which is renamed
+  EXPECT_FALSE(
+    base::is_file(fmt::format("{}.{}.tmp", kCacheFile, base::get_current_process_id())));
+  {
+    ExtensionsCache cache(kCacheFile);
+    json11::Json json;
+    EXPECT_TRUE(cache.get(kPackageA, json));
+  }
+
+  base::delete_file(kCacheFile);
+  base::delete_file(kPackageA);
+}
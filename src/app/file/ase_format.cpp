@@ -9,6 +9,7 @@
   #include "config.h"
 #endif
 
+#include "app/cmd/convert_color_profile.h"
 #include "app/console.h"
 #include "app/context.h"
 #include "app/file/file.h"
@@ -19,14 +20,18 @@
 #include "dio/aseprite_common.h"
 #include "dio/aseprite_decoder.h"
 #include "dio/aseprite_encoder.h"
+#include "dio/aseprite_lazy_cels.h"
 #include "dio/decode_delegate.h"
 #include "dio/encode_delegate.h"
 #include "dio/file_interface.h"
 #include "doc/doc.h"
 #include "fmt/format.h"
+#include "render/render.h"
 #include "ui/alert.h"
 #include "ver/info.h"
 
+#include <algorithm>
+
 namespace app {
 
 using namespace base;
@@ -51,6 +56,15 @@ public:
 
   bool decodeOneFrame() override { return m_fop->isOneFrame(); }
 
+  bool decodePreview() override { return m_fop->isPreview(); }
+
+  std::string lazyCelsFilename() override
+  {
+    if (m_fop->config().lazyCels && !m_fop->isOneFrame() && !m_fop->isPreview())
+      return m_fop->filename();
+    return std::string();
+  }
+
   doc::color_t defaultSliceColor() override
   {
     auto color = m_fop->config().defaultSliceColor;
@@ -136,6 +150,8 @@ bool AseFormat::onLoad(FileOp* fop)
                    fop->config().fitCriteria);
 
   fop->createDocument(sprite);
+  if (decoder.lazyCels())
+    fop->document()->setLazyCels(decoder.lazyCels());
 
   if (sprite->colorSpace() != nullptr && sprite->colorSpace()->type() != gfx::ColorSpace::None) {
     fop->setEmbeddedColorProfile();
@@ -191,7 +207,11 @@ namespace {
 
 class EncodeDelegate : public dio::EncodeDelegate {
 public:
-  EncodeDelegate(FileOp* fop) : m_fop(fop) {}
+  EncodeDelegate(FileOp* fop, dio::AsepriteLazyCels* lazyCels)
+    : m_fop(fop)
+    , m_lazyCels(lazyCels)
+  {
+  }
   ~EncodeDelegate() {}
 
   void error(const std::string& msg) override { m_fop->setError(msg.c_str()); }
@@ -219,22 +239,98 @@ public:
 
   int preferredTilemapCelType() override { return ASE_FILE_COMPRESSED_TILEMAP; }
 
+  void compressedImageSaved(const doc::Image* image, size_t pos, size_t size) override
+  {
+    if (m_lazyCels)
+      m_lazyCels->imageSaved(image, pos, size);
+  }
+
+  const doc::Image* previewImage() override
+  {
+    if (!m_fop->config().savePreview)
+      return nullptr;
+    if (!m_preview)
+      m_preview = renderPreview();
+    return m_preview.get();
+  }
+
 private:
+  // Renders the first saved frame in a small RGB image (with the same
+  // size that the file selector uses for thumbnails).
+  doc::ImageRef renderPreview()
+  {
+    const doc::Sprite* spr = sprite();
+    const int w = spr->width() * spr->pixelRatio().w;
+    const int h = spr->height() * spr->pixelRatio().h;
+
+    int preview_w = w;
+    int preview_h = h;
+    if (std::max(w, h) > kPreviewSize) {
+      preview_w = std::clamp(kPreviewSize * w / std::max(w, h), 1, kPreviewSize);
+      preview_h = std::clamp(kPreviewSize * h / std::max(w, h), 1, kPreviewSize);
+    }
+
+    doc::ImageRef image(doc::Image::create(doc::IMAGE_RGB, preview_w, preview_h));
+
+    render::Render render;
+    render.setBgOptions(render::BgOptions::MakeTransparent());
+    render.setProjection(render::Projection(spr->pixelRatio(), render::Zoom(preview_w, w)));
+    render.renderSprite(image.get(), spr, fromFrame(), gfx::Clip(0, 0, 0, 0, w, h));
+
+    // The preview is always saved in sRGB
+    auto cs = spr->colorSpace();
+    if (m_fop->preserveColorProfile() && cs && !cs->nearlyEqual(*gfx::ColorSpace::MakeSRGB()))
+      app::cmd::convert_color_profile(image.get(), nullptr, cs, gfx::ColorSpace::MakeSRGB());
+
+    return image;
+  }
+
+  static constexpr int kPreviewSize = 128;
+
   FileOp* m_fop;
+  dio::AsepriteLazyCels* m_lazyCels;
+  doc::ImageRef m_preview;
 };
 
 } // namespace
 
 bool AseFormat::onSave(FileOp* fop)
 {
-  FileHandle handle(open_file_with_exception_sync_on_close(fop->filename(), "wb"));
-  dio::StdioFileInterface fileInterface(handle.get());
+  // Load all lazy cels before overwriting the file from where they
+  // are loaded, so we don't overwrite it if some cel cannot be
+  // decoded. After saving, the cels are loaded from the new file.
+  std::shared_ptr<dio::AsepriteLazyCels> lazyCels = fop->document()->lazyCels();
+  if (lazyCels &&
+      base::normalize_path(lazyCels->filename()) == base::normalize_path(fop->filename())) {
+    if (!lazyCels->beginSave())
+      return false;
+  }
+  else {
+    lazyCels.reset();
+  }
+
+  bool result = false;
+  try {
+    FileHandle handle(open_file_with_exception_sync_on_close(fop->filename(), "wb"));
+    dio::StdioFileInterface fileInterface(handle.get());
 
-  EncodeDelegate delegate(fop);
-  dio::AsepriteEncoder encoder;
-  encoder.initialize(&delegate, &fileInterface);
+    EncodeDelegate delegate(fop, lazyCels.get());
+    dio::AsepriteEncoder encoder;
+    encoder.initialize(&delegate, &fileInterface);
+
+    result = encoder.encode();
+  }
+  catch (...) {
+    if (lazyCels)
+      lazyCels->endSave(false);
+    throw;
+  }
 
-  return encoder.encode();
+  // The file must be closed here, so endSave() gets its final
+  // size/time
+  if (lazyCels)
+    lazyCels->endSave(result);
+  return result;
 }
 
 #endif // ENABLE_SAVE
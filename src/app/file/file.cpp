@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -33,12 +33,15 @@
 #include "app/ui/status_bar.h"
 #include "base/fs.h"
 #include "base/string.h"
+#include "dio/aseprite_lazy_cels.h"
 #include "dio/detect_format.h"
 #include "doc/algorithm/resize_image.h"
 #include "doc/doc.h"
+#include "doc/task_scheduler.h"
 #include "fmt/format.h"
 #include "render/quantization.h"
 #include "render/render.h"
+#include "trace/trace.h"
 #include "ui/alert.h"
 #include "ui/listitem.h"
 #include "ui/system.h"
@@ -48,6 +51,7 @@
 #include "open_sequence.xml.h"
 
 #include <algorithm>
+#include <condition_variable>
 #include <cstdarg>
 #include <cstring>
 
@@ -166,6 +170,10 @@ public:
     }
   }
 
+  // The resize uses the shared m_tmpUnscaledRender image and the
+  // sprite RgbMap, so only renders without resize can be parallel.
+  bool canRenderFramesInParallel() const override { return !needResize(); }
+
   void setScale(const gfx::PointF& scale)
   {
     m_scale = scale;
@@ -173,9 +181,9 @@ public:
     m_spec.setHeight(m_spec.height() * m_scale.y);
   }
 
-private:
   bool needResize() const { return (m_scale != gfx::PointF(1.0, 1.0)); }
 
+private:
   const Doc* m_doc;
   const doc::Sprite* m_sprite;
   doc::ImageSpec m_spec;
@@ -489,6 +497,10 @@ FileOp* FileOp::createLoadDocumentOperation(Context* context,
   if (flags & FILE_LOAD_ONE_FRAME)
     fop->m_oneframe = true;
 
+  // Load just a preview (e.g. to generate a thumbnail)
+  if (flags & FILE_LOAD_PREVIEW)
+    fop->m_preview = true;
+
   if (flags & FILE_LOAD_CREATE_PALETTE)
     fop->m_createPaletteFromRgba = true;
 
@@ -531,6 +543,14 @@ FileOp* FileOp::createSaveDocumentOperation(const Context* context,
     return fop.release();
   }
 
+  // The document is damaged if some cel couldn't be decoded, saving it
+  // would lose the original pixels of those cels.
+  if (fop->m_document->lazyCels() && fop->m_document->lazyCels()->hasErrors()) {
+    fop->setError("Some cels of \"%s\" couldn't be decoded, the sprite cannot be saved\n",
+                  fop->m_document->lazyCels()->filename().c_str());
+    return fop.release();
+  }
+
   // Get the format through the extension of the filename
   fop->m_format = FileFormatsManager::instance()->getFileFormat(
     dio::detect_format_by_file_extension(filename));
@@ -786,6 +806,7 @@ bool FileOp::checkIfFormatSupportResizeOnTheFly(const std::string& filename)
 // TODO refactor this code
 void FileOp::operate(IFileOpProgress* progress)
 {
+  TRACE_ZONE("FileOp::operate");
   ASSERT(!isDone());
 
   m_progressInterface = progress;
@@ -945,8 +966,13 @@ void FileOp::operate(IFileOpProgress* progress)
     //      is already checked in SaveFileBaseCommand::saveDocumentInBackground
     //      and only in UI mode (so the CLI still works)
 
+    // Save a sequence encoding several frames at the same time
+    if (isSequence() && canSaveSequenceInParallel()) {
+      ASSERT(m_format->support(FILE_SUPPORT_SEQUENCES));
+      saveSequenceInParallel();
+    }
     // Save a sequence
-    if (isSequence()) {
+    else if (isSequence()) {
       ASSERT(m_format->support(FILE_SUPPORT_SEQUENCES));
 
       Sprite* sprite = m_document->sprite();
@@ -1024,6 +1050,13 @@ void FileOp::operate(IFileOpProgress* progress)
       }
     }
 
+    // Cels that couldn't be decoded (loaded on demand while they were
+    // saved) were saved empty, so the document wasn't saved correctly.
+    if (m_document && m_document->lazyCels() && m_document->lazyCels()->hasErrors()) {
+      setError("Some cels of \"%s\" couldn't be decoded, the sprite cannot be saved\n",
+               m_document->lazyCels()->filename().c_str());
+    }
+
     // Save special data from .aseprite-data file
     if (m_document && m_document->sprite() && !hasError() && !m_dataFilename.empty()) {
       try {
@@ -1045,6 +1078,198 @@ void FileOp::operate(IFileOpProgress* progress)
   setProgress(1.0f);
 }
 
+bool FileOp::canSaveSequenceInParallel() const
+{
+  return (m_format->support(FILE_ENCODE_THREAD_SAFE) && m_seq.filename_list.size() > 1 &&
+          doc::TaskScheduler::instance().workersCount() > 0 &&
+          // Resizing on the fly uses the sprite RgbMap, which cannot
+          // be used from several threads.
+          (!m_abstractImage || !m_abstractImage->needResize()));
+}
+
+// Renders each frame of the sequence in this thread and encodes it in
+// a TaskScheduler task. The number of rendered frames waiting to be
+// encoded is limited to kMaxParallelSequenceMemSize bytes.
+void FileOp::saveSequenceInParallel()
+{
+  static constexpr std::size_t kMaxParallelSequenceMemSize = 256 * 1024 * 1024;
+
+  struct FrameOp {
+    std::unique_ptr<FileOp> fop;
+    int outputFrame;
+  };
+  using FrameOpPtr = std::shared_ptr<FrameOp>;
+
+  auto& scheduler = doc::TaskScheduler::instance();
+  const Sprite* sprite = m_document->sprite();
+  const gfx::Size canvasSize = m_roi.fileCanvasSize();
+  const std::size_t frameMemSize = std::max<std::size_t>(
+    1,
+    std::size_t(sprite->spec().bytesPerPixel()) * canvasSize.w * canvasSize.h);
+  const int maxPending = int(std::clamp<std::size_t>(kMaxParallelSequenceMemSize / frameMemSize,
+                                                     1,
+                                                     2 * scheduler.concurrency()));
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  FrameOpPtr failed; // First frame (lowest outputFrame) that couldn't be saved
+  std::vector<doc::TaskScheduler::TokenRef> tasks;
+  int pending = 0; // Frames waiting to be encoded or being encoded
+  int encoded = 0;
+
+  m_seq.progress_offset = 0.0f;
+  m_seq.progress_fraction = 1.0f / (double)sprite->totalFrames();
+
+  // The progress is updated only from this thread, the tasks just
+  // count the encoded frames.
+  auto updateProgress = [this](const int encodedFrames) {
+    m_seq.progress_offset = m_seq.progress_fraction * encodedFrames;
+    setProgress(0.0);
+  };
+
+  render::Render render;
+  render.setNewBlend(m_config.newBlend);
+
+  frame_t outputFrame = 0;
+  int savedFrames = 0;
+  for (frame_t frame : m_roi.framesSequence()) {
+    int encodedFrames;
+    {
+      const std::lock_guard lock(mutex);
+      // Stop rendering/encoding new frames after the first error
+      if (failed)
+        break;
+      encodedFrames = encoded;
+    }
+    updateProgress(encodedFrames);
+
+    if (isStop())
+      break;
+
+    gfx::Rect bounds = m_roi.frameBounds(frame);
+    if (bounds.isEmpty())
+      continue; // Skip frame because there is no slice key
+
+    // Render the (unscaled) sequenced image.
+    ImageRef image(Image::create(sprite->pixelFormat(), canvasSize.w, canvasSize.h));
+    render.renderSprite(image.get(), sprite, frame, gfx::Clip(gfx::Point(0, 0), bounds));
+
+    // Check if we have to ignore empty frames
+    if (!m_ignoreEmpty || sprite->isOpaque() || !doc::is_empty_image(image.get())) {
+      // Setup the filename to be used and make directories
+      m_filename = m_seq.filename_list[outputFrame];
+      makeDirectories();
+
+      auto op = std::make_shared<FrameOp>();
+      op->fop.reset(createSequenceFrameOperation(frame, savedFrames++, image, bounds.size()));
+      op->outputFrame = outputFrame;
+      image.reset();
+
+      {
+        std::unique_lock lock(mutex);
+        cond.wait(lock, [&] { return pending < maxPending || failed; });
+        if (failed)
+          break;
+        ++pending;
+      }
+
+      // The task keeps the only reference to the frame (and its
+      // image), so it's released as soon as the frame is encoded.
+      tasks.push_back(
+        scheduler.run([this, op, &mutex, &cond, &failed, &pending, &encoded](
+                        doc::TaskScheduler::Token&) {
+          // Frames after a frame that couldn't be saved are not
+          // saved (as in the sequential save)
+          bool skip;
+          {
+            const std::lock_guard lock(mutex);
+            skip = (failed && failed->outputFrame < op->outputFrame);
+          }
+
+          bool ok = true;
+          if (!skip) {
+            try {
+              ok = m_format->save(op->fop.get());
+            }
+            catch (const std::exception& ex) {
+              op->fop->setError("%s\n", ex.what());
+              ok = false;
+            }
+          }
+
+          const std::lock_guard lock(mutex);
+          --pending;
+          if (!ok) {
+            if (!failed || op->outputFrame < failed->outputFrame)
+              failed = op;
+          }
+          else if (!skip) {
+            ++encoded;
+          }
+          cond.notify_all();
+        }));
+    }
+
+    ++outputFrame;
+  }
+
+  // Wait the pending frames updating the progress
+  {
+    std::unique_lock lock(mutex);
+    while (pending > 0) {
+      cond.wait(lock);
+      const int encodedFrames = encoded;
+      lock.unlock();
+      updateProgress(encodedFrames);
+      lock.lock();
+    }
+  }
+
+  // The tasks notify "cond" just before they finish, so we have to
+  // wait them before destroying the variables they use.
+  for (auto& task : tasks)
+    task->wait();
+
+  // Report the error of the first frame that couldn't be saved
+  if (failed) {
+    const FileOp* fop = failed->fop.get();
+    if (fop->hasError())
+      setError("%s", fop->error().c_str());
+    setError("Error saving frame %d in the file \"%s\"\n",
+             failed->outputFrame + 1,
+             fop->filename().c_str());
+  }
+
+  m_filename = *m_seq.filename_list.begin();
+}
+
+// Creates a FileOp to save just one frame of this sequence from a
+// worker thread (with its own image, palette and filename).
+FileOp* FileOp::createSequenceFrameOperation(const frame_t frame,
+                                             const int savedFrames,
+                                             const ImageRef& image,
+                                             const gfx::Size& frameSize)
+{
+  auto fop = new FileOp(FileOpSave, m_context, &m_config);
+  fop->m_format = m_format;
+  fop->m_document = m_document;
+  fop->m_roi = m_roi;
+  fop->m_ignoreEmpty = m_ignoreEmpty;
+  fop->m_formatOptions = m_formatOptions;
+  fop->m_filename = m_filename;
+  fop->m_seq.filename_list.push_back(m_filename);
+  fop->m_seq.palette = new Palette(frame_t(0), 256);
+  fop->m_seq.image = image;
+  fop->m_seq.frame = savedFrames;
+  m_document->sprite()->palette(frame)->copyColorsTo(fop->m_seq.palette);
+
+  if (m_abstractImage) {
+    fop->makeAbstractImage();
+    fop->m_abstractImage->setSpecSize(m_roi.fileCanvasSize(), frameSize);
+  }
+  return fop;
+}
+
 // After mark the 'fop' as 'done' you must to free it calling fop_free().
 void FileOp::done()
 {
@@ -1457,6 +1682,7 @@ FileOp::FileOp(FileOpType type, Context* context, const FileOpConfig* config)
   , m_done(false)
   , m_stop(false)
   , m_oneframe(false)
+  , m_preview(false)
   , m_createPaletteFromRgba(false)
   , m_ignoreEmpty(false)
   , m_avoidBackgroundLayer(false)
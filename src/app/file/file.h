@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2023  Igara Studio S.A.
+// Copyright (C) 2018-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -35,6 +35,7 @@
 #define FILE_LOAD_DATA_FILE              0x00000020
 #define FILE_LOAD_CREATE_PALETTE         0x00000040
 #define FILE_LOAD_AVOID_BACKGROUND_LAYER 0x00000080
+#define FILE_LOAD_PREVIEW                0x00000100
 
 namespace doc {
 class Tag;
@@ -139,6 +140,10 @@ public:
   virtual void renderFrame(const doc::frame_t frame,
                            const gfx::Rect& frameBounds,
                            doc::Image* dst) const = 0;
+
+  // Returns true if renderFrame() can be called from several threads
+  // at the same time (e.g. to render frames in parallel).
+  virtual bool canRenderFramesInParallel() const { return false; }
 };
 
 // Structure to load & save files.
@@ -166,6 +171,7 @@ public:
 
   bool isSequence() const { return !m_seq.filename_list.empty(); }
   bool isOneFrame() const { return m_oneframe; }
+  bool isPreview() const { return m_preview; }
   bool ignoreEmpty() const { return m_ignoreEmpty; }
   bool preserveColorProfile() const { return m_config.preserveColorProfile; }
   const FileFormat* fileFormat() const { return m_format; }
@@ -305,6 +311,8 @@ private:
   bool m_oneframe;                    // Load just one frame (in formats
                                       // that support animation like
                                       // GIF/FLI/ASE).
+  bool m_preview;                     // Load just a preview image (if
+                                      // the file has one embedded).
   bool m_createPaletteFromRgba;
   bool m_ignoreEmpty;
   bool m_avoidBackgroundLayer;
@@ -344,6 +352,14 @@ private:
   void prepareForSequence();
   void makeAbstractImage();
   void makeDirectories();
+
+  // Used to save each frame of a sequence in its own thread.
+  bool canSaveSequenceInParallel() const;
+  void saveSequenceInParallel();
+  FileOp* createSequenceFrameOperation(frame_t frame,
+                                       int savedFrames,
+                                       const ImageRef& image,
+                                       const gfx::Size& frameSize);
 };
 
 // Available extensions for each load/save operation.
@@ -0,0 +1,348 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/app.h"
+#include "app/cli/app_options.h"
+#include "app/context.h"
+#include "app/doc.h"
+#include "app/file/file.h"
+#include "app/file/file_format.h"
+#include "app/file/file_formats_manager.h"
+#include "base/fs.h"
+#include "base/process.h"
+#include "dio/detect_format.h"
+#include "doc/doc.h"
+#include "fmt/format.h"
+#include "os/system.h"
+#include "ui/ui.h"
+
+#include <benchmark/benchmark.h>
+
+#include <iterator>
+#include <memory>
+#include <random>
+
+using namespace app;
+using namespace doc;
+
+namespace {
+
+// Formats that can be loaded/saved in the benchmarks. PSD files are
+// not included because we cannot save them to generate the files to
+// load. Format options (e.g. WebP compression, .aseprite cel format)
+// are taken from the user preferences, so we can compare the results
+// changing them.
+const char* kExtensions[] = { "aseprite", "png", "gif", "webp", "qoi", "tga", "bmp" };
+
+enum FileExt { ASE, PNG, GIF, WEBP, QOI, TGA, BMP };
+
+constexpr int kTileSize = 16;
+constexpr int kTiles = 64;
+
+// Draws random rectangles with a few colors (similar to pixel art, so
+// it compresses like real files instead of random noise).
+void draw_random_rects(Image* image, std::mt19937& rng)
+{
+  static const color_t colors[] = {
+    rgba(0, 0, 0, 0),
+    rgba(34, 32, 52, 255),
+    rgba(69, 40, 60, 255),
+    rgba(102, 57, 49, 255),
+    rgba(143, 86, 59, 255),
+    rgba(223, 113, 38, 255),
+    rgba(217, 160, 102, 255),
+    rgba(238, 195, 154, 255),
+    rgba(251, 242, 54, 255),
+  };
+  constexpr int ncolors = int(sizeof(colors) / sizeof(colors[0]));
+
+  clear_image(image, 0);
+  const int w = image->width();
+  const int h = image->height();
+  for (int i = 0; i < 32; ++i) {
+    const int x = int(rng() % w);
+    const int y = int(rng() % h);
+    fill_rect(image,
+              x,
+              y,
+              x + int(rng() % (w / 4 + 1)),
+              y + int(rng() % (h / 4 + 1)),
+              colors[rng() % ncolors]);
+  }
+}
+
+// Creates a synthetic RGB document with "nlayers" layers and
+// "nframes" frames (all cels are different). With "tilemaps" the
+// layers are tilemaps of one tileset.
+Doc* create_doc(Context* ctx, int w, int h, int nframes, int nlayers, bool tilemaps)
+{
+  std::mt19937 rng(w * h + nframes * 31 + nlayers);
+
+  auto* sprite = new Sprite(ImageSpec(ColorMode::RGB, w, h), 256);
+  sprite->setTotalFrames(nframes);
+
+  if (tilemaps) {
+    auto* tileset = new Tileset(sprite, Grid::MakeRect(gfx::Size(kTileSize, kTileSize)), kTiles);
+    for (tile_index ti = 1; ti < kTiles; ++ti) {
+      ImageRef tile(Image::create(IMAGE_RGB, kTileSize, kTileSize));
+      draw_random_rects(tile.get(), rng);
+      tileset->set(ti, tile);
+    }
+    sprite->tilesets()->add(tileset);
+  }
+
+  for (int i = 0; i < nlayers; ++i) {
+    LayerImage* layer;
+    if (tilemaps)
+      layer = new LayerTilemap(sprite, 0);
+    else
+      layer = new LayerImage(sprite);
+    layer->setName(fmt::format("Layer {}", i + 1));
+    sprite->root()->addLayer(layer);
+
+    for (frame_t frame = 0; frame < nframes; ++frame) {
+      ImageRef image;
+      if (tilemaps) {
+        image.reset(Image::create(IMAGE_TILEMAP,
+                                  (w + kTileSize - 1) / kTileSize,
+                                  (h + kTileSize - 1) / kTileSize));
+        for (int y = 0; y < image->height(); ++y)
+          for (int x = 0; x < image->width(); ++x)
+            put_pixel(image.get(), x, y, doc::tile(rng() % kTiles, 0));
+      }
+      else {
+        image.reset(Image::create(IMAGE_RGB, w, h));
+        draw_random_rects(image.get(), rng);
+      }
+      layer->addCel(new Cel(frame, image));
+    }
+  }
+
+  return ctx->documents().add(new Doc(sprite));
+}
+
+const FileFormat* get_format(const std::string& filename)
+{
+  return FileFormatsManager::instance()->getFileFormat(
+    dio::detect_format_by_file_extension(filename));
+}
+
+// Formats that don't support frames are saved as a sequence of files
+// (e.g. bench0.png, bench1.png, etc.)
+bool is_sequence(const FileFormat* format, const int nframes)
+{
+  return (nframes > 1 && !format->support(FILE_SUPPORT_FRAMES));
+}
+
+// Directory where the benchmark files are saved (a temporary
+// directory that is removed at the end)
+std::string g_benchDir;
+
+std::string bench_path(const std::string& filename)
+{
+  return base::join_path(g_benchDir, filename);
+}
+
+std::string first_filename(const std::string& ext, const bool sequence)
+{
+  return bench_path((sequence ? "bench0." : "bench.") + ext);
+}
+
+void delete_bench_files()
+{
+  for (const auto& fn : base::list_files(g_benchDir, base::ItemType::Files))
+    base::delete_file(bench_path(fn));
+}
+
+bool save_file(Context* ctx, Doc* doc, const std::string& ext, const bool sequence)
+{
+  std::unique_ptr<FileOp> fop(FileOp::createSaveDocumentOperation(
+    ctx,
+    FileOpROI(doc, doc->sprite()->bounds(), "", "", FramesSequence(), false),
+    bench_path("bench." + ext),
+    (sequence ? bench_path("bench{frame}." + ext) : std::string()),
+    false));
+  if (!fop)
+    return false;
+
+  fop->operate();
+  fop->done();
+  return !fop->hasError();
+}
+
+std::unique_ptr<Doc> load_file(Context* ctx, const std::string& ext, const bool sequence)
+{
+  std::unique_ptr<FileOp> fop(FileOp::createLoadDocumentOperation(
+    ctx,
+    first_filename(ext, sequence),
+    (sequence ? FILE_LOAD_SEQUENCE_YES : FILE_LOAD_SEQUENCE_NONE)));
+  if (!fop)
+    return nullptr;
+
+  fop->operate();
+  fop->done();
+  if (fop->hasError())
+    return nullptr;
+  return std::unique_ptr<Doc>(fop->releaseDocument());
+}
+
+std::size_t files_size(const std::string& ext, const bool sequence, const int nframes)
+{
+  if (!sequence)
+    return base::file_size(bench_path("bench." + ext));
+
+  std::size_t size = 0;
+  for (int i = 0; i < nframes; ++i)
+    size += base::file_size(bench_path(fmt::format("bench{}.{}", i, ext)));
+  return size;
+}
+
+// Reports the throughput as MB/s of uncompressed RGBA pixels (one
+// image per layer and frame), the milliseconds per frame, and the
+// size of the file(s) to compare compression settings.
+void set_counters(benchmark::State& state,
+                  const std::string& ext,
+                  const bool sequence,
+                  const int w,
+                  const int h,
+                  const int nframes,
+                  const int nlayers)
+{
+  state.SetLabel(ext);
+  state.SetBytesProcessed(int64_t(state.iterations()) * w * h * 4 * nframes * nlayers);
+  // Inverted rate of nframes/1000 per second = milliseconds per frame
+  state.counters["ms/frame"] =
+    benchmark::Counter(nframes / 1000.0,
+                       benchmark::Counter::kIsIterationInvariantRate |
+                         benchmark::Counter::kInvert);
+  state.counters["file_size"] = benchmark::Counter(double(files_size(ext, sequence, nframes)),
+                                                   benchmark::Counter::kDefaults,
+                                                   benchmark::Counter::kIs1024);
+}
+
+} // anonymous namespace
+
+void BM_SaveFile(benchmark::State& state)
+{
+  const std::string ext = kExtensions[state.range(0)];
+  const int w = state.range(1);
+  const int h = state.range(2);
+  const int nframes = state.range(3);
+  const int nlayers = state.range(4);
+  const bool tilemaps = (state.range(5) != 0);
+
+  const FileFormat* format = get_format("bench." + ext);
+  if (!format) {
+    state.SkipWithError("Format not available");
+    return;
+  }
+  const bool sequence = is_sequence(format, nframes);
+
+  Context ctx;
+  std::unique_ptr<Doc> doc(create_doc(&ctx, w, h, nframes, nlayers, tilemaps));
+
+  for (auto _ : state) {
+    if (!save_file(&ctx, doc.get(), ext, sequence)) {
+      state.SkipWithError("Error saving file");
+      break;
+    }
+  }
+
+  set_counters(state, ext, sequence, w, h, nframes, nlayers);
+  delete_bench_files();
+  doc->close();
+}
+
+void BM_LoadFile(benchmark::State& state)
+{
+  const std::string ext = kExtensions[state.range(0)];
+  const int w = state.range(1);
+  const int h = state.range(2);
+  const int nframes = state.range(3);
+  const int nlayers = state.range(4);
+  const bool tilemaps = (state.range(5) != 0);
+
+  const FileFormat* format = get_format("bench." + ext);
+  if (!format) {
+    state.SkipWithError("Format not available");
+    return;
+  }
+  const bool sequence = is_sequence(format, nframes);
+
+  Context ctx;
+  {
+    std::unique_ptr<Doc> doc(create_doc(&ctx, w, h, nframes, nlayers, tilemaps));
+    const bool saved = save_file(&ctx, doc.get(), ext, sequence);
+    doc->close();
+    if (!saved) {
+      delete_bench_files();
+      state.SkipWithError("Error saving file");
+      return;
+    }
+  }
+
+  for (auto _ : state) {
+    std::unique_ptr<Doc> doc = load_file(&ctx, ext, sequence);
+    if (!doc) {
+      state.SkipWithError("Error loading file");
+      break;
+    }
+    benchmark::DoNotOptimize(doc.get());
+  }
+
+  set_counters(state, ext, sequence, w, h, nframes, nlayers);
+  delete_bench_files();
+}
+
+// Arguments: format, width, height, frames, layers, tilemaps
+static void FileArgs(benchmark::internal::Benchmark* b)
+{
+  for (int ext = ASE; ext <= BMP; ++ext) {
+    b->Args({ ext, 256, 256, 1, 1, 0 });
+    b->Args({ ext, 1024, 1024, 1, 1, 0 });
+    b->Args({ ext, 4096, 4096, 1, 1, 0 });
+    b->Args({ ext, 256, 256, 64, 1, 0 });
+    b->Args({ ext, 256, 256, 16, 8, 0 });
+  }
+  // Tilemaps are only saved as tilemaps in .aseprite files (other
+  // formats save the rendered frames)
+  b->Args({ ASE, 1024, 1024, 16, 4, 1 });
+  b->Args({ PNG, 1024, 1024, 16, 4, 1 });
+  b->Args({ GIF, 1024, 1024, 16, 4, 1 });
+}
+
+BENCHMARK(BM_SaveFile)->Apply(FileArgs)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_LoadFile)->Apply(FileArgs)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+int app_main(int argc, char* argv[])
+{
+  os::SystemRef system = os::System::make();
+  ui::UISystem uiSystem;
+  ui::Manager uiManager(nullptr);
+  ui::Theme uiTheme;
+  ui::set_theme(&uiTheme, 1);
+
+  App app;
+  const char* argv2[] = { argv[0], "--batch" };
+  app.initialize(AppOptions(std::size(argv2), argv2));
+
+  g_benchDir = base::join_path(base::get_temp_path(),
+                               fmt::format("aseprite-benchmark-{}",
+                                           base::get_current_process_id()));
+  base::make_all_directories(g_benchDir);
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  delete_bench_files();
+  base::remove_directory(g_benchDir);
+  return 0;
+}
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2023  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -32,6 +32,7 @@
 #define FILE_SUPPORT_PALETTE_WITH_ALPHA 0x00004000
 #define FILE_ENCODE_ABSTRACT_IMAGE      0x00008000 // Use the new FileAbstractImage
 #define FILE_GIF_ANI_LIMITATIONS        0x00010000
+#define FILE_ENCODE_THREAD_SAFE         0x00020000 // onSave() can run in parallel with other FileOps
 
 namespace app {
 
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2024  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 //
 // This program is distributed under the terms of
 // the End-User License Agreement for Aseprite.
@@ -52,6 +52,15 @@ struct FileOpConfig {
   // blend mode and opacity fields are valid for groups too.
   bool composeGroups = false;
 
+  // True if a small preview of the first frame is embedded in
+  // .aseprite files (to generate thumbnails quickly).
+  bool savePreview = false;
+
+  // True if the pixels of big cels in .aseprite files are loaded
+  // when they are needed (instead of loading all cels when the file
+  // is opened).
+  bool lazyCels = false;
+
   void fillFromPreferences();
 };
 
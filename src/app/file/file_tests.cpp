@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2023  Igara Studio S.A.
+// Copyright (C) 2018-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -12,15 +12,20 @@
 #include "app/doc.h"
 #include "app/file/file.h"
 #include "app/file/file_formats_manager.h"
+#include "app/pref/preferences.h"
 #include "base/base64.h"
+#include "base/fs.h"
+#include "dio/aseprite_lazy_cels.h"
 #include "doc/doc.h"
 #include "doc/user_data.h"
 #include "fmt/format.h"
+#include "render/render.h"
 
 #include <cstdio>
 #include <cstdlib>
 #include <fstream>
 #include <functional>
+#include <iterator>
 #include <vector>
 
 using namespace app;
@@ -363,3 +368,293 @@ TEST(File, CustomProperties)
     }
   }
 }
+
+TEST(File, PngSequence)
+{
+  app::Context ctx;
+  const int nframes = 16;
+
+  {
+    std::unique_ptr<Doc> doc(ctx.documents().add(8, 4, doc::ColorMode::RGB, 256));
+    Sprite* sprite = doc->sprite();
+    auto layer = static_cast<LayerImage*>(sprite->root()->firstLayer());
+    for (frame_t frame = 1; frame < nframes; ++frame) {
+      sprite->addFrame(frame);
+      layer->addCel(new Cel(frame, ImageRef(Image::create(IMAGE_RGB, 8, 4))));
+    }
+    for (frame_t frame = 0; frame < nframes; ++frame)
+      clear_image(layer->cel(frame)->image(), rgba(frame * 10, 255 - frame, 0, 255));
+
+    std::unique_ptr<FileOp> fop(FileOp::createSaveDocumentOperation(
+      &ctx,
+      FileOpROI(doc.get(), sprite->bounds(), "", "", FramesSequence(), false),
+      "test_seq.png",
+      "test_seq{frame}.png",
+      false));
+    ASSERT_TRUE(fop != nullptr);
+    fop->operate();
+    fop->done();
+    ASSERT_FALSE(fop->hasError());
+    ASSERT_EQ(nframes, int(fop->filenames().size()));
+    doc->close();
+  }
+
+  for (frame_t frame = 0; frame < nframes; ++frame) {
+    std::unique_ptr<Doc> doc(load_document(&ctx, fmt::format("test_seq{}.png", frame)));
+    ASSERT_TRUE(doc != nullptr);
+    ASSERT_EQ(1, doc->sprite()->totalFrames());
+
+    Image* image = doc->sprite()->root()->firstLayer()->cel(0)->image();
+    for (int y = 0; y < 4; ++y)
+      for (int x = 0; x < 8; ++x)
+        ASSERT_EQ(rgba(frame * 10, 255 - frame, 0, 255), get_pixel(image, x, y));
+    doc->close();
+  }
+}
+
+TEST(File, GifAnimation)
+{
+  app::Context ctx;
+  const int nframes = 12;
+
+  std::unique_ptr<Doc> doc(ctx.documents().add(32, 16, doc::ColorMode::RGB, 256));
+  Sprite* sprite = doc->sprite();
+  auto layer = static_cast<LayerImage*>(sprite->root()->firstLayer());
+  for (frame_t frame = 1; frame < nframes; ++frame) {
+    sprite->addFrame(frame);
+    layer->addCel(new Cel(frame, ImageRef(Image::create(IMAGE_RGB, 32, 16))));
+  }
+  // A square moving over a transparent background (to test the
+  // delta images and the disposal methods of each frame)
+  for (frame_t frame = 0; frame < nframes; ++frame) {
+    Image* image = layer->cel(frame)->image();
+    clear_image(image, 0);
+    fill_rect(image, frame * 2, 4, frame * 2 + 5, 9, rgba(255, frame * 20, 0, 255));
+    if (frame % 3 == 0)
+      put_pixel(image, 31, 15, rgba(0, 0, 255, 255));
+  }
+
+  doc->setFilename("test_anim.gif");
+  ASSERT_EQ(0, save_document(&ctx, doc.get()));
+
+  std::unique_ptr<Doc> doc2(load_document(&ctx, "test_anim.gif"));
+  ASSERT_TRUE(doc2 != nullptr);
+  ASSERT_EQ(nframes, doc2->sprite()->totalFrames());
+
+  ImageRef expected(Image::create(IMAGE_RGB, 32, 16));
+  ImageRef actual(Image::create(IMAGE_RGB, 32, 16));
+  render::Render render;
+  for (frame_t frame = 0; frame < nframes; ++frame) {
+    clear_image(expected.get(), 0);
+    clear_image(actual.get(), 0);
+    render.renderSprite(expected.get(), sprite, frame);
+    render.renderSprite(actual.get(), doc2->sprite(), frame);
+    for (int y = 0; y < 16; ++y) {
+      for (int x = 0; x < 32; ++x) {
+        const color_t a = get_pixel(expected.get(), x, y);
+        const color_t b = get_pixel(actual.get(), x, y);
+        if (rgba_geta(a) == 0)
+          ASSERT_EQ(0, rgba_geta(b));
+        else
+          ASSERT_EQ(a, b);
+      }
+    }
+  }
+
+  doc2->close();
+  doc->close();
+}
+
+TEST(File, AsepritePreview)
+{
+  app::Context ctx;
+  auto& pref = Preferences::instance();
+  const bool savePreview = pref.asepriteFormat.savePreview();
+
+  {
+    std::unique_ptr<Doc> doc(ctx.documents().add(256, 64, doc::ColorMode::RGB, 256));
+    Image* image = doc->sprite()->root()->firstLayer()->cel(0)->image();
+    clear_image(image, rgba(255, 0, 0, 255));
+
+    doc->setFilename("test_preview.aseprite");
+    pref.asepriteFormat.savePreview(true);
+    save_document(&ctx, doc.get());
+    pref.asepriteFormat.savePreview(savePreview);
+    doc->close();
+  }
+
+  // Load the preview only
+  {
+    std::unique_ptr<FileOp> fop(
+      FileOp::createLoadDocumentOperation(&ctx,
+                                          "test_preview.aseprite",
+                                          FILE_LOAD_SEQUENCE_NONE | FILE_LOAD_PREVIEW));
+    ASSERT_TRUE(fop != nullptr);
+    fop->operate();
+    fop->done();
+    ASSERT_FALSE(fop->hasError());
+
+    std::unique_ptr<Doc> doc(fop->releaseDocument());
+    ASSERT_TRUE(doc != nullptr);
+    const Sprite* sprite = doc->sprite();
+    EXPECT_EQ(128, sprite->width());
+    EXPECT_EQ(32, sprite->height());
+    EXPECT_EQ(1, sprite->totalFrames());
+
+    const Image* image = sprite->root()->firstLayer()->cel(0)->image();
+    for (int y = 0; y < 32; ++y)
+      for (int x = 0; x < 128; ++x)
+        ASSERT_EQ(rgba(255, 0, 0, 255), get_pixel(image, x, y));
+  }
+
+  // The preview chunk is ignored in a regular load
+  {
+    std::unique_ptr<Doc> doc(load_document(&ctx, "test_preview.aseprite"));
+    ASSERT_TRUE(doc != nullptr);
+    EXPECT_EQ(256, doc->sprite()->width());
+    EXPECT_EQ(64, doc->sprite()->height());
+    doc->close();
+  }
+}
+
+TEST(File, LazyCels)
+{
+  app::Context ctx;
+  const int nframes = 4;
+
+  {
+    std::unique_ptr<Doc> doc(ctx.documents().add(128, 128, doc::ColorMode::RGB, 256));
+    Sprite* sprite = doc->sprite();
+    auto layer = static_cast<LayerImage*>(sprite->root()->firstLayer());
+    for (frame_t frame = 1; frame < nframes; ++frame) {
+      sprite->addFrame(frame);
+      layer->addCel(new Cel(frame, ImageRef(Image::create(IMAGE_RGB, 128, 128))));
+    }
+    for (frame_t frame = 0; frame < nframes; ++frame)
+      clear_image(layer->cel(frame)->image(), rgba(frame * 10, 255 - frame, 0, 255));
+
+    doc->setFilename("test_lazy.aseprite");
+    save_document(&ctx, doc.get());
+    doc->close();
+  }
+
+  FileOpConfig config;
+  config.lazyCels = true;
+  std::unique_ptr<FileOp> fop(FileOp::createLoadDocumentOperation(&ctx,
+                                                                  "test_lazy.aseprite",
+                                                                  FILE_LOAD_SEQUENCE_NONE,
+                                                                  &config));
+  ASSERT_TRUE(fop != nullptr);
+  fop->operate();
+  fop->done();
+  ASSERT_FALSE(fop->hasError());
+
+  std::unique_ptr<Doc> doc(fop->releaseDocument());
+  ASSERT_TRUE(doc != nullptr);
+  ASSERT_TRUE(doc->lazyCels() != nullptr);
+
+  Layer* layer = doc->sprite()->root()->firstLayer();
+  for (frame_t frame = 0; frame < nframes; ++frame) {
+    Image* image = layer->cel(frame)->image();
+    EXPECT_TRUE(image->isLazy());
+    EXPECT_FALSE(image->isLoaded());
+  }
+
+  // Load the pixels of all cels
+  for (frame_t frame = 0; frame < nframes; ++frame) {
+    Image* image = layer->cel(frame)->image();
+    EXPECT_EQ(rgba(frame * 10, 255 - frame, 0, 255), get_pixel(image, 127, 127));
+    EXPECT_TRUE(image->isLoaded());
+  }
+  EXPECT_LT(std::size_t(0), doc->lazyCels()->memSize());
+
+  // Modified cels are not unloaded
+  Image* modified = layer->cel(1)->image();
+  put_pixel(modified, 0, 0, rgba(1, 2, 3, 4));
+  modified->incrementVersion();
+
+  doc->lazyCels()->setMaxMemSize(0);
+  doc->lazyCels()->unloadImages();
+  EXPECT_EQ(std::size_t(0), doc->lazyCels()->memSize());
+  for (frame_t frame = 0; frame < nframes; ++frame)
+    EXPECT_EQ(frame == 1, layer->cel(frame)->image()->isLoaded());
+
+  // Unloaded cels are loaded again
+  for (frame_t frame = 0; frame < nframes; ++frame) {
+    Image* image = layer->cel(frame)->image();
+    EXPECT_EQ(rgba(frame * 10, 255 - frame, 0, 255), get_pixel(image, 127, 127));
+  }
+  EXPECT_EQ(rgba(1, 2, 3, 4), get_pixel(modified, 0, 0));
+
+  // Saving over the source file, all cels (even the modified one)
+  // can be unloaded and loaded from the new file
+  EXPECT_EQ(0, save_document(&ctx, doc.get()));
+  EXPECT_FALSE(doc->lazyCels()->hasErrors());
+  EXPECT_LT(std::size_t(0), doc->lazyCels()->memSize());
+  doc->lazyCels()->unloadImages();
+  EXPECT_EQ(std::size_t(0), doc->lazyCels()->memSize());
+  for (frame_t frame = 0; frame < nframes; ++frame) {
+    Image* image = layer->cel(frame)->image();
+    EXPECT_FALSE(image->isLoaded());
+    EXPECT_EQ(rgba(frame * 10, 255 - frame, 0, 255), get_pixel(image, 127, 127));
+  }
+  EXPECT_EQ(rgba(1, 2, 3, 4), get_pixel(modified, 0, 0));
+  EXPECT_FALSE(doc->lazyCels()->hasErrors());
+
+  // Cels cannot be loaded again if the file is deleted
+  doc->lazyCels()->unloadImages();
+  base::delete_file("test_lazy.aseprite");
+  get_pixel(layer->cel(0)->image(), 127, 127);
+  EXPECT_TRUE(doc->lazyCels()->hasErrors());
+}
+
+TEST(File, LazyCelsWithErrors)
+{
+  app::Context ctx;
+
+  {
+    std::unique_ptr<Doc> doc(ctx.documents().add(128, 128, doc::ColorMode::RGB, 256));
+    clear_image(doc->sprite()->root()->firstLayer()->cel(0)->image(), rgba(255, 0, 0, 255));
+    doc->setFilename("test_lazy_errors.aseprite");
+    save_document(&ctx, doc.get());
+    doc->close();
+  }
+
+  // Corrupt the compressed pixels of the cel (the last zlib stream
+  // of the file)
+  {
+    std::fstream f("test_lazy_errors.aseprite",
+                   std::fstream::in | std::fstream::out | std::fstream::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    std::size_t zlibPos = 0;
+    for (std::size_t i = 0; i + 1 < data.size(); ++i) {
+      const uint8_t a = data[i], b = data[i + 1];
+      if (a == 0x78 && (b == 0x9c || b == 0xda))
+        zlibPos = i;
+    }
+    ASSERT_NE(std::size_t(0), zlibPos);
+    f.seekp(zlibPos + 2);
+    f.write("\xff\xff\xff\xff", 4);
+  }
+
+  FileOpConfig config;
+  config.lazyCels = true;
+  std::unique_ptr<FileOp> fop(FileOp::createLoadDocumentOperation(&ctx,
+                                                                  "test_lazy_errors.aseprite",
+                                                                  FILE_LOAD_SEQUENCE_NONE,
+                                                                  &config));
+  ASSERT_TRUE(fop != nullptr);
+  fop->operate();
+  fop->done();
+
+  std::unique_ptr<Doc> doc(fop->releaseDocument());
+  ASSERT_TRUE(doc != nullptr);
+  ASSERT_TRUE(doc->lazyCels() != nullptr);
+  EXPECT_FALSE(doc->lazyCels()->hasErrors());
+
+  // Decoding the cel fails, so the document cannot be saved anymore
+  get_pixel(doc->sprite()->root()->firstLayer()->cel(0)->image(), 0, 0);
+  EXPECT_TRUE(doc->lazyCels()->hasErrors());
+  EXPECT_EQ(-1, save_document(&ctx, doc.get()));
+  doc->close();
+}
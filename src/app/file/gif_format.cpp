@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2025  Igara Studio S.A.
+// Copyright (C) 2018-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -25,6 +25,7 @@
 #include "base/fs.h"
 #include "doc/doc.h"
 #include "doc/octree_map.h"
+#include "doc/task_scheduler.h"
 #include "gfx/clip.h"
 #include "render/dithering.h"
 #include "render/ordered_dither.h"
@@ -35,6 +36,12 @@
 #include "gif_options.xml.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include <gif_lib.h>
 
@@ -930,6 +937,36 @@ class GifEncoder {
 public:
   typedef int gifframe_t;
 
+  // Maximum memory used by rendered frames waiting to be compared
+  // with the previous ones (and by delta images waiting to be
+  // quantized/written) in the pipelined encoder.
+  static constexpr std::size_t kMaxPipelineMemSize = 256 * 1024 * 1024;
+
+  // Indexed image and palette to write a frame in the file (the
+  // result of quantizing its delta image).
+  struct QuantizedFrame {
+    ImageRef image;
+    Remap remap{ 256 };
+    // Local palette of the frame, or nullptr if we use the global
+    // colormap.
+    std::unique_ptr<Palette> palette;
+    int transparentIndex = -1;
+  };
+
+  // State of each frame in the pipelined encoder. Frames are rendered
+  // and quantized in TaskScheduler tasks, while the delta image of each
+  // frame (which depends on the previous frames) is calculated and
+  // frames are written in order in the encoder thread.
+  struct PipelineFrame {
+    frame_t frame = 0;
+    ImageRef rendered;
+    gfx::Rect bounds;
+    DisposalMethod disposal = DisposalMethod::NONE;
+    bool fixDuration = false;
+    std::unique_ptr<Image> deltaImage;
+    std::unique_ptr<QuantizedFrame> quantized;
+  };
+
   GifEncoder(FileOp* fop, GifFileType* gifFile)
     : m_fop(fop)
     , m_gifFile(gifFile)
@@ -1067,6 +1104,8 @@ public:
 
   ~GifEncoder()
   {
+    stopPipeline();
+
     if (m_globalColormap)
       GifFreeMapObject(m_globalColormap);
   }
@@ -1092,6 +1131,8 @@ public:
   #endif
     auto frame_it = frame_beg;
 
+    startPipeline(nframes);
+
     // In this code "gifFrame" will be the GIF frame, and "frame" will
     // be the doc::Sprite frame.
     for (gifframe_t gifFrame = 0; gifFrame < nframes; ++gifFrame) {
@@ -1103,14 +1144,14 @@ public:
       ++frame_it;
 
       if (gifFrame == 0)
-        renderFrame(frame, m_nextImage);
+        getRenderedFrame(gifFrame, frame, m_nextImage);
       else
         std::swap(m_previousImage, m_currentImage);
 
       // Render next frame
       std::swap(m_currentImage, m_nextImage);
       if (gifFrame + 1 < nframes)
-        renderFrame(*frame_it, m_nextImage);
+        getRenderedFrame(gifFrame + 1, *frame_it, m_nextImage);
 
       gfx::Rect frameBounds = m_spriteBounds;
       DisposalMethod disposal = DisposalMethod::DO_NOT_DISPOSE;
@@ -1124,14 +1165,30 @@ public:
 
       calculateDeltaImageFrameBoundsDisposal(gifFrame, frameBounds, disposal);
 
-      writeImage(gifFrame,
-                 frame,
-                 frameBounds,
-                 disposal,
-                 // Only the last frame in the animation needs the fix
-                 (fix_last_frame_duration && gifFrame == nframes - 1));
+      // Only the last frame in the animation needs the fix
+      const bool fixDuration = (fix_last_frame_duration && gifFrame == nframes - 1);
+
+      if (m_pipelined) {
+        addQuantizeTask(gifFrame, frameBounds, disposal, fixDuration);
 
-      m_fop->setProgress(double(gifFrame + 1) / double(nframes));
+        // Write the frames that are already quantized, waiting for
+        // the oldest ones if there are too many frames in the queue.
+        writeQuantizedFrames(gifFrame + 1 - m_maxPending);
+      }
+      else {
+        const QuantizedFrame quantized = quantizeFrame(m_deltaImage.get(),
+                                                       frameBounds,
+                                                       m_frameImageBuf);
+        writeImage(gifFrame, frame, frameBounds, disposal, fixDuration, quantized);
+
+        m_fop->setProgress(double(gifFrame + 1) / double(nframes));
+      }
+    }
+
+    if (m_pipelined) {
+      if (!m_fop->isStop())
+        writeQuantizedFrames(nframes);
+      stopPipeline();
     }
     return true;
   }
@@ -1365,34 +1422,36 @@ private:
     return frameBounds;
   }
 
-  void writeImage(const gifframe_t gifFrame,
-                  const frame_t frame,
-                  const gfx::Rect& frameBounds,
-                  const DisposalMethod disposal,
-                  const bool fixDuration)
+  // Converts the delta image of a frame to the indexed image to write
+  // in the file. It doesn't modify the encoder state, so it can be
+  // called from worker threads.
+  QuantizedFrame quantizeFrame(const Image* deltaImage,
+                               const gfx::Rect& frameBounds,
+                               const ImageBufferPtr& frameImageBuf) const
   {
+    QuantizedFrame quantized;
+    int transparentIndex = m_transparentIndex;
+
     Palette framePalette;
     if (m_globalColormap)
       framePalette = m_globalColormapPalette;
     else
-      framePalette = calculatePalette();
+      framePalette = calculatePalette(deltaImage, transparentIndex);
 
     OctreeMap octree;
-    octree.regenerateMap(&framePalette, m_transparentIndex);
-    ImageRef frameImage(
-      Image::create(IMAGE_INDEXED, frameBounds.w, frameBounds.h, m_frameImageBuf));
+    octree.regenerateMap(&framePalette, transparentIndex);
+    ImageRef frameImage(Image::create(IMAGE_INDEXED, frameBounds.w, frameBounds.h, frameImageBuf));
 
     // Every frame might use a small portion of the global palette,
     // to optimize the gif file size, we will analize which colors
     // will be used in each processed frame.
     PalettePicks usedColors(framePalette.size());
 
-    int localTransparent = m_transparentIndex;
-    ColorMapObject* colormap = m_globalColormap;
-    Remap remap(256);
+    int localTransparent = transparentIndex;
+    Remap& remap = quantized.remap;
 
     if (!m_preservePaletteOrder) {
-      const LockImageBits<RgbTraits> srcBits(m_deltaImage.get());
+      const LockImageBits<RgbTraits> srcBits(deltaImage);
       LockImageBits<IndexedTraits> dstBits(frameImage.get());
 
       auto srcIt = srcBits.begin();
@@ -1411,13 +1470,13 @@ private:
                                             rgba_getg(color),
                                             rgba_getb(color),
                                             255,
-                                            m_transparentIndex);
+                                            transparentIndex);
             if (i < 0)
               i = octree.mapColor(color | rgba_a_mask); // alpha=255
           }
           else {
-            if (m_transparentIndex >= 0)
-              i = m_transparentIndex;
+            if (transparentIndex >= 0)
+              i = transparentIndex;
             else
               i = m_bgIndex;
           }
@@ -1440,34 +1499,54 @@ private:
       for (int i = 0; i < remap.size(); ++i)
         remap.map(i, i);
 
-      if (!colormap) {
-        Palette reducedPalette(0, usedNColors);
+      if (!m_globalColormap) {
+        quantized.palette = std::make_unique<Palette>(frame_t(0), usedNColors);
 
         for (int i = 0, j = 0; i < framePalette.size(); ++i) {
           if (usedColors[i]) {
-            reducedPalette.setEntry(j, framePalette.getEntry(i));
+            quantized.palette->setEntry(j, framePalette.getEntry(i));
             remap.map(i, j);
             ++j;
           }
         }
 
-        colormap = createColorMap(&reducedPalette);
         if (localTransparent >= 0)
           localTransparent = remap[localTransparent];
       }
 
-      if (localTransparent >= 0 && m_transparentIndex != localTransparent)
-        remap.map(m_transparentIndex, localTransparent);
+      if (localTransparent >= 0 && transparentIndex != localTransparent)
+        remap.map(transparentIndex, localTransparent);
     }
     else {
-      frameImage.reset(Image::createCopy(m_deltaImage.get()));
-      for (int i = 0; i < colormap->ColorCount; ++i)
+      frameImage.reset(Image::createCopy(deltaImage));
+      for (int i = 0; i < m_globalColormap->ColorCount; ++i)
         remap.map(i, i);
     }
 
-    // Write extension record.
-    writeExtension(gifFrame, frame, localTransparent, disposal, fixDuration);
+    quantized.image = frameImage;
+    quantized.transparentIndex = localTransparent;
+    return quantized;
+  }
 
+  void writeImage(const gifframe_t gifFrame,
+                  const frame_t frame,
+                  const gfx::Rect& frameBounds,
+                  const DisposalMethod disposal,
+                  const bool fixDuration,
+                  const QuantizedFrame& quantized)
+  {
+    const Image* frameImage = quantized.image.get();
+    const Remap& remap = quantized.remap;
+
+    // The local colormap is created here (and not in
+    // quantizeFrame()) because the color space conversion is not
+    // thread-safe.
+    ColorMapObject* colormap = m_globalColormap;
+    if (quantized.palette)
+      colormap = createColorMap(quantized.palette.get());
+
+    // Write extension record.
+    writeExtension(gifFrame, frame, quantized.transparentIndex, disposal, fixDuration);
     // Write the image record.
     if (EGifPutImageDesc(m_gifFile,
                          frameBounds.x,
@@ -1513,26 +1592,38 @@ private:
       GifFreeMapObject(colormap);
   }
 
-  Palette calculatePalette()
+  static Palette calculatePalette(const Image* deltaImage, int& transparentIndex)
   {
     OctreeMap octree;
-    const LockImageBits<RgbTraits> imageBits(m_deltaImage.get());
+    const LockImageBits<RgbTraits> imageBits(deltaImage);
     auto it = imageBits.begin(), end = imageBits.end();
     bool maskColorFounded = false;
+    // Consecutive pixels with the same color are added at once
+    color_t runColor = 0;
+    std::size_t runCount = 0;
     for (; it != end; ++it) {
       color_t c = *it;
       if (rgba_geta(c) == 0) {
         maskColorFounded = true;
         continue;
       }
-      octree.addColor(c);
+      if (runCount > 0 && c == runColor) {
+        ++runCount;
+        continue;
+      }
+      if (runCount > 0)
+        octree.addColor(runColor, 7, runCount);
+      runColor = c;
+      runCount = 1;
     }
+    if (runCount > 0)
+      octree.addColor(runColor, 7, runCount);
     Palette palette;
     if (maskColorFounded) {
       // If there is a mask color, the OctreeMap::makePalette adds it
       // by default at entry == 0.
       octree.makePalette(&palette, 256, 8);
-      m_transparentIndex = 0;
+      transparentIndex = 0;
       return palette;
     }
     else {
@@ -1542,7 +1633,7 @@ private:
       Palette paletteWithoutMask(0, palette.size() - 1);
       for (int i = 0; i < paletteWithoutMask.size(); i++)
         paletteWithoutMask.setEntry(i, palette.entry(i + 1));
-      m_transparentIndex = -1;
+      transparentIndex = -1;
       return paletteWithoutMask;
     }
   }
@@ -1556,6 +1647,152 @@ private:
     m_img->renderFrame(frame, m_fop->roi().frameBounds(frame), dst);
   }
 
+  // Gets the rendered image of the given frame in "dst". In the
+  // pipelined encoder the frame was already rendered in a worker
+  // thread, and we copy it to "dst" to get exactly the same result
+  // of the sequential encoder (as "dst" is one of the
+  // previous/current/next images that are modified/compared).
+  void getRenderedFrame(const gifframe_t gifFrame, const frame_t frame, Image* dst)
+  {
+    if (!m_pipelined) {
+      renderFrame(frame, dst);
+      return;
+    }
+
+    // Render the next frames in advance
+    const gifframe_t nframes = gifframe_t(m_pipelineFrames.size());
+    while (m_nextRender < nframes && m_nextRender <= gifFrame + m_maxPending) {
+      const gifframe_t i = m_nextRender++;
+      addTask([this, i] {
+        PipelineFrame& f = m_pipelineFrames[i];
+        ImageRef image(
+          Image::create(m_images[0]->pixelFormat(), m_spriteBounds.w, m_spriteBounds.h));
+        renderFrame(f.frame, image.get());
+
+        const std::lock_guard lock(m_mutex);
+        f.rendered = image;
+      });
+    }
+
+    ImageRef image;
+    {
+      std::unique_lock lock(m_mutex);
+      PipelineFrame& f = m_pipelineFrames[gifFrame];
+      m_cond.wait(lock, [this, &f] { return f.rendered || m_error; });
+      if (m_error)
+        std::rethrow_exception(m_error);
+      image = std::move(f.rendered);
+    }
+    copy_image(dst, image.get());
+  }
+
+  void addQuantizeTask(const gifframe_t gifFrame,
+                       const gfx::Rect& frameBounds,
+                       const DisposalMethod disposal,
+                       const bool fixDuration)
+  {
+    ASSERT(gifFrame == m_nextQuantize);
+    PipelineFrame& f = m_pipelineFrames[gifFrame];
+    f.bounds = frameBounds;
+    f.disposal = disposal;
+    f.fixDuration = fixDuration;
+    f.deltaImage = std::move(m_deltaImage);
+    ++m_nextQuantize;
+
+    addTask([this, gifFrame] {
+      PipelineFrame& f = m_pipelineFrames[gifFrame];
+      auto quantized = std::make_unique<QuantizedFrame>(
+        quantizeFrame(f.deltaImage.get(), f.bounds, nullptr));
+
+      const std::lock_guard lock(m_mutex);
+      f.deltaImage.reset();
+      f.quantized = std::move(quantized);
+    });
+  }
+
+  // Writes the quantized frames in order. Waits for the frames before
+  // "waitUntil", and the next ones are written only if they are
+  // already quantized.
+  void writeQuantizedFrames(const gifframe_t waitUntil)
+  {
+    const gifframe_t nframes = gifframe_t(m_pipelineFrames.size());
+    while (m_nextWrite < m_nextQuantize) {
+      PipelineFrame& f = m_pipelineFrames[m_nextWrite];
+      std::unique_ptr<QuantizedFrame> quantized;
+      {
+        std::unique_lock lock(m_mutex);
+        if (m_nextWrite < waitUntil)
+          m_cond.wait(lock, [this, &f] { return f.quantized || m_error; });
+        if (m_error)
+          std::rethrow_exception(m_error);
+        if (!f.quantized)
+          break;
+        quantized = std::move(f.quantized);
+      }
+
+      writeImage(m_nextWrite, f.frame, f.bounds, f.disposal, f.fixDuration, *quantized);
+      ++m_nextWrite;
+
+      m_fop->setProgress(double(m_nextWrite) / double(nframes));
+    }
+  }
+
+  // Prepares the pipelined encoder (if it's possible to use it to
+  // encode this animation).
+  void startPipeline(const gifframe_t nframes)
+  {
+    const auto& scheduler = doc::TaskScheduler::instance();
+    if (nframes < 2 || scheduler.workersCount() < 1 || !m_img->canRenderFramesInParallel())
+      return;
+
+    const std::size_t frameMemSize = std::max<std::size_t>(1, m_images[0]->getMemSize());
+    m_maxPending = int(std::clamp<std::size_t>(kMaxPipelineMemSize / frameMemSize,
+                                               1,
+                                               2 * scheduler.concurrency()));
+    m_pipelined = true;
+
+    m_pipelineFrames.resize(nframes);
+    gifframe_t gifFrame = 0;
+    for (const frame_t frame : m_fop->roi().framesSequence()) {
+      if (gifFrame == nframes)
+        break;
+      m_pipelineFrames[gifFrame++].frame = frame;
+    }
+  }
+
+  // Cancels the tasks that didn't start yet and waits the running
+  // ones (they access the members of this encoder).
+  void stopPipeline()
+  {
+    for (auto& task : m_tasks)
+      task->cancel();
+    for (auto& task : m_tasks)
+      task->wait();
+    m_tasks.clear();
+  }
+
+  // Renders/quantizes a frame of the pipelined encoder in a
+  // TaskScheduler worker.
+  void addTask(std::function<void()>&& func)
+  {
+    m_tasks.push_back(doc::TaskScheduler::instance().run(
+      [this, func = std::move(func)](doc::TaskScheduler::Token&) {
+        std::exception_ptr error;
+        try {
+          func();
+        }
+        catch (...) {
+          error = std::current_exception();
+        }
+
+        // The encoder thread re-throws the first error
+        const std::lock_guard lock(m_mutex);
+        if (error && !m_error)
+          m_error = error;
+        m_cond.notify_all();
+      }));
+  }
+
 private:
   ColorMapObject* createColorMap(const Palette* palette)
   {
@@ -1607,6 +1844,18 @@ private:
   Image* m_currentImage;
   Image* m_nextImage;
   std::unique_ptr<Image> m_deltaImage;
+
+  // Pipelined encoder
+  bool m_pipelined = false;
+  int m_maxPending = 1;
+  std::vector<PipelineFrame> m_pipelineFrames;
+  gifframe_t m_nextRender = 0;
+  gifframe_t m_nextQuantize = 0;
+  gifframe_t m_nextWrite = 0;
+  std::vector<doc::TaskScheduler::TokenRef> m_tasks;
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  std::exception_ptr m_error;
 };
 
 bool GifFormat::onSave(FileOp* fop)
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2022  Igara Studio S.A.
+// Copyright (C) 2018-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -42,7 +42,7 @@ class PngFormat : public FileFormat {
   {
     return FILE_SUPPORT_LOAD | FILE_SUPPORT_SAVE | FILE_SUPPORT_RGB | FILE_SUPPORT_RGBA |
            FILE_SUPPORT_GRAY | FILE_SUPPORT_GRAYA | FILE_SUPPORT_INDEXED | FILE_SUPPORT_SEQUENCES |
-           FILE_SUPPORT_PALETTE_WITH_ALPHA | FILE_ENCODE_ABSTRACT_IMAGE;
+           FILE_SUPPORT_PALETTE_WITH_ALPHA | FILE_ENCODE_ABSTRACT_IMAGE | FILE_ENCODE_THREAD_SAFE;
   }
 
   bool onLoad(FileOp* fop) override;
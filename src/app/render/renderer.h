@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2022-2023  Igara Studio S.A.
+// Copyright (C) 2022-2026  Igara Studio S.A.
 //
 // This program is distributed under the terms of
 // the End-User License Agreement for Aseprite.
@@ -62,6 +62,7 @@ public:
   virtual void setNonactiveLayersOpacity(const int opacity) = 0;
   virtual void setNewBlendMethod(const bool newBlend) = 0;
   virtual void setComposeGroups(bool composeGroups) = 0;
+  virtual void setMipmaps(bool enabled) = 0;
   virtual void setBgOptions(const render::BgOptions& bg) = 0;
   virtual void setProjection(const render::Projection& projection) = 0;
 
@@ -76,6 +77,7 @@ public:
                                const gfx::Point& pos,
                                const doc::BlendMode blendMode) = 0;
   virtual void removePreviewImage() = 0;
+  virtual void setPreviewLayersCache(const gfx::Rect& bounds) = 0;
   virtual void setExtraImage(render::ExtraType type,
                              const doc::Cel* cel,
                              const doc::Image* image,
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2022-2024  Igara Studio S.A.
+// Copyright (C) 2022-2026  Igara Studio S.A.
 //
 // This program is distributed under the terms of
 // the End-User License Agreement for Aseprite.
@@ -116,6 +116,11 @@ void ShaderRenderer::setComposeGroups(const bool composeGroups)
   // TODO impl
 }
 
+void ShaderRenderer::setMipmaps(const bool enabled)
+{
+  // Not needed, Skia samples the images directly
+}
+
 void ShaderRenderer::setBgOptions(const render::BgOptions& bg)
 {
   m_bgOptions = bg;
@@ -152,6 +157,11 @@ void ShaderRenderer::removePreviewImage()
   m_previewTileset = nullptr;
 }
 
+void ShaderRenderer::setPreviewLayersCache(const gfx::Rect& bounds)
+{
+  // Not needed, layers are composited in the GPU
+}
+
 void ShaderRenderer::setExtraImage(render::ExtraType type,
                                    const doc::Cel* cel,
                                    const doc::Image* image,
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2022-2023  Igara Studio S.A.
+// Copyright (C) 2022-2026  Igara Studio S.A.
 //
 // This program is distributed under the terms of
 // the End-User License Agreement for Aseprite.
@@ -40,6 +40,7 @@ public:
   void setNonactiveLayersOpacity(const int opacity) override;
   void setNewBlendMethod(const bool newBlend) override;
   void setComposeGroups(const bool composeGroups) override;
+  void setMipmaps(const bool enabled) override;
   void setBgOptions(const render::BgOptions& bg) override;
   void setProjection(const render::Projection& projection) override;
 
@@ -51,6 +52,7 @@ public:
                        const gfx::Point& pos,
                        const doc::BlendMode blendMode) override;
   void removePreviewImage() override;
+  void setPreviewLayersCache(const gfx::Rect& bounds) override;
   void setExtraImage(render::ExtraType type,
                      const doc::Cel* cel,
                      const doc::Image* image,
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2022-2023  Igara Studio S.A.
+// Copyright (C) 2022-2026  Igara Studio S.A.
 //
 // This program is distributed under the terms of
 // the End-User License Agreement for Aseprite.
@@ -42,6 +42,18 @@ void SimpleRenderer::setComposeGroups(const bool composeGroups)
   m_render.setComposeGroups(composeGroups);
 }
 
+void SimpleRenderer::setMipmaps(const bool enabled)
+{
+  if (enabled) {
+    if (!m_mipmaps)
+      m_mipmaps = std::make_shared<render::Mipmaps>();
+  }
+  else
+    m_mipmaps.reset();
+
+  m_render.setMipmaps(m_mipmaps);
+}
+
 void SimpleRenderer::setBgOptions(const render::BgOptions& bg)
 {
   m_render.setBgOptions(bg);
@@ -72,6 +84,11 @@ void SimpleRenderer::removePreviewImage()
   m_render.removePreviewImage();
 }
 
+void SimpleRenderer::setPreviewLayersCache(const gfx::Rect& bounds)
+{
+  m_render.setPreviewLayersCache(bounds);
+}
+
 void SimpleRenderer::setExtraImage(render::ExtraType type,
                                    const doc::Cel* cel,
                                    const doc::Image* image,
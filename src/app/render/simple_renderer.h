@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2022-2023  Igara Studio S.A.
+// Copyright (C) 2022-2026  Igara Studio S.A.
 //
 // This program is distributed under the terms of
 // the End-User License Agreement for Aseprite.
@@ -25,6 +25,7 @@ public:
   void setNonactiveLayersOpacity(const int opacity) override;
   void setNewBlendMethod(const bool newBlend) override;
   void setComposeGroups(bool composeGroups) override;
+  void setMipmaps(bool enabled) override;
   void setBgOptions(const render::BgOptions& bg) override;
   void setProjection(const render::Projection& projection) override;
 
@@ -36,6 +37,7 @@ public:
                        const gfx::Point& pos,
                        const doc::BlendMode blendMode) override;
   void removePreviewImage() override;
+  void setPreviewLayersCache(const gfx::Rect& bounds) override;
   void setExtraImage(render::ExtraType type,
                      const doc::Cel* cel,
                      const doc::Image* image,
@@ -64,6 +66,7 @@ public:
 private:
   Properties m_properties;
   render::Render m_render;
+  render::MipmapsPtr m_mipmaps;
 };
 
 } // namespace app
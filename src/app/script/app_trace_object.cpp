@@ -0,0 +1,90 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/script/luacpp.h"
+#include "app/script/security.h"
+#include "trace/trace.h"
+
+namespace app { namespace script {
+
+namespace {
+
+// Access to the tracing of hot paths (render, tool loop, save, etc.)
+// e.g. from the developer console:
+//   app.trace.start()
+//   ...
+//   app.trace.stop()
+//   app.trace.save("trace.json")
+struct AppTrace {};
+
+int AppTrace_start(lua_State* L)
+{
+  trace::start();
+  return 0;
+}
+
+int AppTrace_stop(lua_State* L)
+{
+  trace::stop();
+  return 0;
+}
+
+int AppTrace_save(lua_State* L)
+{
+  const char* filename = luaL_checkstring(L, 1);
+  if (!ask_access(L, filename, FileAccessMode::Write, ResourceType::File))
+    return luaL_error(L, "the script doesn't have access to write the file '%s'", filename);
+
+  lua_pushboolean(L, trace::save_chrome_json(filename));
+  return 1;
+}
+
+int AppTrace_get_isEnabled(lua_State* L)
+{
+  lua_pushboolean(L, trace::is_enabled());
+  return 1;
+}
+
+int AppTrace_get_zones(lua_State* L)
+{
+  lua_pushinteger(L, lua_Integer(trace::zones_count()));
+  return 1;
+}
+
+const Property AppTrace_properties[] = {
+  { "isEnabled", AppTrace_get_isEnabled, nullptr },
+  { "zones",     AppTrace_get_zones,     nullptr },
+  { nullptr,     nullptr,                nullptr }
+};
+
+const luaL_Reg AppTrace_methods[] = {
+  { "start", AppTrace_start },
+  { "stop",  AppTrace_stop  },
+  { "save",  AppTrace_save  },
+  { nullptr, nullptr        }
+};
+
+} // anonymous namespace
+
+DEF_MTNAME(AppTrace);
+
+void register_app_trace_object(lua_State* L)
+{
+  REG_CLASS(L, AppTrace);
+  REG_CLASS_PROPERTIES(L, AppTrace);
+
+  lua_getglobal(L, "app");
+  lua_pushstring(L, "trace");
+  push_new<AppTrace>(L);
+  lua_rawset(L, -3);
+  lua_pop(L, 1);
+}
+
+}} // namespace app::script
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -162,6 +162,7 @@ void register_app_object(lua_State* L);
 void register_app_pixel_color_object(lua_State* L);
 void register_app_fs_object(lua_State* L);
 void register_app_os_object(lua_State* L);
+void register_app_trace_object(lua_State* L);
 void register_app_command_object(lua_State* L);
 void register_app_preferences_object(lua_State* L);
 void register_json_object(lua_State* L);
@@ -179,6 +180,7 @@ void register_events_class(lua_State* L);
 void register_frame_class(lua_State* L);
 void register_frames_class(lua_State* L);
 void register_grid_class(lua_State* L);
+void register_image_bytes_class(lua_State* L);
 void register_image_class(lua_State* L);
 void register_image_iterator_class(lua_State* L);
 void register_image_spec_class(lua_State* L);
@@ -253,6 +255,7 @@ Engine::Engine() : L(luaL_newstate()), m_delegate(nullptr), m_printLastResult(fa
   register_app_pixel_color_object(L);
   register_app_fs_object(L);
   register_app_os_object(L);
+  register_app_trace_object(L);
   register_app_command_object(L);
   register_app_preferences_object(L);
   register_json_object(L);
@@ -495,6 +498,7 @@ Engine::Engine() : L(luaL_newstate()), m_delegate(nullptr), m_printLastResult(fa
   register_frame_class(L);
   register_frames_class(L);
   register_grid_class(L);
+  register_image_bytes_class(L);
   register_image_class(L);
   register_image_iterator_class(L);
   register_image_spec_class(L);
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2025  Igara Studio S.A.
+// Copyright (C) 2018-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -141,7 +141,7 @@ private:
 void push_app_events(lua_State* L);
 void push_app_theme(lua_State* L, int uiscale = 1);
 void push_app_clipboard(lua_State* L);
-int push_image_iterator_function(lua_State* L, const doc::Image* image, int extraArgIndex);
+int push_image_iterator_function(lua_State* L, doc::Image* image, int extraArgIndex);
 void push_brush(lua_State* L, const doc::BrushRef& brush);
 void push_cel_image(lua_State* L, doc::Cel* cel);
 void push_cel_images(lua_State* L, const doc::ObjectIds& cels);
@@ -153,6 +153,7 @@ void push_doc_range(lua_State* L, Site& site);
 void push_editor(lua_State* L, Editor* editor);
 void push_group_layers(lua_State* L, doc::Layer* group);
 void push_image(lua_State* L, doc::Image* image);
+void push_image_bytes(lua_State* L, doc::Image* image, doc::Tileset* tileset, doc::tile_index ti);
 void push_layers(lua_State* L, const doc::ObjectIds& layers);
 void push_palette(lua_State* L, doc::Palette* palette);
 void push_plugin(lua_State* L, Extension* ext);
@@ -0,0 +1,181 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/script/docobj.h"
+#include "app/script/engine.h"
+#include "app/script/luacpp.h"
+#include "doc/image.h"
+#include "doc/tileset.h"
+
+#include <cstring>
+
+namespace app { namespace script {
+
+namespace {
+
+// View of the pixels of an image as a sequence of bytes (in the same
+// order of the Image.bytes string). It doesn't copy the image
+// buffer, each access reads/writes the image directly.
+struct ImageBytesObj {
+  doc::ObjectId imageId = 0;
+  doc::ObjectId tilesetId = 0;
+  doc::tile_index ti = 0;
+
+  ImageBytesObj(doc::Image* image, doc::Tileset* tileset, doc::tile_index ti)
+    : imageId(image->id())
+    , tilesetId(tileset ? tileset->id() : 0)
+    , ti(ti)
+  {
+  }
+
+  doc::Image* image(lua_State* L) { return check_docobj(L, doc::get<doc::Image>(imageId)); }
+
+  uint8_t* bytes(lua_State* L, lua_Integer& size)
+  {
+    doc::Image* img = image(L);
+    size = lua_Integer(img->rowBytes()) * img->height();
+    return img->getPixelAddress(0, 0);
+  }
+
+  void modified(lua_State* L)
+  {
+    image(L)->incrementVersion();
+
+    // Rehash tileset
+    if (tilesetId) {
+      if (doc::Tileset* ts = check_docobj(L, doc::get<doc::Tileset>(tilesetId))) {
+        ts->incrementVersion();
+        ts->notifyTileContentChange(ti);
+      }
+    }
+  }
+};
+
+// Converts a 1-based index (negative values are relative to the end
+// like in string.sub()) into a 0-based index.
+lua_Integer byte_index(lua_Integer i, const lua_Integer size)
+{
+  if (i < 0)
+    i = size + i + 1;
+  return i - 1;
+}
+
+int ImageBytes_len(lua_State* L)
+{
+  lua_Integer size;
+  get_obj<ImageBytesObj>(L, 1)->bytes(L, size);
+  lua_pushinteger(L, size);
+  return 1;
+}
+
+int ImageBytes_index(lua_State* L)
+{
+  auto obj = get_obj<ImageBytesObj>(L, 1);
+  if (lua_isinteger(L, 2)) {
+    lua_Integer size;
+    const uint8_t* bytes = obj->bytes(L, size);
+    const lua_Integer i = lua_tointeger(L, 2) - 1;
+    if (i >= 0 && i < size)
+      lua_pushinteger(L, bytes[i]);
+    else
+      lua_pushnil(L);
+    return 1;
+  }
+  // Methods
+  else if (const char* field = lua_tostring(L, 2)) {
+    luaL_getmetatable(L, get_mtname<ImageBytesObj>());
+    lua_getfield(L, -1, field);
+    return 1;
+  }
+  return 0;
+}
+
+int ImageBytes_newindex(lua_State* L)
+{
+  auto obj = get_obj<ImageBytesObj>(L, 1);
+  lua_Integer size;
+  uint8_t* bytes = obj->bytes(L, size);
+  const lua_Integer i = luaL_checkinteger(L, 2) - 1;
+  if (i < 0 || i >= size)
+    return luaL_error(L, "index out of bounds: %d", int(i + 1));
+
+  bytes[i] = uint8_t(luaL_checkinteger(L, 3));
+  obj->modified(L);
+  return 0;
+}
+
+// Returns a string with a copy of the bytes in the range [i, j]
+// (same semantic of string.sub(), j=-1 by default).
+int ImageBytes_sub(lua_State* L)
+{
+  auto obj = get_obj<ImageBytesObj>(L, 1);
+  lua_Integer size;
+  const uint8_t* bytes = obj->bytes(L, size);
+  lua_Integer i = byte_index(luaL_optinteger(L, 2, 1), size);
+  lua_Integer j = byte_index(luaL_optinteger(L, 3, -1), size);
+  if (i < 0)
+    i = 0;
+  if (j >= size)
+    j = size - 1;
+
+  if (i <= j)
+    lua_pushlstring(L, (const char*)bytes + i, size_t(j - i + 1));
+  else
+    lua_pushliteral(L, "");
+  return 1;
+}
+
+// Copies the given string of bytes starting at the index i.
+int ImageBytes_set(lua_State* L)
+{
+  auto obj = get_obj<ImageBytesObj>(L, 1);
+  lua_Integer size;
+  uint8_t* bytes = obj->bytes(L, size);
+  const lua_Integer i = byte_index(luaL_checkinteger(L, 2), size);
+  size_t len;
+  const char* str = luaL_checklstring(L, 3, &len);
+  if (i < 0 || i + lua_Integer(len) > size) {
+    return luaL_error(L,
+                      "Data out of bounds: given %d bytes at %d, size %d.",
+                      int(len),
+                      int(i + 1),
+                      int(size));
+  }
+
+  std::memcpy(bytes + i, str, len);
+  obj->modified(L);
+  return 0;
+}
+
+const luaL_Reg ImageBytes_methods[] = {
+  { "__index",    ImageBytes_index    },
+  { "__newindex", ImageBytes_newindex },
+  { "__len",      ImageBytes_len      },
+  { "sub",        ImageBytes_sub      },
+  { "set",        ImageBytes_set      },
+  { nullptr,      nullptr             }
+};
+
+} // anonymous namespace
+
+DEF_MTNAME(ImageBytesObj);
+
+void register_image_bytes_class(lua_State* L)
+{
+  using ImageBytes = ImageBytesObj;
+  REG_CLASS(L, ImageBytes);
+}
+
+void push_image_bytes(lua_State* L, doc::Image* image, doc::Tileset* tileset, doc::tile_index ti)
+{
+  push_new<ImageBytesObj>(L, image, tileset, ti);
+}
+
+}} // namespace app::script
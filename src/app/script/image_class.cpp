@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2025  Igara Studio S.A.
+// Copyright (C) 2018-2026  Igara Studio S.A.
 // Copyright (C) 2015-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -38,6 +38,7 @@
 #include "doc/cel.h"
 #include "doc/image.h"
 #include "doc/image_ref.h"
+#include "doc/image_traits.h"
 #include "doc/primitives.h"
 #include "doc/sprite.h"
 #include "render/render.h"
@@ -110,6 +111,81 @@ void render_sprite(Image* dst, const Sprite* sprite, const frame_t frame, const
   render.renderSprite(dst, sprite, frame, gfx::Clip(x, y, 0, 0, sprite->width(), sprite->height()));
 }
 
+// Calls func(ImageTraits()) with the traits of the given pixel
+// format, so the function can access pixels with the right pixel_t.
+template<typename Func>
+void with_image_traits(const doc::PixelFormat pixelFormat, Func&& func)
+{
+  switch (pixelFormat) {
+    case IMAGE_RGB:       func(doc::RgbTraits()); break;
+    case IMAGE_GRAYSCALE: func(doc::GrayscaleTraits()); break;
+    case IMAGE_INDEXED:   func(doc::IndexedTraits()); break;
+    case IMAGE_TILEMAP:   func(doc::TilemapTraits()); break;
+    default:              break;
+  }
+}
+
+// Returns the area specified in the given argument (or the whole
+// image if the argument is not specified) clipped to the image
+// bounds.
+gfx::Rect get_image_area_from_arg(lua_State* L, const doc::Image* img, const int index)
+{
+  gfx::Rect bounds = img->bounds();
+  if (!lua_isnoneornil(L, index)) {
+    const gfx::Rect specificBounds = convert_args_into_rect(L, index);
+    if (!specificBounds.isEmpty())
+      bounds &= specificBounds;
+  }
+  return bounds;
+}
+
+// Increments the version of the image (so caches like mipmaps of
+// the image are regenerated) and rehashes the tileset if it's a tile.
+void image_modified(lua_State* L, ImageObj* obj)
+{
+  obj->image(L)->incrementVersion();
+
+  // Rehash tileset
+  if (obj->tilesetId) {
+    if (doc::Tileset* ts = obj->tileset(L)) {
+      ts->incrementVersion();
+      ts->notifyTileContentChange(obj->ti);
+    }
+  }
+}
+
+// Modifies the "bounds" area of the image calling
+// modify(area, origin), where "area" is the image to be modified and
+// "origin" is the position of the pixel area(0, 0) in the original
+// image. The function must return true if it has modified "area".
+//
+// A cel image is modified through a copy of the area and a
+// transaction (so the change can be undone), other images are
+// modified directly.
+template<typename Func>
+void modify_image_area(lua_State* L, ImageObj* obj, const gfx::Rect& bounds, Func&& modify)
+{
+  doc::Image* img = obj->image(L);
+
+  if (auto cel = obj->cel(L)) {
+    // Don't use the shared "buf" here, "modify" can call Lua code
+    // that modifies other images using the same buffer.
+    ImageRef tmp(doc::crop_image(img, bounds, 0));
+    if (!modify(tmp.get(), bounds.origin()))
+      return;
+
+    Tx tx(cel->sprite());
+    tx(new cmd::CopyRegion(img, tmp.get(), gfx::Region(tmp->bounds()), bounds.origin()));
+    tx.commit();
+  }
+  else {
+    if (!modify(img, gfx::Point(0, 0)))
+      return;
+
+    image_modified(L, obj);
+  }
+}
+
 int Image_clone(lua_State* L);
 
 int Image_new(lua_State* L)
@@ -255,8 +331,10 @@ int Image_clear(lua_State* L)
   }
   // If the destination image is not related to a sprite, we just draw
   // the source image without undo information.
-  else
+  else {
     doc::fill_rect(img, rc, color); // Clips the rectangle to the image bounds
+    image_modified(L, obj);
+  }
   return 0;
 }
 
@@ -272,14 +350,7 @@ int Image_drawPixel(lua_State* L)
   else
     color = convert_args_into_pixel_color(L, 4, img->pixelFormat());
   doc::put_pixel(img, x, y, color);
-
-  // Rehash tileset
-  if (obj->tilesetId) {
-    if (doc::Tileset* ts = obj->tileset(L)) {
-      ts->incrementVersion();
-      ts->notifyTileContentChange(obj->ti);
-    }
-  }
+  image_modified(L, obj);
   return 0;
 }
 
@@ -349,6 +420,7 @@ int Image_drawImage(lua_State* L)
                      get_current_palette(),
                      opacity,
                      blendMode);
+    image_modified(L, obj);
   }
   return 0;
 }
@@ -383,6 +455,7 @@ int Image_drawSprite(lua_State* L)
   // the source image without undo information.
   else {
     render_sprite(dst, sprite, frame, pos.x, pos.y);
+    image_modified(L, obj);
   }
   return 0;
 }
@@ -404,6 +477,208 @@ int Image_getPixel(lua_State* L)
   return 1;
 }
 
+// Returns a table with all the pixel values of the given area (row
+// by row), the whole image by default.
+int Image_getPixels(lua_State* L)
+{
+  const auto img = get_obj<ImageObj>(L, 1)->image(L);
+  const gfx::Rect bounds = get_image_area_from_arg(L, img, 2);
+
+  lua_createtable(L, bounds.w * bounds.h, 0);
+  with_image_traits(img->pixelFormat(), [L, img, &bounds](auto traits) {
+    using pixel_t = typename decltype(traits)::pixel_t;
+    lua_Integer i = 1;
+    for (int y = bounds.y; y < bounds.y2(); ++y) {
+      auto p = (const pixel_t*)img->getPixelAddress(bounds.x, y);
+      for (int x = 0; x < bounds.w; ++x, ++p) {
+        lua_pushinteger(L, *p);
+        lua_rawseti(L, -2, i++);
+      }
+    }
+  });
+  return 1;
+}
+
+// Image:setPixels([rectangle,] pixels) where "pixels" is a table
+// like the one returned by Image:getPixels().
+int Image_setPixels(lua_State* L)
+{
+  auto obj = get_obj<ImageObj>(L, 1);
+  const auto img = obj->image(L);
+  gfx::Rect bounds = img->bounds();
+  int pixelsIndex = 2;
+  if (!lua_isnone(L, 3)) {
+    bounds = get_image_area_from_arg(L, img, 2);
+    pixelsIndex = 3;
+  }
+  luaL_checktype(L, pixelsIndex, LUA_TTABLE);
+
+  const lua_Unsigned size = lua_rawlen(L, pixelsIndex);
+  const lua_Unsigned needed = lua_Unsigned(bounds.w) * bounds.h;
+  if (size != needed) {
+    return luaL_error(L,
+                      "Pixels table size does not match: given %d, needed %d.",
+                      int(size),
+                      int(needed));
+  }
+  if (bounds.isEmpty())
+    return 0;
+
+  modify_image_area(L, obj, bounds, [L, pixelsIndex, &bounds](Image* area, gfx::Point origin) {
+    with_image_traits(area->pixelFormat(), [&](auto traits) {
+      using pixel_t = typename decltype(traits)::pixel_t;
+      lua_Integer i = 1;
+      for (int y = bounds.y; y < bounds.y2(); ++y) {
+        auto p = (pixel_t*)area->getPixelAddress(bounds.x - origin.x, y - origin.y);
+        for (int x = 0; x < bounds.w; ++x, ++p) {
+          lua_rawgeti(L, pixelsIndex, i++);
+          *p = pixel_t(lua_tointeger(L, -1));
+          lua_pop(L, 1);
+        }
+      }
+    });
+    return true;
+  });
+  return 0;
+}
+
+// Image:mapPixels(function(value, x, y) ... end [, rectangle]) calls
+// the function for each pixel, and if it returns an integer, the
+// pixel is replaced with that value.
+int Image_mapPixels(lua_State* L)
+{
+  auto obj = get_obj<ImageObj>(L, 1);
+  luaL_checktype(L, 2, LUA_TFUNCTION);
+  const gfx::Rect bounds = get_image_area_from_arg(L, obj->image(L), 3);
+  if (bounds.isEmpty())
+    return 0;
+
+  modify_image_area(L, obj, bounds, [L, &bounds](Image* area, gfx::Point origin) {
+    bool modified = false;
+    with_image_traits(area->pixelFormat(), [&](auto traits) {
+      using pixel_t = typename decltype(traits)::pixel_t;
+      for (int y = bounds.y; y < bounds.y2(); ++y) {
+        auto p = (pixel_t*)area->getPixelAddress(bounds.x - origin.x, y - origin.y);
+        for (int x = bounds.x; x < bounds.x2(); ++x, ++p) {
+          lua_pushvalue(L, 2);
+          lua_pushinteger(L, *p);
+          lua_pushinteger(L, x);
+          lua_pushinteger(L, y);
+          lua_call(L, 3, 1);
+          if (lua_isinteger(L, -1)) {
+            const auto value = pixel_t(lua_tointeger(L, -1));
+            if (*p != value) {
+              *p = value;
+              modified = true;
+            }
+          }
+          lua_pop(L, 1);
+        }
+      }
+    });
+    return modified;
+  });
+  return 0;
+}
+
+// Image:forEachRow(function(row, y) ... end [, rectangle]) calls the
+// function for each row with a table of the row pixels. The same
+// table is reused for all rows, and if the function returns true,
+// the modified row is written back in the image.
+int Image_forEachRow(lua_State* L)
+{
+  auto obj = get_obj<ImageObj>(L, 1);
+  luaL_checktype(L, 2, LUA_TFUNCTION);
+  const gfx::Rect bounds = get_image_area_from_arg(L, obj->image(L), 3);
+  if (bounds.isEmpty())
+    return 0;
+
+  lua_createtable(L, bounds.w, 0);
+  const int rowIndex = lua_gettop(L);
+
+  modify_image_area(L, obj, bounds, [L, rowIndex, &bounds](Image* area, gfx::Point origin) {
+    bool modified = false;
+    with_image_traits(area->pixelFormat(), [&](auto traits) {
+      using pixel_t = typename decltype(traits)::pixel_t;
+      for (int y = bounds.y; y < bounds.y2(); ++y) {
+        auto row = (pixel_t*)area->getPixelAddress(bounds.x - origin.x, y - origin.y);
+        for (int x = 0; x < bounds.w; ++x) {
+          lua_pushinteger(L, row[x]);
+          lua_rawseti(L, rowIndex, x + 1);
+        }
+
+        lua_pushvalue(L, 2);
+        lua_pushvalue(L, rowIndex);
+        lua_pushinteger(L, y);
+        lua_call(L, 2, 1);
+        const bool writeRow = lua_toboolean(L, -1);
+        lua_pop(L, 1);
+
+        if (writeRow) {
+          for (int x = 0; x < bounds.w; ++x) {
+            lua_rawgeti(L, rowIndex, x + 1);
+            row[x] = pixel_t(lua_tointeger(L, -1));
+            lua_pop(L, 1);
+          }
+          modified = true;
+        }
+      }
+    });
+    return modified;
+  });
+  return 0;
+}
+
+// Returns a string with the bytes of the given area (rows without
+// padding), the whole image by default.
+int Image_getBytes(lua_State* L)
+{
+  const auto img = get_obj<ImageObj>(L, 1)->image(L);
+  const gfx::Rect bounds = get_image_area_from_arg(L, img, 2);
+  const size_t rowSize = size_t(img->bytesPerPixel()) * bounds.w;
+
+  luaL_Buffer b;
+  char* dst = luaL_buffinitsize(L, &b, rowSize * bounds.h);
+  for (int y = bounds.y; y < bounds.y2(); ++y, dst += rowSize)
+    std::memcpy(dst, img->getPixelAddress(bounds.x, y), rowSize);
+  luaL_pushresultsize(&b, rowSize * bounds.h);
+  return 1;
+}
+
+// Image:setBytes([rectangle,] bytes) where "bytes" is a string like
+// the one returned by Image:getBytes().
+int Image_setBytes(lua_State* L)
+{
+  auto obj = get_obj<ImageObj>(L, 1);
+  const auto img = obj->image(L);
+  gfx::Rect bounds = img->bounds();
+  int bytesIndex = 2;
+  if (!lua_isnone(L, 3)) {
+    bounds = get_image_area_from_arg(L, img, 2);
+    bytesIndex = 3;
+  }
+
+  size_t bytesSize;
+  const char* bytes = luaL_checklstring(L, bytesIndex, &bytesSize);
+  const size_t rowSize = size_t(img->bytesPerPixel()) * bounds.w;
+  if (bytesSize != rowSize * bounds.h) {
+    return luaL_error(L,
+                      "Data size does not match: given %d, needed %d.",
+                      int(bytesSize),
+                      int(rowSize * bounds.h));
+  }
+  if (bounds.isEmpty())
+    return 0;
+
+  modify_image_area(L, obj, bounds, [bytes, rowSize, &bounds](Image* area, gfx::Point origin) {
+    const char* src = bytes;
+    for (int y = bounds.y; y < bounds.y2(); ++y, src += rowSize)
+      std::memcpy(area->getPixelAddress(bounds.x - origin.x, y - origin.y), src, rowSize);
+    return true;
+  });
+  return 0;
+}
+
 int Image_isEqual(lua_State* L)
 {
   auto objA = get_obj<ImageObj>(L, 1);
@@ -640,6 +915,7 @@ int Image_flip(lua_State* L)
   }
   else {
     doc::algorithm::flip_image(img, img->bounds(), flipType);
+    image_modified(L, obj);
   }
   return 0;
 }
@@ -681,12 +957,14 @@ int Image_get_bytes(lua_State* L)
 
 int Image_set_bytes(lua_State* L)
 {
-  const auto img = get_obj<ImageObj>(L, 1)->image(L);
+  auto obj = get_obj<ImageObj>(L, 1);
+  const auto img = obj->image(L);
   size_t bytes_size, bytes_needed = img->rowBytes() * img->height();
   const char* bytes = lua_tolstring(L, 2, &bytes_size);
 
   if (bytes_size == bytes_needed) {
     std::memcpy(img->getPixelAddress(0, 0), bytes, bytes_size);
+    image_modified(L, obj);
   }
   else {
     lua_pushfstring(L, "Data size does not match: given %d, needed %d.", bytes_size, bytes_needed);
@@ -696,6 +974,20 @@ int Image_set_bytes(lua_State* L)
   return 0;
 }
 
+// Returns a view of the image bytes which doesn't copy the whole
+// image buffer like Image.bytes does.
+int Image_get_bytesView(lua_State* L)
+{
+  auto obj = get_obj<ImageObj>(L, 1);
+  push_image_bytes(L, obj->image(L), obj->tileset(L), obj->ti);
+
+  // Keep a reference to the Image object so a standalone image is
+  // not deleted while the view is alive.
+  lua_pushvalue(L, 1);
+  lua_setiuservalue(L, -2, 1);
+  return 1;
+}
+
 int Image_get_width(lua_State* L)
 {
   const auto obj = get_obj<ImageObj>(L, 1);
@@ -760,6 +1052,12 @@ const luaL_Reg Image_methods[] = {
   { "clone",        Image_clone        },
   { "clear",        Image_clear        },
   { "getPixel",     Image_getPixel     },
+  { "getPixels",    Image_getPixels    },
+  { "setPixels",    Image_setPixels    },
+  { "mapPixels",    Image_mapPixels    },
+  { "forEachRow",   Image_forEachRow   },
+  { "getBytes",     Image_getBytes     },
+  { "setBytes",     Image_setBytes     },
   { "drawPixel",    Image_drawPixel    },
   { "putPixel",     Image_drawPixel    },
   { "drawImage",    Image_drawImage    },
@@ -785,6 +1083,7 @@ const Property Image_properties[] = {
   { "rowStride",     Image_get_rowStride,     nullptr         },
   { "bytesPerPixel", Image_get_bytesPerPixel, nullptr         },
   { "bytes",         Image_get_bytes,         Image_set_bytes },
+  { "bytesView",     Image_get_bytesView,     nullptr         },
   { "width",         Image_get_width,         nullptr         },
   { "height",        Image_get_height,        nullptr         },
   { "bounds",        Image_get_bounds,        nullptr         },
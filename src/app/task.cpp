@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2022  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 //
 // This program is distributed under the terms of
 // the End-User License Agreement for Aseprite.
@@ -16,6 +16,11 @@
 
 namespace app {
 
+// Tasks of this pool are I/O-bound (sending crash reports, restoring
+// backups, listing fonts, loading thumbnails, etc.), they spend most
+// of the time blocked, so they don't use the doc::TaskScheduler
+// workers (which are reserved to CPU-bound work like rendering or
+// parallelFor() loops).
 static base::thread_pool tasks_pool(4);
 
 Task::Task() : m_token(nullptr)
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2020  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 //
 // This program is distributed under the terms of
 // the End-User License Agreement for Aseprite.
@@ -15,6 +15,8 @@
 
 namespace app {
 
+// Background task for I/O-bound work. CPU-bound work should use
+// doc::TaskScheduler instead.
 class Task {
 public:
   Task();
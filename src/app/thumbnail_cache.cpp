@@ -0,0 +1,229 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/thumbnail_cache.h"
+
+#include "base/fs.h"
+#include "base/fstream_path.h"
+#include "base/process.h"
+#include "base/serialization.h"
+#include "base/time.h"
+#include "doc/image.h"
+#include "doc/image_io.h"
+#include "doc/palette.h"
+#include "doc/palette_io.h"
+#include "fmt/format.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace app {
+
+using namespace base::serialization;
+using namespace base::serialization::little_endian;
+
+namespace {
+
+constexpr uint32_t kMagicNumber = 0x48544841; // "AHTH" (Aseprite thumbnail)
+constexpr uint16_t kFileVersion = 1;
+constexpr const char* kExtension = "thumb";
+
+// FNV-1a hash
+uint64_t hash_string(const std::string& str)
+{
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (const char chr : str) {
+    hash ^= uint8_t(chr);
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+// Key to identify the current version of the given file
+std::string file_key(const std::string& filename)
+{
+  const base::Time t = base::get_modification_time(filename);
+  return fmt::format("{}\n{}\n{:04}{:02}{:02}{:02}{:02}{:02}",
+                     filename,
+                     base::file_size(filename),
+                     t.year,
+                     t.month,
+                     t.day,
+                     t.hour,
+                     t.minute,
+                     t.second);
+}
+
+} // anonymous namespace
+
+ThumbnailCache::ThumbnailCache(const std::string& dir, const std::size_t maxSize)
+  : m_dir(dir)
+  , m_maxSize(maxSize)
+{
+}
+
+bool ThumbnailCache::load(const std::string& filename,
+                          doc::ImageRef& image,
+                          std::unique_ptr<doc::Palette>& palette)
+{
+  try {
+    const std::string key = file_key(filename);
+    const std::string fn = base::join_path(m_dir, entryFilename(key));
+    if (!base::is_file(fn))
+      return false;
+
+    std::ifstream s(FSTREAM_PATH(fn), std::ifstream::binary);
+    if (read32(s) != kMagicNumber || read16(s) != kFileVersion)
+      return false;
+
+    // Check the key to avoid hash collisions
+    std::string storedKey(read16(s), 0);
+    s.read(storedKey.data(), storedKey.size());
+    if (!s || storedKey != key)
+      return false;
+
+    std::unique_ptr<doc::Palette> pal(doc::read_palette(s));
+    doc::ImageRef img(doc::read_image(s, false));
+    if (!s || !pal || !img)
+      return false;
+
+    image = img;
+    palette = std::move(pal);
+    return true;
+  }
+  catch (const std::exception&) {
+    // Invalid or incomplete entries are just ignored
+    return false;
+  }
+}
+
+void ThumbnailCache::save(const std::string& filename,
+                          const doc::Image* image,
+                          const doc::Palette* palette)
+{
+  std::string tmp;
+  try {
+    const std::string key = file_key(filename);
+    const std::string fn = base::join_path(m_dir, entryFilename(key));
+
+    // Unique name for the temporary file so concurrent saves of the
+    // same entry (from this or other processes) don't collide.
+    tmp = fmt::format("{}.{}-{}.tmp", fn, base::get_current_process_id(), ++m_tmpCounter);
+
+    if (!base::is_directory(m_dir))
+      base::make_all_directories(m_dir);
+
+    {
+      std::ofstream s(FSTREAM_PATH(tmp), std::ofstream::binary);
+      write32(s, kMagicNumber);
+      write16(s, kFileVersion);
+      write16(s, uint16_t(key.size()));
+      s.write(key.data(), key.size());
+      doc::write_palette(s, palette);
+      doc::write_image(s, image);
+      if (!s)
+        throw std::runtime_error("Error writing thumbnail");
+    }
+
+    // Rename the complete file so other threads never read an
+    // incomplete entry.
+    const std::lock_guard lock(m_mutex);
+    calculateSize();
+    if (base::is_file(fn)) {
+      // Replacing an existing entry
+      m_size -= std::min(m_size, base::file_size(fn));
+      base::delete_file(fn);
+    }
+    base::move_file(tmp, fn);
+    m_size += base::file_size(fn);
+    if (m_size > m_maxSize)
+      shrinkToMaxSize();
+  }
+  catch (const std::exception&) {
+    // Ignore errors (e.g. read-only user folder), the thumbnail just
+    // will not be cached.
+    if (!tmp.empty() && base::is_file(tmp)) {
+      try {
+        base::delete_file(tmp);
+      }
+      catch (const std::exception&) {
+      }
+    }
+  }
+}
+
+std::size_t ThumbnailCache::size()
+{
+  const std::lock_guard lock(m_mutex);
+  calculateSize();
+  return m_size;
+}
+
+std::string ThumbnailCache::entryFilename(const std::string& key) const
+{
+  return fmt::format("{:016x}.{}", hash_string(key), kExtension);
+}
+
+void ThumbnailCache::calculateSize()
+{
+  if (m_sizeCalculated)
+    return;
+
+  m_size = 0;
+  if (base::is_directory(m_dir)) {
+    for (const auto& fn : base::list_files(m_dir, base::ItemType::Files)) {
+      if (base::get_file_extension(fn) == kExtension)
+        m_size += base::file_size(base::join_path(m_dir, fn));
+    }
+  }
+  m_sizeCalculated = true;
+}
+
+void ThumbnailCache::shrinkToMaxSize()
+{
+  struct Entry {
+    std::string fn;
+    base::Time time;
+    std::size_t size;
+  };
+  std::vector<Entry> entries;
+  for (const auto& item : base::list_files(m_dir, base::ItemType::Files)) {
+    if (base::get_file_extension(item) != kExtension)
+      continue;
+
+    const std::string fn = base::join_path(m_dir, item);
+    entries.push_back({ fn, base::get_modification_time(fn), base::file_size(fn) });
+  }
+  std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+    return a.time < b.time;
+  });
+
+  // Remove the oldest entries until we have 3/4 of the maximum size,
+  // so we don't need to list the directory again in the next save().
+  m_size = 0;
+  for (const Entry& entry : entries)
+    m_size += entry.size;
+  for (const Entry& entry : entries) {
+    if (m_size <= m_maxSize * 3 / 4)
+      break;
+    try {
+      base::delete_file(entry.fn);
+      m_size -= entry.size;
+    }
+    catch (const std::exception&) {
+      // The file is being used, we'll try to delete it later
+    }
+  }
+}
+
+} // namespace app
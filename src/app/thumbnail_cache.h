@@ -0,0 +1,68 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_THUMBNAIL_CACHE_H_INCLUDED
+#define APP_THUMBNAIL_CACHE_H_INCLUDED
+#pragma once
+
+#include "doc/image_ref.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace doc {
+class Palette;
+}
+
+namespace app {
+
+// Cache of file thumbnails stored on disk, so we don't need to
+// decode each file again every time its folder is browsed.
+//
+// Each thumbnail is stored in its own file named with a hash of the
+// path, size, and modification time of the original file. So if the
+// original file is modified, a new entry is created and the old one
+// is evicted (oldest entries first) when the cache exceeds its
+// maximum size.
+//
+// All functions can be called from any thread.
+class ThumbnailCache {
+public:
+  static constexpr std::size_t kDefaultMaxSize = 32 * 1024 * 1024;
+
+  explicit ThumbnailCache(const std::string& dir, std::size_t maxSize = kDefaultMaxSize);
+
+  // Returns true if the thumbnail of the given file is in the cache,
+  // in that case "image" and "palette" are the same ones given to
+  // save().
+  bool load(const std::string& filename,
+            doc::ImageRef& image,
+            std::unique_ptr<doc::Palette>& palette);
+
+  void save(const std::string& filename, const doc::Image* image, const doc::Palette* palette);
+
+  // Returns the size in bytes of all entries in the cache.
+  std::size_t size();
+
+private:
+  std::string entryFilename(const std::string& key) const;
+  void calculateSize();
+  void shrinkToMaxSize();
+
+  std::string m_dir;
+  std::size_t m_maxSize;
+  std::atomic<int> m_tmpCounter{ 0 };
+  std::mutex m_mutex;
+  std::size_t m_size = 0;
+  bool m_sizeCalculated = false;
+};
+
+} // namespace app
+
+#endif
@@ -0,0 +1,141 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#include "tests/app_test.h"
+
+#include "app/thumbnail_cache.h"
+#include "base/fs.h"
+#include "doc/image.h"
+#include "doc/palette.h"
+#include "doc/primitives.h"
+
+#include <fstream>
+#include <thread>
+#include <vector>
+
+using namespace app;
+using namespace doc;
+
+static const char* kCacheDir = "_thumbnail_cache";
+static const char* kSourceFile = "_thumbnail_source.txt";
+
+static void clear_cache_dir()
+{
+  if (base::is_directory(kCacheDir)) {
+    for (const auto& fn : base::list_files(kCacheDir))
+      base::delete_file(base::join_path(kCacheDir, fn));
+    base::remove_directory(kCacheDir);
+  }
+}
+
+static void write_source_file(const char* content)
+{
+  std::ofstream f(kSourceFile, std::ofstream::binary);
+  f << content;
+}
+
+TEST(ThumbnailCache, SaveAndLoad)
+{
+  clear_cache_dir();
+  write_source_file("abc");
+
+  ImageRef image(Image::create(IMAGE_INDEXED, 3, 2));
+  clear_image(image.get(), 2);
+  put_pixel(image.get(), 1, 1, 5);
+  Palette palette(frame_t(0), 8);
+  palette.setEntry(5, rgba(255, 0, 0, 255));
+
+  ThumbnailCache cache(kCacheDir);
+  ImageRef cachedImage;
+  std::unique_ptr<Palette> cachedPalette;
+  EXPECT_FALSE(cache.load(kSourceFile, cachedImage, cachedPalette));
+  EXPECT_EQ(std::size_t(0), cache.size());
+
+  cache.save(kSourceFile, image.get(), &palette);
+  const std::size_t size = cache.size();
+  EXPECT_LT(std::size_t(0), size);
+
+  // Overwriting the entry doesn't change the size of the cache
+  cache.save(kSourceFile, image.get(), &palette);
+  EXPECT_EQ(size, cache.size());
+  ASSERT_TRUE(cache.load(kSourceFile, cachedImage, cachedPalette));
+  ASSERT_TRUE(cachedImage);
+  ASSERT_TRUE(cachedPalette);
+  EXPECT_EQ(IMAGE_INDEXED, cachedImage->pixelFormat());
+  EXPECT_EQ(3, cachedImage->width());
+  EXPECT_EQ(2, cachedImage->height());
+  EXPECT_EQ(2, get_pixel(cachedImage.get(), 0, 0));
+  EXPECT_EQ(5, get_pixel(cachedImage.get(), 1, 1));
+  EXPECT_EQ(8, cachedPalette->size());
+  EXPECT_EQ(rgba(255, 0, 0, 255), cachedPalette->getEntry(5));
+
+  // A new cache instance uses the same files
+  ThumbnailCache cache2(kCacheDir);
+  EXPECT_TRUE(cache2.load(kSourceFile, cachedImage, cachedPalette));
+
+  // Modifying the file invalidates its thumbnail
+  write_source_file("abcdef");
+  EXPECT_FALSE(cache.load(kSourceFile, cachedImage, cachedPalette));
+
+  clear_cache_dir();
+  base::delete_file(kSourceFile);
+}
+
+TEST(ThumbnailCache, ConcurrentSaves)
+{
+  clear_cache_dir();
+  write_source_file("abc");
+
+  ImageRef image(Image::create(IMAGE_RGB, 8, 8));
+  clear_image(image.get(), rgba(255, 0, 0, 255));
+  Palette palette(frame_t(0), 2);
+
+  ThumbnailCache cache(kCacheDir);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 10; ++j)
+        cache.save(kSourceFile, image.get(), &palette);
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  // Only one entry (without temporary files) is left in the cache
+  EXPECT_EQ(1, int(base::list_files(kCacheDir).size()));
+  EXPECT_EQ(base::file_size(base::join_path(kCacheDir, base::list_files(kCacheDir)[0])),
+            cache.size());
+
+  ImageRef cachedImage;
+  std::unique_ptr<Palette> cachedPalette;
+  ASSERT_TRUE(cache.load(kSourceFile, cachedImage, cachedPalette));
+  EXPECT_EQ(rgba(255, 0, 0, 255), get_pixel(cachedImage.get(), 7, 7));
+
+  clear_cache_dir();
+  base::delete_file(kSourceFile);
+}
+
+TEST(ThumbnailCache, MaxSize)
+{
+  clear_cache_dir();
+  write_source_file("abc");
+
+  ImageRef image(Image::create(IMAGE_RGB, 4, 4));
+  clear_image(image.get(), rgba(0, 0, 255, 255));
+  Palette palette(frame_t(0), 2);
+
+  // The entry is bigger than the cache, so it's evicted
+  ThumbnailCache cache(kCacheDir, 1);
+  cache.save(kSourceFile, image.get(), &palette);
+  EXPECT_EQ(std::size_t(0), cache.size());
+
+  ImageRef cachedImage;
+  std::unique_ptr<Palette> cachedPalette;
+  EXPECT_FALSE(cache.load(kSourceFile, cachedImage, cachedPalette));
+
+  clear_cache_dir();
+  base::delete_file(kSourceFile);
+}
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2024  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -16,7 +16,11 @@
 #include "app/doc.h"
 #include "app/file/file.h"
 #include "app/file_system.h"
+#include "app/resource_finder.h"
+#include "app/task.h"
+#include "app/thumbnail_cache.h"
 #include "app/util/conversion_to_surface.h"
+#include "base/fs.h"
 #include "base/thread.h"
 #include "doc/algorithm/rotate.h"
 #include "doc/image.h"
@@ -31,21 +35,21 @@
 #include <algorithm>
 #include <atomic>
 #include <memory>
-#include <thread>
 
-#define MAX_THUMBNAIL_SIZE 128
+#define MAX_THUMBNAIL_SIZE    128
+#define MAX_THUMBNAIL_WORKERS 2
 #define THUMB_TRACE(...)
 
 namespace app {
 
 class ThumbnailGenerator::Worker {
 public:
-  Worker(base::concurrent_queue<ThumbnailGenerator::Item>& queue)
+  Worker(base::concurrent_queue<ThumbnailGenerator::Item>& queue, ThumbnailCache* cache)
     : m_queue(queue)
+    , m_cache(cache)
     , m_fop(nullptr)
-    , m_isDone(false)
-    , m_thread([this] { loadBgThread(); })
   {
+    m_task.run([this](base::task_token&) { loadBgThread(); });
   }
 
   ~Worker()
@@ -55,7 +59,7 @@ public:
       if (m_fop)
         m_fop->stop();
     }
-    m_thread.join();
+    m_task.wait();
   }
 
   void stop() const
@@ -65,7 +69,7 @@ public:
       m_fop->stop();
   }
 
-  bool isDone() const { return m_isDone; }
+  bool isDone() const { return m_task.completed(); }
 
   void updateProgress()
   {
@@ -88,10 +92,18 @@ private:
         ASSERT(m_fop);
       }
 
-      THUMB_TRACE("FOP loading thumbnail: %s\n", m_item.fileitem->fileName().c_str());
+      const std::string& filename = m_item.fileitem->fileName();
+      THUMB_TRACE("FOP loading thumbnail: %s\n", filename.c_str());
+
+      // Use the thumbnail from the disk cache if the file wasn't
+      // modified since the thumbnail was generated.
+      ImageRef thumbnailImage;
+      std::unique_ptr<Palette> palette;
+      const bool fromCache = (m_cache && m_cache->load(filename, thumbnailImage, palette));
 
       // Load the file
-      m_fop->operate(nullptr);
+      if (!fromCache)
+        m_fop->operate(nullptr);
 
       // Don't call post-load because postLoad() needs user interaction.
       // m_fop->postLoad();
@@ -100,9 +112,7 @@ private:
       const Sprite* sprite =
         (m_fop->document() && m_fop->document()->sprite() ? m_fop->document()->sprite() : nullptr);
 
-      std::unique_ptr<Image> thumbnailImage;
-      std::unique_ptr<Palette> palette;
-      if (!m_fop->isStop() && sprite) {
+      if (!fromCache && !m_fop->isStop() && sprite) {
         // The palette to convert the Image
         palette.reset(new Palette(*sprite->palette(frame_t(0))));
 
@@ -149,6 +159,9 @@ private:
       // Close file
       delete m_fop->releaseDocument();
 
+      if (!fromCache && thumbnailImage && m_cache && !m_fop->isStop())
+        m_cache->save(filename, thumbnailImage.get(), palette.get());
+
       // Set the thumbnail of the file-item.
       if (thumbnailImage) {
         os::SurfaceRef thumbnail = os::System::instance()->makeRgbaSurface(
@@ -206,8 +219,6 @@ private:
 
   void loadBgThread()
   {
-    base::this_thread::set_name("thumbnails");
-
     while (!m_queue.empty()) {
       bool success = true;
       while (success) {
@@ -220,15 +231,14 @@ private:
       }
       base::this_thread::yield();
     }
-    m_isDone = true;
   }
 
   base::concurrent_queue<Item>& m_queue;
+  ThumbnailCache* m_cache;
   app::ThumbnailGenerator::Item m_item;
   FileOp* m_fop;
   mutable std::mutex m_mutex;
-  std::atomic<bool> m_isDone;
-  std::thread m_thread;
+  Task m_task;
 };
 
 ThumbnailGenerator* ThumbnailGenerator::instance()
@@ -246,10 +256,17 @@ ThumbnailGenerator* ThumbnailGenerator::instance()
 
 ThumbnailGenerator::ThumbnailGenerator()
 {
-  int n = std::thread::hardware_concurrency() - 1;
-  if (n < 1)
-    n = 1;
-  m_maxWorkers = n;
+  // Workers are app::Task (I/O-bound) tasks, they are limited so
+  // there are free threads for other background tasks.
+  m_maxWorkers = MAX_THUMBNAIL_WORKERS;
+
+  ResourceFinder rf;
+  rf.includeUserDir(base::join_path("thumbnails", ".").c_str());
+  m_cache = std::make_unique<ThumbnailCache>(rf.getFirstOrCreateDefault());
+}
+
+ThumbnailGenerator::~ThumbnailGenerator()
+{
 }
 
 bool ThumbnailGenerator::checkWorkers()
@@ -305,7 +322,8 @@ void ThumbnailGenerator::generateThumbnail(IFileItem* fileitem)
   std::unique_ptr<FileOp> fop(
     FileOp::createLoadDocumentOperation(nullptr,
                                         fileitem->fileName().c_str(),
-                                        FILE_LOAD_SEQUENCE_NONE | FILE_LOAD_ONE_FRAME));
+                                        FILE_LOAD_SEQUENCE_NONE | FILE_LOAD_ONE_FRAME |
+                                          FILE_LOAD_PREVIEW));
   if (!fop || fop->hasError()) {
     // Set a nullptr thumbnail so we don't try to generate a thumbnail
     // for this fileitem again.
@@ -343,7 +361,7 @@ void ThumbnailGenerator::startWorker()
 {
   const std::lock_guard lock(m_workersAccess);
   if (m_workers.size() < m_maxWorkers) {
-    m_workers.push_back(std::make_unique<Worker>(m_remainingItems));
+    m_workers.push_back(std::make_unique<Worker>(m_remainingItems, m_cache.get()));
   }
 }
 
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2022  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -22,11 +22,14 @@ class thread;
 namespace app {
 class FileOp;
 class IFileItem;
+class ThumbnailCache;
 
 class ThumbnailGenerator {
   ThumbnailGenerator();
 
 public:
+  ~ThumbnailGenerator();
+
   static ThumbnailGenerator* instance();
 
   // Generate a thumbnail for the given file-item.  It must be called
@@ -60,6 +63,8 @@ private:
   };
 
   int m_maxWorkers;
+  // Declared before m_workers so it's destroyed after them
+  std::unique_ptr<ThumbnailCache> m_cache;
   WorkerList m_workers;
   std::mutex m_workersAccess;
   base::concurrent_queue<Item> m_remainingItems;
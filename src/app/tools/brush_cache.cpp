@@ -0,0 +1,178 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/tools/brush_cache.h"
+
+#include "doc/image.h"
+#include "render/gradient.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace app { namespace tools {
+
+using namespace doc;
+
+bool BrushCache::Key::operator==(const Key& other) const
+{
+  if (type != other.type || size != other.size || angle != other.angle ||
+      ditheringLevel != other.ditheringLevel)
+    return false;
+
+  if (ditheringLevel < 0)
+    return true;
+
+  return (pixelFormat == other.pixelFormat && color0 == other.color0 &&
+          color1 == other.color1 && ditheringMatrix == other.ditheringMatrix);
+}
+
+std::size_t BrushCache::KeyHash::operator()(const Key& key) const
+{
+  std::size_t hash = std::size_t(key.type);
+  auto combine = [&hash](const std::size_t value) {
+    hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  };
+  combine(key.size);
+  combine(key.angle);
+  combine(key.ditheringLevel);
+  if (key.ditheringLevel >= 0) {
+    combine(key.pixelFormat);
+    combine(key.color0);
+    combine(key.color1);
+    combine(key.ditheringMatrix.rows());
+    combine(key.ditheringMatrix.cols());
+    combine(key.ditheringMatrix.maxValue());
+  }
+  return hash;
+}
+
+BrushCache::BrushCache(std::size_t maxSize) : m_maxSize(maxSize)
+{
+}
+
+// static
+BrushCache* BrushCache::instance()
+{
+  static BrushCache cache;
+  return &cache;
+}
+
+BrushCache::Entry& BrushCache::get(const Key& origKey)
+{
+  // Compressed images are created after get() when the brush is
+  // used, so we update the size of the last used entry now.
+  if (!m_items.empty())
+    updateSize(m_items.front());
+
+  // Circle brushes look the same with any angle
+  const Key* keyPtr = &origKey;
+  Key circleKey;
+  if (origKey.type == kCircleBrushType && origKey.angle != 0) {
+    circleKey = origKey;
+    circleKey.angle = 0;
+    keyPtr = &circleKey;
+  }
+  const Key& key = *keyPtr;
+
+  auto it = m_map.find(key);
+  if (it != m_map.end()) {
+    // Move the entry to the front (most recently used)
+    if (it->second != m_items.begin())
+      m_items.splice(m_items.begin(), m_items, it->second);
+  }
+  else {
+    Item item;
+    item.key = key;
+    item.entry.brush = createBrush(key);
+    item.entry.compressedImages = std::make_shared<CompressedImages>();
+    m_items.push_front(std::move(item));
+    m_map[key] = m_items.begin();
+  }
+
+  Item& item = m_items.front();
+  updateSize(item);
+  shrinkToMaxSize();
+  return item.entry;
+}
+
+// static
+int BrushCache::ditheringLevel(const render::DitheringMatrix& matrix, const float gradient)
+{
+  // The pattern created by convert_bitmap_brush_to_dithering_brush()
+  // uses the first color when "gradient * (maxValue + 2)" is less
+  // than "matrix(y, x) + 1", i.e. when its integer part is less or
+  // equal than "matrix(y, x)".
+  return std::clamp(int(gradient * (matrix.maxValue() + 2)), 0, matrix.maxValue() + 2);
+}
+
+void BrushCache::clear()
+{
+  m_map.clear();
+  m_items.clear();
+  m_size = 0;
+}
+
+// static
+BrushRef BrushCache::createBrush(const Key& key)
+{
+  auto brush = std::make_shared<Brush>(key.type, key.size, key.angle);
+  if (key.ditheringLevel >= 0) {
+    // Use a gradient value in the middle of the level
+    const float gradient = (key.ditheringLevel + 0.5f) / (key.ditheringMatrix.maxValue() + 2);
+    render::convert_bitmap_brush_to_dithering_brush(brush.get(),
+                                                    key.pixelFormat,
+                                                    key.ditheringMatrix,
+                                                    gradient,
+                                                    key.color0,
+                                                    key.color1);
+  }
+  return brush;
+}
+
+// static
+std::size_t BrushCache::entrySize(const Entry& entry)
+{
+  const Brush* brush = entry.brush.get();
+  std::size_t size = brush->image()->getMemSize();
+  if (const Image* mask = brush->maskBitmap())
+    size += mask->getMemSize();
+  if (const Image* pattern = brush->patternImage())
+    size += pattern->getMemSize();
+  if (brush->originalImage() != brush->image())
+    size += brush->originalImage()->getMemSize();
+
+  for (const auto& compressed : *entry.compressedImages) {
+    if (compressed)
+      size += sizeof(CompressedImage) +
+              std::distance(compressed->begin(), compressed->end()) *
+                sizeof(CompressedImage::Scanline);
+  }
+  return size;
+}
+
+void BrushCache::updateSize(Item& item)
+{
+  m_size -= item.size;
+  item.size = entrySize(item.entry);
+  m_size += item.size;
+}
+
+void BrushCache::shrinkToMaxSize()
+{
+  // Remove least recently used entries (but keep the one just used)
+  while (m_size > m_maxSize && m_items.size() > 1) {
+    const Item& item = m_items.back();
+    m_size -= item.size;
+    m_map.erase(item.key);
+    m_items.pop_back();
+  }
+}
+
+}} // namespace app::tools
@@ -0,0 +1,106 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_TOOLS_BRUSH_CACHE_H_INCLUDED
+#define APP_TOOLS_BRUSH_CACHE_H_INCLUDED
+#pragma once
+
+#include "doc/brush.h"
+#include "doc/compressed_image.h"
+#include "render/dithering_matrix.h"
+
+#include <array>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace app { namespace tools {
+
+// Cache of brushes generated for strokes with dynamics (e.g. the
+// size/angle of the brush depends on the pen pressure or the
+// velocity), so we don't need to create the brush images (and their
+// compressed scanlines) again on each point of the stroke. It's
+// shared between strokes, and the least recently used brushes are
+// removed when the cache exceeds its maximum size.
+//
+// It must be used only from the thread that runs the tool loop.
+class BrushCache {
+public:
+  using CompressedImages =
+    std::array<std::shared_ptr<doc::CompressedImage>, int(doc::SymmetryIndex::ELEMENTS)>;
+
+  static constexpr std::size_t kDefaultMaxSize = 16 * 1024 * 1024;
+
+  struct Key {
+    doc::BrushType type = doc::kCircleBrushType;
+    int size = 1;
+    int angle = 0;
+    // Only for dithering brushes (ditheringLevel >= 0)
+    int ditheringLevel = -1;
+    doc::PixelFormat pixelFormat = doc::IMAGE_RGB;
+    render::DitheringMatrix ditheringMatrix;
+    doc::color_t color0 = 0;
+    doc::color_t color1 = 0;
+
+    bool operator==(const Key& other) const;
+  };
+
+  struct KeyHash {
+    std::size_t operator()(const Key& key) const;
+  };
+
+  struct Entry {
+    doc::BrushRef brush;
+    // Compressed images of each symmetry variant (created on demand)
+    std::shared_ptr<CompressedImages> compressedImages;
+  };
+
+  explicit BrushCache(std::size_t maxSize = kDefaultMaxSize);
+  BrushCache(const BrushCache&) = delete;
+  BrushCache& operator=(const BrushCache&) = delete;
+
+  static BrushCache* instance();
+
+  // Returns the brush for the given key, creating it if it isn't in
+  // the cache. The angle of circle brushes is ignored (they look the
+  // same with any angle).
+  Entry& get(const Key& key);
+
+  // Returns the level used in the Key::ditheringLevel field for the
+  // given gradient value. All gradient values with the same level
+  // generate the same dithering pattern.
+  static int ditheringLevel(const render::DitheringMatrix& matrix, float gradient);
+
+  // Memory used by the brushes and their compressed images (the
+  // compressed images of the last returned entry are counted in the
+  // next get() call).
+  std::size_t size() const { return m_size; }
+  std::size_t count() const { return m_items.size(); }
+  void clear();
+
+private:
+  struct Item {
+    Key key;
+    Entry entry;
+    std::size_t size = 0;
+  };
+  using Items = std::list<Item>;
+
+  static doc::BrushRef createBrush(const Key& key);
+  static std::size_t entrySize(const Entry& entry);
+  void updateSize(Item& item);
+  void shrinkToMaxSize();
+
+  std::size_t m_maxSize;
+  std::size_t m_size = 0;
+  Items m_items; // Most recently used first
+  std::unordered_map<Key, Items::iterator, KeyHash> m_map;
+};
+
+}} // namespace app::tools
+
+#endif
@@ -0,0 +1,134 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#include "tests/app_test.h"
+
+#include "app/tools/brush_cache.h"
+#include "doc/compressed_image.h"
+#include "doc/image.h"
+#include "doc/primitives.h"
+#include "render/dithering_matrix.h"
+#include "render/gradient.h"
+
+using namespace app::tools;
+using namespace doc;
+
+static BrushCache::Key make_key(BrushType type, int size, int angle)
+{
+  BrushCache::Key key;
+  key.type = type;
+  key.size = size;
+  key.angle = angle;
+  return key;
+}
+
+static BrushCache::Key make_dithering_key(color_t color)
+{
+  BrushCache::Key key = make_key(kCircleBrushType, 4, 0);
+  key.ditheringLevel = 1;
+  key.ditheringMatrix = render::BayerMatrix::make(2);
+  key.color0 = color;
+  key.color1 = rgba(255, 255, 255, 255);
+  return key;
+}
+
+TEST(BrushCache, ReuseBrushes)
+{
+  BrushCache cache;
+  BrushRef a = cache.get(make_key(kCircleBrushType, 8, 0)).brush;
+  BrushRef b = cache.get(make_key(kSquareBrushType, 8, 45)).brush;
+  EXPECT_NE(a, b);
+  EXPECT_EQ(2u, cache.count());
+
+  EXPECT_EQ(a, cache.get(make_key(kCircleBrushType, 8, 0)).brush);
+  EXPECT_EQ(b, cache.get(make_key(kSquareBrushType, 8, 45)).brush);
+  EXPECT_EQ(2u, cache.count());
+
+  EXPECT_EQ(kSquareBrushType, b->type());
+  EXPECT_EQ(8, b->size());
+  EXPECT_EQ(45, b->angle());
+
+  // Circle brushes are the same with any angle
+  EXPECT_EQ(a, cache.get(make_key(kCircleBrushType, 8, 30)).brush);
+  EXPECT_EQ(2u, cache.count());
+}
+
+TEST(BrushCache, RemoveLeastRecentlyUsed)
+{
+  // Dithering brushes with different colors have the same size
+  std::size_t brushSize;
+  {
+    BrushCache cache;
+    cache.get(make_dithering_key(rgba(0, 0, 0, 255)));
+    brushSize = cache.size();
+  }
+  EXPECT_GT(brushSize, 0u);
+
+  BrushCache cache(2 * brushSize);
+  BrushRef a = cache.get(make_dithering_key(rgba(0, 0, 0, 255))).brush;
+  BrushRef b = cache.get(make_dithering_key(rgba(255, 0, 0, 255))).brush;
+  EXPECT_EQ(2 * brushSize, cache.size());
+
+  // The pattern image is part of the size of the brush
+  ASSERT_TRUE(a->patternImage());
+  EXPECT_GT(brushSize, a->image()->getMemSize() + a->patternImage()->getMemSize());
+
+  // Use "a" so "b" is the least recently used one
+  EXPECT_EQ(a, cache.get(make_dithering_key(rgba(0, 0, 0, 255))).brush);
+  cache.get(make_dithering_key(rgba(0, 255, 0, 255)));
+  EXPECT_EQ(2u, cache.count());
+  EXPECT_EQ(2 * brushSize, cache.size());
+  EXPECT_EQ(a, cache.get(make_dithering_key(rgba(0, 0, 0, 255))).brush);
+  EXPECT_NE(b, cache.get(make_dithering_key(rgba(255, 0, 0, 255))).brush);
+
+  cache.clear();
+  EXPECT_EQ(0u, cache.count());
+  EXPECT_EQ(0u, cache.size());
+}
+
+TEST(BrushCache, CompressedImagesSize)
+{
+  BrushCache cache;
+  BrushCache::Entry& entry = cache.get(make_key(kSquareBrushType, 8, 0));
+  const std::size_t brushSize = cache.size();
+
+  // Compressed images are counted in the next get()
+  (*entry.compressedImages)[0] =
+    std::make_shared<CompressedImage>(entry.brush->image(), entry.brush->maskBitmap(), false);
+  cache.get(make_key(kSquareBrushType, 8, 0));
+  EXPECT_LT(brushSize, cache.size());
+}
+
+TEST(BrushCache, DitheringLevels)
+{
+  const render::DitheringMatrix matrix = render::BayerMatrix::make(4);
+
+  // Gradient values with the same level generate the same pattern
+  for (int i = 0; i <= 100; ++i) {
+    const float gradient = i / 100.0f;
+    BrushCache::Key key = make_key(kCircleBrushType, 8, 0);
+    key.ditheringLevel = BrushCache::ditheringLevel(matrix, gradient);
+    key.pixelFormat = IMAGE_RGB;
+    key.ditheringMatrix = matrix;
+    key.color0 = rgba(0, 0, 0, 255);
+    key.color1 = rgba(255, 255, 255, 255);
+
+    BrushCache cache;
+    BrushRef cached = cache.get(key).brush;
+
+    auto expected = std::make_shared<Brush>(kCircleBrushType, 8, 0);
+    render::convert_bitmap_brush_to_dithering_brush(expected.get(),
+                                                    IMAGE_RGB,
+                                                    matrix,
+                                                    gradient,
+                                                    key.color0,
+                                                    key.color1);
+
+    ASSERT_TRUE(cached->patternImage());
+    EXPECT_EQ(0, count_diff_between_images(expected->patternImage(), cached->patternImage()))
+      << "gradient=" << gradient;
+  }
+}
@@ -7,13 +7,13 @@
 
 #include "app/util/wrap_point.h"
 
+#include "app/tools/brush_cache.h"
 #include "app/tools/ink.h"
 #include "app/tools/symmetry.h"
 #include "doc/algorithm/flip_image.h"
 #include "doc/primitives.h"
 #include "render/gradient.h"
 
-#include <array>
 #include <limits>
 #include <memory>
 
@@ -105,7 +105,9 @@ class BrushPointShape : public PointShape {
   bool m_firstPoint;
   Brush* m_lastBrush;
   BrushType m_origBrushType;
-  std::array<std::shared_ptr<CompressedImage>, int(SymmetryIndex::ELEMENTS)> m_compressedImages;
+  std::shared_ptr<BrushCache::CompressedImages> m_compressedImages;
+  // Compressed images of the last brush from the BrushCache
+  std::shared_ptr<BrushCache::CompressedImages> m_cachedCompressedImages;
   // For dynamics
   DynamicsOptions m_dynamics;
   bool m_useDynamics;
@@ -119,6 +121,7 @@ public:
   {
     m_firstPoint = true;
     m_lastBrush = nullptr;
+    m_cachedCompressedImages.reset();
     m_origBrushType = loop->getBrush()->type();
 
     m_dynamics = loop->getDynamics();
@@ -208,24 +211,32 @@ public:
       if ((brush->size() != size) ||
           (brush->angle() != angle && m_origBrushType != kCircleBrushType) ||
           (m_hasDynamicGradient && pt.gradient != m_lastGradientValue)) {
-        // TODO cache brushes
-        BrushRef newBrush = std::make_shared<Brush>(m_origBrushType, size, angle);
+        BrushCache::Key key;
+        key.type = m_origBrushType;
+        key.size = size;
+        key.angle = angle;
 
         // Dynamic gradient with dithering
         bool prepareInk = false;
         if (m_hasDynamicGradient && !ink->isEraser() &&
             (m_dynamics.ditheringMatrix.rows() > 1 || m_dynamics.ditheringMatrix.cols() > 1)) {
-          convert_bitmap_brush_to_dithering_brush(newBrush.get(),
-                                                  loop->sprite()->pixelFormat(),
-                                                  m_dynamics.ditheringMatrix,
-                                                  pt.gradient,
-                                                  m_secondaryColor,
-                                                  m_primaryColor);
+          key.ditheringLevel = BrushCache::ditheringLevel(m_dynamics.ditheringMatrix, pt.gradient);
+          key.pixelFormat = loop->sprite()->pixelFormat();
+          key.ditheringMatrix = m_dynamics.ditheringMatrix;
+          key.color0 = m_secondaryColor;
+          key.color1 = m_primaryColor;
           prepareInk = true;
         }
         m_lastGradientValue = pt.gradient;
 
-        loop->setBrush(newBrush);
+        // Brushes are re-used from the cache (and between strokes),
+        // so we don't need to create their images again.
+        BrushCache::Entry& entry = BrushCache::instance()->get(key);
+        m_cachedCompressedImages = entry.compressedImages;
+        if (entry.brush.get() == brush)
+          prepareInk = false;
+
+        loop->setBrush(entry.brush);
         brush = loop->getBrush();
 
         if (prepareInk) {
@@ -235,10 +246,12 @@ public:
       }
     }
 
-    // TODO cache compressed images (or remove them completelly)
     if (m_lastBrush != brush) {
       m_lastBrush = brush;
-      m_compressedImages.fill(nullptr);
+      if (m_cachedCompressedImages)
+        m_compressedImages = m_cachedCompressedImages;
+      else
+        m_compressedImages = std::make_shared<BrushCache::CompressedImages>();
     }
 
     if (brush->type() == kImageBrushType && does_symmetry_rotate_image(pt.symmetry)) {
@@ -303,7 +316,7 @@ public:
 private:
   CompressedImage& getCompressedImage(doc::SymmetryIndex index)
   {
-    auto& compressPtr = m_compressedImages[int(index)];
+    auto& compressPtr = (*m_compressedImages)[int(index)];
     if (!compressPtr) {
       compressPtr.reset(new CompressedImage(m_lastBrush->getSymmetryImage(index),
                                             m_lastBrush->getSymmetryMask(index),
@@ -27,6 +27,7 @@
 #include "gfx/point_io.h"
 #include "gfx/rect_io.h"
 #include "gfx/region.h"
+#include "trace/trace.h"
 
 #include <algorithm>
 #include <climits>
@@ -93,6 +94,7 @@ void ToolLoopManager::notifyToolLoopModifiersChange()
 
 void ToolLoopManager::pressButton(const Pointer& pointer)
 {
+  TRACE_ZONE("ToolLoopManager::pressButton");
   TOOL_TRACE("ToolLoopManager::pressButton", pointer.point());
 
   // A little patch to memorize initial Trace Policy in the
@@ -142,6 +144,7 @@ void ToolLoopManager::pressButton(const Pointer& pointer)
 
 bool ToolLoopManager::releaseButton(const Pointer& pointer)
 {
+  TRACE_ZONE("ToolLoopManager::releaseButton");
   TOOL_TRACE("ToolLoopManager::releaseButton", pointer.point());
 
   m_lastPointer = pointer;
@@ -169,6 +172,8 @@ bool ToolLoopManager::releaseButton(const Pointer& pointer)
 
 void ToolLoopManager::movement(Pointer pointer)
 {
+  TRACE_ZONE("ToolLoopManager::movement");
+
   // Filter points with the stabilizer
   if (m_dynamics.stabilizer && m_dynamics.stabilizerFactor > 0) {
     const double f = m_dynamics.stabilizerFactor;
@@ -211,6 +216,8 @@ void ToolLoopManager::disableMouseStabilizer()
 
 void ToolLoopManager::doLoopStep(bool lastStep)
 {
+  TRACE_ZONE("ToolLoopManager::doLoopStep");
+
   // Original set of points to interwine (original user stroke,
   // relative to sprite origin).
   Stroke main_stroke;
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2024  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 // Copyright (C) 2017  David Capello
 //
 // This program is distributed under the terms of
@@ -32,6 +32,7 @@
 #include "ui/size_hint_event.h"
 
 #include <algorithm>
+#include <optional>
 
 namespace app {
 
@@ -53,6 +54,16 @@ public:
   {
   }
 
+  // The matrix of the extension is loaded when it's needed (e.g. to
+  // paint the preview or when the item is selected)
+  DitherItem(render::DitheringAlgorithm algo,
+             const Extension::DitheringMatrixInfo& matrixInfo,
+             const std::string& text)
+    : DitherItem(algo, render::DitheringMatrix(), text)
+  {
+    m_matrixInfo = matrixInfo;
+  }
+
   DitherItem(const render::DitheringMatrix& matrix, const std::string& text)
     : ListItem(text)
     , m_matrixOnly(true)
@@ -63,11 +74,32 @@ public:
   {
   }
 
+  DitherItem(const Extension::DitheringMatrixInfo& matrixInfo, const std::string& text)
+    : DitherItem(render::DitheringMatrix(), text)
+  {
+    m_matrixInfo = matrixInfo;
+  }
+
   render::DitheringAlgorithm algo() const { return m_dithering.algorithm(); }
 
-  render::DitheringMatrix matrix() const { return m_dithering.matrix(); }
+  render::DitheringMatrix matrix() const { return dithering().matrix(); }
 
 private:
+  const render::Dithering& dithering() const
+  {
+    if (m_matrixInfo) {
+      try {
+        m_dithering.matrix(m_matrixInfo->matrix());
+      }
+      catch (const std::exception& e) {
+        LOG(ERROR, "%s\n", e.what());
+        Console::showException(e);
+      }
+      m_matrixInfo.reset();
+    }
+    return m_dithering;
+  }
+
   os::Surface* preview()
   {
     const doc::Palette* palette = get_current_palette();
@@ -90,7 +122,7 @@ private:
                                 gfx::Point(w - 1, 0),
                                 doc::rgba(0, 0, 0, 255),
                                 doc::rgba(255, 255, 255, 255),
-                                (m_matrixOnly ? m_dithering.matrix() : render::DitheringMatrix()));
+                                (m_matrixOnly ? matrix() : render::DitheringMatrix()));
 
     doc::ImageRef image2;
     if (m_matrixOnly) {
@@ -102,7 +134,7 @@ private:
       render::convert_pixel_format(image1.get(),
                                    image2.get(),
                                    IMAGE_INDEXED,
-                                   m_dithering,
+                                   dithering(),
                                    nullptr,
                                    palette,
                                    true,
@@ -163,7 +195,8 @@ private:
   }
 
   bool m_matrixOnly;
-  render::Dithering m_dithering;
+  mutable render::Dithering m_dithering;
+  mutable std::optional<Extension::DitheringMatrixInfo> m_matrixInfo;
   os::SurfaceRef m_preview;
   doc::ObjectId m_palId;
   int m_palMods;
@@ -212,26 +245,14 @@ void DitheringSelector::regenerate(int selectedItemIndex)
                              render::DitheringMatrix(),
                              Strings::dithering_selector_no_dithering()));
       for (const auto* it : ditheringMatrices) {
-        try {
-          addItem(new DitherItem(render::DitheringAlgorithm::Ordered,
-                                 it->matrix(),
-                                 Strings::dithering_selector_ordered_dithering() + it->name()));
-        }
-        catch (const std::exception& e) {
-          LOG(ERROR, "%s\n", e.what());
-          Console::showException(e);
-        }
+        addItem(new DitherItem(render::DitheringAlgorithm::Ordered,
+                               *it,
+                               Strings::dithering_selector_ordered_dithering() + it->name()));
       }
       for (const auto* it : ditheringMatrices) {
-        try {
-          addItem(new DitherItem(render::DitheringAlgorithm::Old,
-                                 it->matrix(),
-                                 Strings::dithering_selector_old_dithering() + it->name()));
-        }
-        catch (const std::exception& e) {
-          LOG(ERROR, "%s\n", e.what());
-          Console::showException(e);
-        }
+        addItem(new DitherItem(render::DitheringAlgorithm::Old,
+                               *it,
+                               Strings::dithering_selector_old_dithering() + it->name()));
       }
       addItem(new DitherItem(render::DitheringAlgorithm::ErrorDiffusion,
                              render::DitheringMatrix(),
@@ -240,15 +261,8 @@ void DitheringSelector::regenerate(int selectedItemIndex)
     case SelectMatrix:
       addItem(
         new DitherItem(render::DitheringMatrix(), Strings::dithering_selector_no_dithering()));
-      for (const auto* it : ditheringMatrices) {
-        try {
-          addItem(new DitherItem(it->matrix(), it->name()));
-        }
-        catch (const std::exception& e) {
-          LOG(ERROR, "%s\n", e.what());
-          Console::showException(e);
-        }
-      }
+      for (const auto* it : ditheringMatrices)
+        addItem(new DitherItem(*it, it->name()));
       break;
   }
   selectedItemIndex = std::clamp(selectedItemIndex, 0, std::max(0, getItemCount() - 1));
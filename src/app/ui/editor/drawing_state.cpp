@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2025  Igara Studio S.A.
+// Copyright (C) 2018-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -109,6 +109,18 @@ void DrawingState::initToolLoop(Editor* editor,
        doc::BlendMode::NEG_BW)); // To preview the selection ink we use the negative black & white
                                  // blender
 
+  // Cache the other layers in the visible area, so each mouse
+  // movement only needs to composite the modified area of this layer
+  // between them. With tiles mode we modify the tileset, which can
+  // be used by other layers too.
+  if (previewLayer && !tileset) {
+    const render::Projection& proj = editor->projection();
+    gfx::Rect bounds = editor->getVisibleSpriteBounds();
+    bounds.enlarge(int(1.0 / std::min(proj.scaleX(), proj.scaleY())) + 1);
+    bounds &= editor->sprite()->bounds();
+    editor->renderEngine().setPreviewLayersCache(bounds);
+  }
+
   ASSERT(!m_toolLoopManager->isCanceled());
 
   m_velocity.reset();
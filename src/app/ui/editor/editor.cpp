@@ -41,6 +41,7 @@
 #include "app/ui/editor/editor_customization_delegate.h"
 #include "app/ui/editor/editor_decorator.h"
 #include "app/ui/editor/editor_render.h"
+#include "app/ui/editor/frame_prefetcher.h"
 #include "app/ui/editor/glue.h"
 #include "app/ui/editor/moving_pixels_state.h"
 #include "app/ui/editor/pixels_movement.h"
@@ -54,6 +55,7 @@
 #include "app/ui/timeline/timeline.h"
 #include "app/ui/toolbar.h"
 #include "app/ui_context.h"
+#include "app/util/conversion_to_surface.h"
 #include "app/util/layer_utils.h"
 #include "app/util/tile_flags_utils.h"
 #include "base/chrono.h"
@@ -67,7 +69,9 @@
 #include "os/sampling.h"
 #include "os/surface.h"
 #include "os/system.h"
+#include "render/mipmaps.h"
 #include "render/rasterize.h"
+#include "trace/trace.h"
 #include "ui/ui.h"
 #include "view/layers.h"
 
@@ -437,6 +441,9 @@ void Editor::setFrame(frame_t frame)
   // Invalidate canvas area
   invalidateCanvas();
   updateStatusBar();
+
+  // Release the memory of cels loaded on demand in other frames
+  m_document->unloadLazyCels();
 }
 
 void Editor::getSite(Site* site) const
@@ -592,6 +599,8 @@ void Editor::drawOneSpriteUnclippedRect(ui::Graphics* g,
                                         int dx,
                                         int dy)
 {
+  TRACE_ZONE("Editor::drawOneSpriteUnclippedRect");
+
   // Clip from sprite and apply zoom
   gfx::Rect rc = m_sprite->bounds().createIntersection(spriteRectToDraw);
   rc = m_proj.apply(rc);
@@ -654,9 +663,33 @@ void Editor::drawOneSpriteUnclippedRect(ui::Graphics* g,
   // rc2 is the rectangle used to create a temporal rendered image of the sprite
   const auto& pref = Preferences::instance();
   const bool newEngine = isUsingNewRenderEngine();
+
+  // With the new engine and nearest-neighbor downsampling we can
+  // render the sprite directly at a power of two fraction of its
+  // size (using the cel mipmaps) and let the GPU scale the rest,
+  // instead of compositing all the sprite pixels at 100%.
+  int mipStep = 1;
+  if (newEngine && m_proj.scaleX() < 1.0 && m_proj.scaleY() < 1.0 &&
+      pref.experimental.mipmaps() && pref.editor.downsampling() == gen::Downsampling::NEAREST &&
+      m_docPref.bg.zoom()) {
+    const int maxStep = std::min(int(1.0 / m_proj.scaleX()), int(1.0 / m_proj.scaleY()));
+    while (mipStep * 2 <= maxStep && mipStep < (1 << render::Mipmaps::kMaxLevel))
+      mipStep *= 2;
+  }
+
   gfx::Rect rc2;
   if (newEngine) {
     rc2 = expose; // New engine, exposed rectangle (without zoom)
+    if (mipStep > 1) {
+      // Align the rectangle to mipStep boundaries so each rendered
+      // pixel is the top-left pixel of a mipStep x mipStep block
+      const int x2 = rc2.x2();
+      const int y2 = rc2.y2();
+      rc2.x -= rc2.x % mipStep;
+      rc2.y -= rc2.y % mipStep;
+      rc2.w = (x2 + mipStep - 1) / mipStep * mipStep - rc2.x;
+      rc2.h = (y2 + mipStep - 1) / mipStep * mipStep - rc2.y;
+    }
     dest.x = dx + m_padding.x + m_proj.applyX(rc2.x);
     dest.y = dy + m_padding.y + m_proj.applyY(rc2.y);
     dest.w = m_proj.applyX(rc2.w);
@@ -668,6 +701,16 @@ void Editor::drawOneSpriteUnclippedRect(ui::Graphics* g,
     dest.h = rc.h;
   }
 
+  // Screen area that we have to update (the aligned "rc2" might
+  // include extra pixels outside the exposed area).
+  const gfx::Rect exposedDest(dx + m_padding.x + m_proj.applyX(expose.x),
+                              dy + m_padding.y + m_proj.applyY(expose.y),
+                              m_proj.applyX(expose.w),
+                              m_proj.applyY(expose.h));
+
+  // Size of the rendered image (in pixels of the "rendered" surface)
+  const gfx::Size renderedSize(rc2.w / mipStep, rc2.h / mipStep);
+
   // Convert the render to a os::Surface
   static os::SurfaceRef rendered = nullptr; // TODO move this to other centralized place
   const auto& renderProperties = m_renderEngine->properties();
@@ -679,12 +722,19 @@ void Editor::drawOneSpriteUnclippedRect(ui::Graphics* g,
 
     m_renderEngine->setComposeGroups(pref.experimental.composeGroups());
     m_renderEngine->setNewBlendMethod(pref.experimental.newBlend());
+    m_renderEngine->setMipmaps(pref.experimental.mipmaps());
     m_renderEngine->setRefLayersVisiblity(true);
     m_renderEngine->setSelectedLayer(m_layer);
     m_renderEngine->setNonactiveLayersOpacity(otherLayersOpacity());
     m_renderEngine->setupBackground(m_document, IMAGE_RGB);
     m_renderEngine->disableOnionskin();
 
+    // We can use a frame rendered in advance (e.g. in the PlayState)
+    // only if it was rendered with the same configuration.
+    bool usePrefetchedFrame = (newEngine && mipStep == 1 &&
+                               m_renderEngine->type() == EditorRender::Type::kSimpleRenderer &&
+                               otherLayersOpacity() == 255 && !m_renderEngine->hasPreviewImage());
+
     if ((m_flags & kShowOnionskin) == kShowOnionskin) {
       if (m_docPref.onionskin.active()) {
         OnionskinOptions opts(
@@ -707,6 +757,7 @@ void Editor::drawOneSpriteUnclippedRect(ui::Graphics* g,
         opts.loopTag(tag);
 
         m_renderEngine->setOnionskin(opts);
+        usePrefetchedFrame = false;
       }
     }
 
@@ -728,6 +779,30 @@ void Editor::drawOneSpriteUnclippedRect(ui::Graphics* g,
                                     extraCel->blendMode(),
                                     m_layer,
                                     m_frame);
+      usePrefetchedFrame = false;
+    }
+
+    doc::ImageRef prefetchedFrame;
+    gfx::Rect prefetchedBounds;
+    FramePrefetcher* prefetcher = (usePrefetchedFrame ? m_state->getFramePrefetcher() : nullptr);
+    if (prefetcher) {
+      // Render the visible area (plus the extra pixels that the
+      // "expose" rectangle can include when zoom < 100%)
+      gfx::Rect bounds = getVisibleSpriteBounds();
+      bounds.enlarge(int(1.0 / std::min(m_proj.scaleX(), m_proj.scaleY())) + 1);
+      bounds &= m_sprite->bounds();
+
+      FramePrefetcher::Config config;
+      config.bg = EditorRender::makeBgOptions(m_document, IMAGE_RGB);
+      config.newBlend = pref.experimental.newBlend();
+      config.composeGroups = pref.experimental.composeGroups();
+      config.bounds = bounds;
+
+      prefetchedFrame = prefetcher->frameImage(m_frame, config);
+      if (prefetchedFrame && bounds.contains(rc2))
+        prefetchedBounds = bounds;
+      else
+        prefetchedFrame.reset();
     }
 
     // Render background first (e.g. new ShaderRenderer will paint the
@@ -743,15 +818,37 @@ void Editor::drawOneSpriteUnclippedRect(ui::Graphics* g,
     }
 
     // Create a temporary surface to draw the sprite on it
-    if (!rendered || rendered->width() < rc2.w || rendered->height() < rc2.h ||
+    if (!rendered || rendered->width() < renderedSize.w || rendered->height() < renderedSize.h ||
         rendered->colorSpace() != m_document->osColorSpace()) {
-      const int maxw = std::max(rc2.w, rendered ? rendered->width() : 0);
-      const int maxh = std::max(rc2.h, rendered ? rendered->height() : 0);
+      const int maxw = std::max(renderedSize.w, rendered ? rendered->width() : 0);
+      const int maxh = std::max(renderedSize.h, rendered ? rendered->height() : 0);
       rendered = os::System::instance()->makeRgbaSurface(maxw, maxh, m_document->osColorSpace());
     }
 
-    m_renderEngine->setProjection(newEngine ? render::Projection() : m_proj);
-    m_renderEngine->renderSprite(rendered.get(), m_sprite, m_frame, gfx::Clip(0, 0, rc2));
+    if (prefetchedFrame) {
+      convert_image_to_surface(prefetchedFrame.get(),
+                               m_sprite->palette(m_frame),
+                               rendered.get(),
+                               rc2.x - prefetchedBounds.x,
+                               rc2.y - prefetchedBounds.y,
+                               0,
+                               0,
+                               rc2.w,
+                               rc2.h);
+    }
+    else if (mipStep > 1) {
+      m_renderEngine->setProjection(
+        render::Projection(doc::PixelRatio(1, 1), render::Zoom(1, mipStep)));
+      m_renderEngine->renderSprite(
+        rendered.get(),
+        m_sprite,
+        m_frame,
+        gfx::Clip(0, 0, rc2.x / mipStep, rc2.y / mipStep, renderedSize.w, renderedSize.h));
+    }
+    else {
+      m_renderEngine->setProjection(newEngine ? render::Projection() : m_proj);
+      m_renderEngine->renderSprite(rendered.get(), m_sprite, m_frame, gfx::Clip(0, 0, rc2));
+    }
 
     m_renderEngine->removeExtraImage();
 
@@ -792,15 +889,20 @@ void Editor::drawOneSpriteUnclippedRect(ui::Graphics* g,
       else
         p.blendMode(os::BlendMode::Src);
 
-      gfx::Rect destClip = dest;
+      gfx::Rect destClip = (mipStep > 1 ? exposedDest : dest);
       if (m_proj.scaleX() < 1.0)
         --destClip.w;
       if (m_proj.scaleY() < 1.0)
         --destClip.h;
 
       IntersectClip clip(g, destClip);
-      if (clip)
-        g->drawSurface(rendered.get(), gfx::Rect(0, 0, rc2.w, rc2.h), dest, sampling, &p);
+      if (clip) {
+        g->drawSurface(rendered.get(),
+                       gfx::Rect(0, 0, renderedSize.w, renderedSize.h),
+                       dest,
+                       sampling,
+                       &p);
+      }
     }
     else {
       g->drawSurface(rendered.get(),
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2023  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 // Copyright (C) 2018  David Capello
 //
 // This program is distributed under the terms of
@@ -26,6 +26,7 @@ EditorRender::EditorRender()
 {
   m_renderer->setNewBlendMethod(Preferences::instance().experimental.newBlend());
   m_renderer->setComposeGroups(Preferences::instance().experimental.composeGroups());
+  m_renderer->setMipmaps(Preferences::instance().experimental.mipmaps());
 }
 
 EditorRender::~EditorRender()
@@ -76,12 +77,23 @@ void EditorRender::setComposeGroups(const bool composeGroups)
   m_renderer->setComposeGroups(composeGroups);
 }
 
+void EditorRender::setMipmaps(const bool enabled)
+{
+  m_renderer->setMipmaps(enabled);
+}
+
 void EditorRender::setProjection(const render::Projection& projection)
 {
   m_renderer->setProjection(projection);
 }
 
 void EditorRender::setupBackground(Doc* doc, doc::PixelFormat pixelFormat)
+{
+  m_renderer->setBgOptions(makeBgOptions(doc, pixelFormat));
+}
+
+// static
+render::BgOptions EditorRender::makeBgOptions(Doc* doc, doc::PixelFormat pixelFormat)
 {
   DocumentPreferences& docPref = Preferences::instance().document(doc);
   render::BgType bgType;
@@ -122,7 +134,7 @@ void EditorRender::setupBackground(Doc* doc, doc::PixelFormat pixelFormat)
   bg.color1 = color_utils::color_for_image_without_alpha(docPref.bg.color1(), pixelFormat);
   bg.color2 = color_utils::color_for_image_without_alpha(docPref.bg.color2(), pixelFormat);
   bg.stripeSize = tile;
-  m_renderer->setBgOptions(bg);
+  return bg;
 }
 
 void EditorRender::setTransparentBackground()
@@ -143,11 +155,18 @@ void EditorRender::setPreviewImage(const doc::Layer* layer,
                                    const doc::BlendMode blendMode)
 {
   m_renderer->setPreviewImage(layer, frame, image, tileset, pos, blendMode);
+  m_hasPreviewImage = (image != nullptr);
 }
 
 void EditorRender::removePreviewImage()
 {
   m_renderer->removePreviewImage();
+  m_hasPreviewImage = false;
+}
+
+void EditorRender::setPreviewLayersCache(const gfx::Rect& bounds)
+{
+  m_renderer->setPreviewLayersCache(bounds);
 }
 
 void EditorRender::setExtraImage(render::ExtraType type,
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2022  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 // Copyright (C) 2018  David Capello
 //
 // This program is distributed under the terms of
@@ -17,6 +17,7 @@
 #include "doc/pixel_format.h"
 #include "gfx/clip.h"
 #include "gfx/point.h"
+#include "render/bg_options.h"
 #include "render/extra_type.h"
 #include "render/onionskin_options.h"
 #include "render/projection.h"
@@ -56,10 +57,12 @@ public:
   void setNonactiveLayersOpacity(const int opacity);
   void setNewBlendMethod(const bool newBlend);
   void setComposeGroups(bool composeGroups);
+  void setMipmaps(bool enabled);
 
   void setProjection(const render::Projection& projection);
 
   void setupBackground(Doc* doc, doc::PixelFormat pixelFormat);
+  static render::BgOptions makeBgOptions(Doc* doc, doc::PixelFormat pixelFormat);
   void setTransparentBackground();
 
   void setSelectedLayer(const doc::Layer* layer);
@@ -71,6 +74,8 @@ public:
                        const gfx::Point& pos,
                        const doc::BlendMode blendMode);
   void removePreviewImage();
+  void setPreviewLayersCache(const gfx::Rect& bounds);
+  bool hasPreviewImage() const { return m_hasPreviewImage; }
 
   void setExtraImage(render::ExtraType type,
                      const doc::Cel* cel,
@@ -102,6 +107,7 @@ public:
 
 private:
   std::unique_ptr<Renderer> m_renderer;
+  bool m_hasPreviewImage = false;
 };
 
 } // namespace app
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2024  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 // Copyright (C) 2001-2016  David Capello
 //
 // This program is distributed under the terms of
@@ -33,6 +33,7 @@ class Tag;
 namespace app {
 class Editor;
 class EditorDecorator;
+class FramePrefetcher;
 
 namespace tools {
 class Ink;
@@ -152,6 +153,10 @@ public:
   // Called when the editable flag of a specific layer is changed.
   virtual void onBeforeLayerEditableChange(Editor* editor, doc::Layer* layer, bool newState) {}
 
+  // Returns the frames rendered in advance by this state (e.g. the
+  // next frames of an animation playback).
+  virtual FramePrefetcher* getFramePrefetcher() { return nullptr; }
+
 private:
   DISABLE_COPYING(EditorState);
 };
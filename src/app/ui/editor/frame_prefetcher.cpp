@@ -0,0 +1,207 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/ui/editor/frame_prefetcher.h"
+
+#include "app/doc.h"
+#include "app/doc_undo.h"
+#include "doc/image.h"
+#include "doc/sprite.h"
+#include "render/render.h"
+
+#include <algorithm>
+
+namespace app {
+
+using namespace doc;
+
+FramePrefetcher::FramePrefetcher(Doc* doc) : m_doc(doc)
+{
+  m_doc->add_observer(this);
+  m_doc->undoHistory()->add_observer(this);
+}
+
+FramePrefetcher::~FramePrefetcher()
+{
+  // The task uses the document and this object, so we have to wait
+  // it to return before removing the observers.
+  if (m_task) {
+    m_task->cancel();
+    m_task->wait();
+  }
+
+  m_doc->undoHistory()->remove_observer(this);
+  m_doc->remove_observer(this);
+}
+
+ImageRef FramePrefetcher::frameImage(const frame_t frame, const Config& config)
+{
+  const std::lock_guard lock(m_mutex);
+
+  if (!m_hasConfig || m_config != config) {
+    m_config = config;
+    m_hasConfig = true;
+    m_frames.clear();
+    ++m_generation;
+    return nullptr;
+  }
+
+  auto it = m_frames.find(frame);
+  if (it != m_frames.end())
+    return it->second;
+  return nullptr;
+}
+
+void FramePrefetcher::prefetch(const Playback& playback)
+{
+  int maxFrames;
+  {
+    const std::lock_guard lock(m_mutex);
+    if (!m_hasConfig || m_config.bounds.isEmpty())
+      return;
+
+    const std::size_t frameSize = std::size_t(m_config.bounds.w) * m_config.bounds.h *
+                                  RgbTraits::bytes_per_pixel;
+    maxFrames = int(std::min<std::size_t>(kMaxFrames, kMaxMemSize / frameSize));
+  }
+
+  // Simulate the playback to know the next frames (this includes
+  // ping-pong directions, tags with repeat, etc.)
+  std::vector<frame_t> nextFrames;
+  Playback next(playback);
+  const frame_t lastFrame = m_doc->sprite()->lastFrame();
+  for (int i = 0; i < maxFrames; ++i) {
+    const frame_t frame = next.nextFrame();
+    if (next.isStopped() || frame < 0 || frame > lastFrame)
+      break;
+    if (std::find(nextFrames.begin(), nextFrames.end(), frame) == nextFrames.end())
+      nextFrames.push_back(frame);
+  }
+
+  bool hasNextFrames;
+  {
+    const std::lock_guard lock(m_mutex);
+    m_nextFrames = std::move(nextFrames);
+    hasNextFrames = !m_nextFrames.empty();
+
+    // Discard frames that will not be needed soon
+    for (auto it = m_frames.begin(); it != m_frames.end();) {
+      if (it->first != playback.frame() &&
+          std::find(m_nextFrames.begin(), m_nextFrames.end(), it->first) == m_nextFrames.end()) {
+        it = m_frames.erase(it);
+      }
+      else
+        ++it;
+    }
+  }
+
+  // The task is restarted only when the previous execution has
+  // completely returned (the task finishes when all the next frames
+  // are ready or when the document is locked).
+  if (hasNextFrames && (!m_task || m_task->completed())) {
+    m_task = doc::TaskScheduler::instance().run(
+      [this](doc::TaskScheduler::Token& token) { onRenderFrames(token); });
+  }
+}
+
+void FramePrefetcher::invalidate()
+{
+  const std::lock_guard lock(m_mutex);
+  m_frames.clear();
+  ++m_generation;
+}
+
+void FramePrefetcher::onGeneralUpdate(DocEvent& ev)
+{
+  invalidate();
+}
+
+void FramePrefetcher::onColorSpaceChanged(DocEvent& ev)
+{
+  invalidate();
+}
+
+void FramePrefetcher::onPaletteChanged(DocEvent& ev)
+{
+  invalidate();
+}
+
+void FramePrefetcher::onSpritePixelsModified(DocEvent& ev)
+{
+  invalidate();
+}
+
+void FramePrefetcher::onAfterLayerVisibilityChange(DocEvent& ev)
+{
+  invalidate();
+}
+
+void FramePrefetcher::onCurrentUndoStateChange(DocUndo* history)
+{
+  invalidate();
+}
+
+// Executed in a background thread
+void FramePrefetcher::onRenderFrames(doc::TaskScheduler::Token& token)
+{
+  while (!token.canceled()) {
+    Config config;
+    frame_t frame = -1;
+    int generation;
+    {
+      const std::lock_guard lock(m_mutex);
+      for (const frame_t f : m_nextFrames) {
+        if (m_frames.find(f) == m_frames.end()) {
+          frame = f;
+          break;
+        }
+      }
+      // All the next frames are ready
+      if (frame < 0)
+        break;
+      config = m_config;
+      generation = m_generation;
+    }
+
+    ImageRef image(Image::create(IMAGE_RGB, config.bounds.w, config.bounds.h));
+
+    // If the document is locked (e.g. the user is modifying it),
+    // we'll try again in the next prefetch() call.
+    const Doc::LockResult lockResult = m_doc->readLock(0);
+    if (lockResult == Doc::LockResult::Fail)
+      break;
+
+    const Sprite* sprite = m_doc->sprite();
+    if (frame <= sprite->lastFrame()) {
+      render::Render render;
+      render.setNewBlend(config.newBlend);
+      render.setComposeGroups(config.composeGroups);
+      render.setRefLayersVisiblity(true);
+      render.setBgOptions(config.bg);
+      render.renderSprite(image.get(), sprite, frame, gfx::Clip(0, 0, config.bounds));
+    }
+    else
+      image.reset();
+
+    m_doc->unlock(lockResult);
+
+    const std::lock_guard lock(m_mutex);
+    if (!image) {
+      m_nextFrames.erase(std::remove(m_nextFrames.begin(), m_nextFrames.end(), frame),
+                         m_nextFrames.end());
+    }
+    // Discard the image if the document was modified in the meantime
+    else if (generation == m_generation) {
+      m_frames[frame] = image;
+    }
+  }
+}
+
+} // namespace app
@@ -0,0 +1,107 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_UI_EDITOR_FRAME_PREFETCHER_H_INCLUDED
+#define APP_UI_EDITOR_FRAME_PREFETCHER_H_INCLUDED
+#pragma once
+
+#include "app/doc_observer.h"
+#include "app/doc_undo_observer.h"
+#include "doc/frame.h"
+#include "doc/image_ref.h"
+#include "doc/playback.h"
+#include "doc/task_scheduler.h"
+#include "gfx/rect.h"
+#include "render/bg_options.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace app {
+
+class Doc;
+
+// Renders the next frames of an animation playback in a background
+// task so the editor can show them immediately when the playback
+// timer reaches them (even if rendering one frame takes more time
+// than its duration).
+//
+// Frames are rendered at 100% (no zoom) with the background, in the
+// same way the editor renders the sprite with the new render engine.
+// The cache is limited to the next frames of the playback and to a
+// maximum amount of memory, and it's cleared each time the document
+// is modified.
+class FramePrefetcher : public DocObserver,
+                        public DocUndoObserver {
+public:
+  // Render configuration of the prefetched frames. If the editor
+  // needs a different configuration, the cache is discarded.
+  struct Config {
+    render::BgOptions bg;
+    bool newBlend = true;
+    bool composeGroups = false;
+    gfx::Rect bounds; // Sprite area to render
+
+    bool operator==(const Config& other) const
+    {
+      return (bg == other.bg && newBlend == other.newBlend &&
+              composeGroups == other.composeGroups && bounds == other.bounds);
+    }
+    bool operator!=(const Config& other) const { return !operator==(other); }
+  };
+
+  static constexpr int kMaxFrames = 32;
+  static constexpr std::size_t kMaxMemSize = 256 * 1024 * 1024;
+
+  explicit FramePrefetcher(Doc* doc);
+  ~FramePrefetcher();
+
+  // Returns the rendered image of the given frame (an IMAGE_RGB
+  // image of config.bounds size) or nullptr if the frame is not
+  // ready yet. The config is used to render the next frames.
+  doc::ImageRef frameImage(const doc::frame_t frame, const Config& config);
+
+  // Must be called each time the playback goes to the next frame so
+  // we can start rendering the frames that will be needed soon.
+  void prefetch(const doc::Playback& playback);
+
+  // Discards all the rendered frames.
+  void invalidate();
+
+private:
+  // DocObserver impl
+  void onGeneralUpdate(DocEvent& ev) override;
+  void onColorSpaceChanged(DocEvent& ev) override;
+  void onPaletteChanged(DocEvent& ev) override;
+  void onSpritePixelsModified(DocEvent& ev) override;
+  void onAfterLayerVisibilityChange(DocEvent& ev) override;
+
+  // DocUndoObserver impl
+  void onCurrentUndoStateChange(DocUndo* history) override;
+
+  void onRenderFrames(doc::TaskScheduler::Token& token);
+
+  Doc* m_doc;
+  // Last execution of the rendering task (only accessed from the UI
+  // thread)
+  doc::TaskScheduler::TokenRef m_task;
+
+  // Protects all the following fields which are shared between the
+  // UI thread and the background task.
+  std::mutex m_mutex;
+  Config m_config;
+  bool m_hasConfig = false;
+  std::map<doc::frame_t, doc::ImageRef> m_frames;
+  std::vector<doc::frame_t> m_nextFrames;
+  // Incremented each time the cache is invalidated so the task can
+  // discard frames rendered with old document data.
+  int m_generation = 0;
+};
+
+} // namespace app
+
+#endif
@@ -43,11 +43,14 @@
 #include "doc/layer.h"
 #include "doc/mask.h"
 #include "doc/sprite.h"
+#include "doc/task_scheduler.h"
 #include "doc/util.h"
 #include "gfx/region.h"
 #include "render/render.h"
 
 #include <algorithm>
+#include <atomic>
+#include <vector>
 
 #if _DEBUG
   #define DUMP_INNER_CMDS() dumpInnerCmds()
@@ -57,6 +60,72 @@
 
 namespace app {
 
+namespace {
+
+// Maximum memory used by the images of the cels that are transformed
+// at the same time in PixelsMovement::stampCelsInParallel()
+constexpr std::size_t kMaxParallelStampMemSize = 256 * 1024 * 1024;
+
+// Transformed pixels to be stamped in one cel
+struct CelStamp {
+  Cel* cel = nullptr;
+  ImageRef originalImage;
+  ExtraCelRef extraCel;
+  gfx::Rect extraBounds;
+};
+
+// Renders the layer pixels in "dst" (the pixels that will be below
+// the transformed image).
+void render_layer_pixels(Image* dst,
+                         const Layer* layer,
+                         const frame_t frame,
+                         const gfx::Rect& bounds,
+                         const gfx::PointF& pt)
+{
+  render::Render render;
+  render.renderLayer(dst,
+                     layer,
+                     frame,
+                     gfx::Clip(bounds.x - pt.x, bounds.y - pt.y, bounds),
+                     BlendMode::SRC);
+}
+
+// Draws the "src" image transformed to the given corners. Returns
+// false if there is not enough memory to use RotSprite (in that case
+// the fast algorithm is used). It doesn't access the UI, so it can
+// be called from worker threads.
+bool draw_parallelogram(const tools::RotationAlgorithm rotAlgo,
+                        Image* dst,
+                        const Image* src,
+                        const Image* mask,
+                        const Transformation::Corners& corners,
+                        const gfx::PointF& leftTop)
+{
+  const int x1 = int(corners.leftTop().x - leftTop.x);
+  const int y1 = int(corners.leftTop().y - leftTop.y);
+  const int x2 = int(corners.rightTop().x - leftTop.x);
+  const int y2 = int(corners.rightTop().y - leftTop.y);
+  const int x3 = int(corners.rightBottom().x - leftTop.x);
+  const int y3 = int(corners.rightBottom().y - leftTop.y);
+  const int x4 = int(corners.leftBottom().x - leftTop.x);
+  const int y4 = int(corners.leftBottom().y - leftTop.y);
+
+  if (rotAlgo == tools::RotationAlgorithm::ROTSPRITE) {
+    try {
+      doc::algorithm::rotsprite_image(dst, src, mask, x1, y1, x2, y2, x3, y3, x4, y4);
+      return true;
+    }
+    catch (const std::bad_alloc&) {
+      // We can try with the fast algorithm anyway
+    }
+  }
+
+  doc::algorithm::parallelogram(dst, src, mask, x1, y1, x2, y2, x3, y3, x4, y4);
+  return (rotAlgo != tools::RotationAlgorithm::ROTSPRITE);
+}
+
+} // anonymous namespace
+
 PixelsMovement::InnerCmd::InnerCmd(InnerCmd&& c) : type(None)
 {
   std::swap(type, c.type);
@@ -902,48 +971,53 @@ void PixelsMovement::stampImage(bool finalStamp)
   const gfx::Size deltaB(currentAlignedBounds.x2() - initialAlignedBounds.x2(),
                          currentAlignedBounds.y2() - initialAlignedBounds.y2());
 
-  for (Cel* target : cels) {
-    // We'll re-create the transformation for the other cels
-    if (target != currentCel) {
-      ASSERT(target);
-      m_site.layer(target->layer());
-      m_site.frame(target->frame());
-      ASSERT(m_site.cel() == target);
-      Grid targetGrid(m_site.grid());
-      // Align masks and transformData before to 'reproduceAllTransformationsWithInnerCmds'
-      // Note: this alignement is needed only when the editor is on 'TilemapMode::Tiles',
-      // on the other hand 'TilemapMode::Pixels' do not require any additional
-      // mask/transformData adjustments.
-      if (originalSiteTilemapMode == TilemapMode::Tiles) {
-        if (target->layer()->isTilemap()) {
-          alignMasksAndTransformData(&initialMask0,
-                                     &initialMask,
-                                     &currentMask,
-                                     &initialData,
-                                     &currentData,
-                                     targetGrid,
-                                     deltaA,
-                                     deltaB);
-          m_site.tilemapMode(TilemapMode::Tiles);
+  if (finalStamp && canStampCelsInParallel(cels)) {
+    stampCelsInParallel(cels, currentCel);
+  }
+  else {
+    for (Cel* target : cels) {
+      // We'll re-create the transformation for the other cels
+      if (target != currentCel) {
+        ASSERT(target);
+        m_site.layer(target->layer());
+        m_site.frame(target->frame());
+        ASSERT(m_site.cel() == target);
+        Grid targetGrid(m_site.grid());
+        // Align masks and transformData before to 'reproduceAllTransformationsWithInnerCmds'
+        // Note: this alignement is needed only when the editor is on 'TilemapMode::Tiles',
+        // on the other hand 'TilemapMode::Pixels' do not require any additional
+        // mask/transformData adjustments.
+        if (originalSiteTilemapMode == TilemapMode::Tiles) {
+          if (target->layer()->isTilemap()) {
+            alignMasksAndTransformData(&initialMask0,
+                                       &initialMask,
+                                       &currentMask,
+                                       &initialData,
+                                       &currentData,
+                                       targetGrid,
+                                       deltaA,
+                                       deltaB);
+            m_site.tilemapMode(TilemapMode::Tiles);
+          }
+          else {
+            m_initialMask0->replace(initialMask0);
+            m_initialMask->replace(initialMask);
+            m_currentMask->replace(currentMask);
+            m_initialData.bounds(initialData.bounds());
+            m_currentData.bounds(currentData.bounds());
+            m_site.tilemapMode(TilemapMode::Pixels);
+          }
         }
         else {
-          m_initialMask0->replace(initialMask0);
-          m_initialMask->replace(initialMask);
-          m_currentMask->replace(currentMask);
-          m_initialData.bounds(initialData.bounds());
-          m_currentData.bounds(currentData.bounds());
           m_site.tilemapMode(TilemapMode::Pixels);
+          m_site.tilesetMode(TilesetMode::Auto);
         }
+        reproduceAllTransformationsWithInnerCmds();
       }
-      else {
-        m_site.tilemapMode(TilemapMode::Pixels);
-        m_site.tilesetMode(TilesetMode::Auto);
-      }
-      reproduceAllTransformationsWithInnerCmds();
-    }
 
-    redrawExtraImage();
-    stampExtraCelImage();
+      redrawExtraImage();
+      stampExtraCelImage();
+    }
   }
 
   m_initialMask0->replace(initialMask0);
@@ -963,6 +1037,125 @@ void PixelsMovement::stampImage(bool finalStamp)
   }
 }
 
+bool PixelsMovement::canStampCelsInParallel(const CelList& cels) const
+{
+  if (!m_parallelStamp || cels.size() < 2 || doc::TaskScheduler::instance().concurrency() < 2 ||
+      m_site.tilemapMode() == TilemapMode::Tiles ||
+      (m_tiledModeHelper && m_tiledModeHelper->tiledEnabled())) {
+    return false;
+  }
+
+  // Stamp commands modify the cel in the middle of the inner
+  // commands, so the cel cannot be drawn after reproducing them.
+  for (const InnerCmd& c : m_innerCmds) {
+    if (c.type == InnerCmd::Stamp)
+      return false;
+  }
+
+  // Clearing a tilemap in pixels mode can modify a tileset that is
+  // used in other cels, so each cel must be drawn after the previous
+  // one is stamped.
+  for (const Cel* cel : cels) {
+    if (!cel || !cel->layer()->isImage() || cel->layer()->isTilemap())
+      return false;
+  }
+  return true;
+}
+
+// Stamps the current transformation in all the given cels. The inner
+// commands are reproduced in each cel (in order) and the transformed
+// pixels of the cels (e.g. RotSprite) are drawn in worker threads at
+// the same time. Then the cels are stamped in the same order, so the
+// undo history is the same as stamping cel by cel.
+void PixelsMovement::stampCelsInParallel(const CelList& cels, Cel* currentCel)
+{
+  const tools::RotationAlgorithm rotAlgo = rotationAlgorithm(m_currentData);
+  const auto corners = m_currentData.transformedCorners();
+  const gfx::Rect bounds = corners.bounds(m_currentData.cornerThick());
+  const color_t transparentColor = m_site.sprite()->transparentColor();
+  const color_t maskColor = originalImageMaskColor(true);
+
+  const ExtraCelRef extraCel = m_extraCel;
+  std::vector<CelStamp> stamps;
+  std::size_t stampsMemSize = 0;
+  std::atomic<bool> notEnoughMemory(false);
+
+  auto drawAndStampCels = [&]() {
+    if (stamps.empty())
+      return;
+
+    // RotSprite uses temporary images 8x8 times bigger than the
+    // source/destination images in each thread
+    doc::TaskScheduler& scheduler = doc::TaskScheduler::instance();
+    int nthreads = std::clamp(scheduler.concurrency(), 1, int(stamps.size()));
+    if (rotAlgo == tools::RotationAlgorithm::ROTSPRITE) {
+      const std::size_t rotSpriteMemSize = std::size_t(64) * 3 *
+                                           stamps[0].originalImage->getMemSize();
+      const int maxThreads = int(kMaxParallelStampMemSize /
+                                 std::max<std::size_t>(1, rotSpriteMemSize));
+      nthreads = std::clamp(maxThreads, 1, nthreads);
+    }
+
+    const Image* maskBitmap = m_initialMask->bitmap();
+    scheduler.parallelFor(
+      int(stamps.size()),
+      [&](const int i) {
+        CelStamp& stamp = stamps[i];
+        Image* dst = stamp.extraCel->image();
+        const gfx::PointF pt(stamp.extraBounds.origin());
+
+        dst->setMaskColor(transparentColor);
+        dst->clear(transparentColor);
+        render_layer_pixels(dst, stamp.cel->layer(), stamp.cel->frame(), bounds, pt);
+
+        stamp.originalImage->setMaskColor(maskColor);
+        if (!draw_parallelogram(rotAlgo, dst, stamp.originalImage.get(), maskBitmap, corners, pt))
+          notEnoughMemory = true;
+      },
+      nthreads);
+
+    for (CelStamp& stamp : stamps) {
+      m_site.layer(stamp.cel->layer());
+      m_site.frame(stamp.cel->frame());
+      m_extraCel = stamp.extraCel;
+      stampExtraCelImage();
+    }
+    stamps.clear();
+    stampsMemSize = 0;
+  };
+
+  for (Cel* cel : cels) {
+    if (cel != currentCel) {
+      m_site.layer(cel->layer());
+      m_site.frame(cel->frame());
+      m_site.tilemapMode(TilemapMode::Pixels);
+      m_site.tilesetMode(TilesetMode::Auto);
+      reproduceInnerCmds();
+    }
+
+    CelStamp stamp;
+    stamp.cel = cel;
+    stamp.originalImage = m_originalImage;
+    stamp.extraCel = std::make_shared<ExtraCel>();
+    stamp.extraBounds = createExtraCel(stamp.extraCel.get(), m_currentData.transformedBounds());
+    if (!stamp.extraCel->image())
+      continue;
+
+    stampsMemSize += stamp.originalImage->getMemSize() + stamp.extraCel->image()->getMemSize();
+    stamps.push_back(std::move(stamp));
+
+    if (stampsMemSize >= kMaxParallelStampMemSize)
+      drawAndStampCels();
+  }
+  drawAndStampCels();
+
+  m_extraCel = extraCel;
+  updateDocumentMask();
+
+  if (notEnoughMemory)
+    StatusBar::instance()->showTip(1000, Strings::statusbar_tips_not_enough_rotsprite_memory());
+}
+
 void PixelsMovement::stampExtraCelImage()
 {
   const Image* image = m_extraCel->image();
@@ -1120,12 +1313,6 @@ void PixelsMovement::redrawExtraImage(Transformation* transformation)
   if (!transformation)
     transformation = &m_currentData;
 
-  int t, opacity =
-           (m_site.layer()->isImage() ? static_cast<LayerImage*>(m_site.layer())->opacity() : 255);
-  Cel* cel = m_site.cel();
-  if (cel)
-    opacity = MUL_UN8(opacity, cel->opacity(), t);
-
   if (!m_extraCel)
     m_extraCel.reset(new ExtraCel);
 
@@ -1146,6 +1333,27 @@ void PixelsMovement::redrawExtraImage(Transformation* transformation)
     bounds = transformation->transformedBounds();
   }
 
+  bounds = createExtraCel(m_extraCel.get(), bounds);
+  m_document->setExtraCel(m_extraCel);
+
+  if (m_extraCel->image()) {
+    // Draw the transformed pixels in the extra-cel which is the chunk
+    // of pixels that the user is moving.
+    drawImage(*transformation, m_extraCel->image(), gfx::PointF(bounds.origin()), true);
+  }
+}
+
+// Creates the extra cel to draw the transformed pixels of the active
+// m_site in the given bounds. Returns the bounds of the extra cel
+// (aligned to the grid in tiles mode).
+gfx::Rect PixelsMovement::createExtraCel(ExtraCel* extraCel, gfx::Rect bounds)
+{
+  int t, opacity =
+           (m_site.layer()->isImage() ? static_cast<LayerImage*>(m_site.layer())->opacity() : 255);
+  Cel* cel = m_site.cel();
+  if (cel)
+    opacity = MUL_UN8(opacity, cel->opacity(), t);
+
   if (!bounds.isEmpty()) {
     gfx::Size extraCelSize;
     if (m_site.tilemapMode() == TilemapMode::Tiles) {
@@ -1158,28 +1366,22 @@ void PixelsMovement::redrawExtraImage(Transformation* transformation)
       extraCelSize = bounds.size();
     }
 
-    m_extraCel->create(ExtraCel::Purpose::TransformationPreview,
-                       m_site.tilemapMode(),
-                       m_document->sprite(),
-                       bounds,
-                       extraCelSize,
-                       m_site.frame(),
-                       opacity);
-    m_extraCel->setType(render::ExtraType::PATCH);
-    m_extraCel->setBlendMode(m_site.layer()->isImage() ?
-                               static_cast<LayerImage*>(m_site.layer())->blendMode() :
-                               BlendMode::NORMAL);
+    extraCel->create(ExtraCel::Purpose::TransformationPreview,
+                     m_site.tilemapMode(),
+                     m_document->sprite(),
+                     bounds,
+                     extraCelSize,
+                     m_site.frame(),
+                     opacity);
+    extraCel->setType(render::ExtraType::PATCH);
+    extraCel->setBlendMode(m_site.layer()->isImage() ?
+                             static_cast<LayerImage*>(m_site.layer())->blendMode() :
+                             BlendMode::NORMAL);
   }
   else
-    m_extraCel->reset();
-
-  m_document->setExtraCel(m_extraCel);
+    extraCel->reset();
 
-  if (m_extraCel->image()) {
-    // Draw the transformed pixels in the extra-cel which is the chunk
-    // of pixels that the user is moving.
-    drawImage(*transformation, m_extraCel->image(), gfx::PointF(bounds.origin()), true);
-  }
+  return bounds;
 }
 
 void PixelsMovement::redrawCurrentMask()
@@ -1220,28 +1422,10 @@ void PixelsMovement::drawImage(const Transformation& transformation,
     dst->setMaskColor(m_site.sprite()->transparentColor());
     dst->clear(dst->maskColor());
 
-    if (renderOriginalLayer) {
-      render::Render render;
-      render.renderLayer(dst,
-                         m_site.layer(),
-                         m_site.frame(),
-                         gfx::Clip(bounds.x - pt.x, bounds.y - pt.y, bounds),
-                         BlendMode::SRC);
-    }
-
-    color_t maskColor = m_maskColor;
+    if (renderOriginalLayer)
+      render_layer_pixels(dst, m_site.layer(), m_site.frame(), bounds, pt);
 
-    // In case that Opaque option is enabled, or if we are drawing the
-    // image for the clipboard (renderOriginalLayer is false), we use a
-    // dummy mask color to call drawParallelogram(). In this way all
-    // pixels will be opaqued (all colors are copied)
-    if (m_opaque || !renderOriginalLayer) {
-      if (m_originalImage->pixelFormat() == IMAGE_INDEXED)
-        maskColor = -1;
-      else
-        maskColor = 0;
-    }
-    m_originalImage->setMaskColor(maskColor);
+    m_originalImage->setMaskColor(originalImageMaskColor(renderOriginalLayer));
 
     drawParallelogram(transformation, dst, m_originalImage.get(), m_initialMask.get(), corners, pt);
 
@@ -1275,12 +1459,22 @@ void PixelsMovement::drawMask(doc::Mask* mask, bool shrink)
     mask->unfreeze();
 }
 
-void PixelsMovement::drawParallelogram(const Transformation& transformation,
-                                       doc::Image* dst,
-                                       const doc::Image* src,
-                                       const doc::Mask* mask,
-                                       const Transformation::Corners& corners,
-                                       const gfx::PointF& leftTop)
+color_t PixelsMovement::originalImageMaskColor(const bool renderOriginalLayer) const
+{
+  // In case that Opaque option is enabled, or if we are drawing the
+  // image for the clipboard (renderOriginalLayer is false), we use a
+  // dummy mask color to call drawParallelogram(). In this way all
+  // pixels will be opaqued (all colors are copied)
+  if (m_opaque || !renderOriginalLayer) {
+    if (m_originalImage->pixelFormat() == IMAGE_INDEXED)
+      return -1;
+    else
+      return 0;
+  }
+  return m_maskColor;
+}
+
+tools::RotationAlgorithm PixelsMovement::rotationAlgorithm(const Transformation& transformation)
 {
   tools::RotationAlgorithm rotAlgo = Preferences::instance().selection.rotationAlgorithm();
 
@@ -1301,45 +1495,23 @@ void PixelsMovement::drawParallelogram(const Transformation& transformation,
     rotAlgo = tools::RotationAlgorithm::FAST;
   }
 
-retry:; // In case that we don't have enough memory for RotSprite
-        // we can try with the fast algorithm anyway.
-
-  switch (rotAlgo) {
-    case tools::RotationAlgorithm::FAST:
-      doc::algorithm::parallelogram(dst,
-                                    src,
-                                    (mask ? mask->bitmap() : nullptr),
-                                    int(corners.leftTop().x - leftTop.x),
-                                    int(corners.leftTop().y - leftTop.y),
-                                    int(corners.rightTop().x - leftTop.x),
-                                    int(corners.rightTop().y - leftTop.y),
-                                    int(corners.rightBottom().x - leftTop.x),
-                                    int(corners.rightBottom().y - leftTop.y),
-                                    int(corners.leftBottom().x - leftTop.x),
-                                    int(corners.leftBottom().y - leftTop.y));
-      break;
-
-    case tools::RotationAlgorithm::ROTSPRITE:
-      try {
-        doc::algorithm::rotsprite_image(dst,
-                                        src,
-                                        (mask ? mask->bitmap() : nullptr),
-                                        int(corners.leftTop().x - leftTop.x),
-                                        int(corners.leftTop().y - leftTop.y),
-                                        int(corners.rightTop().x - leftTop.x),
-                                        int(corners.rightTop().y - leftTop.y),
-                                        int(corners.rightBottom().x - leftTop.x),
-                                        int(corners.rightBottom().y - leftTop.y),
-                                        int(corners.leftBottom().x - leftTop.x),
-                                        int(corners.leftBottom().y - leftTop.y));
-      }
-      catch (const std::bad_alloc&) {
-        StatusBar::instance()->showTip(1000, Strings::statusbar_tips_not_enough_rotsprite_memory());
+  return rotAlgo;
+}
 
-        rotAlgo = tools::RotationAlgorithm::FAST;
-        goto retry;
-      }
-      break;
+void PixelsMovement::drawParallelogram(const Transformation& transformation,
+                                       doc::Image* dst,
+                                       const doc::Image* src,
+                                       const doc::Mask* mask,
+                                       const Transformation::Corners& corners,
+                                       const gfx::PointF& leftTop)
+{
+  if (!draw_parallelogram(rotationAlgorithm(transformation),
+                          dst,
+                          src,
+                          (mask ? mask->bitmap() : nullptr),
+                          corners,
+                          leftTop)) {
+    StatusBar::instance()->showTip(1000, Strings::statusbar_tips_not_enough_rotsprite_memory());
   }
 }
 
@@ -1551,6 +1723,17 @@ void PixelsMovement::reproduceAllTransformationsWithInnerCmds()
             m_site.frame());
   DUMP_INNER_CMDS();
 
+  reproduceInnerCmds();
+
+  redrawExtraImage();
+  redrawCurrentMask();
+  updateDocumentMask();
+}
+
+// Re-creates the original image from the cel of the active m_site and
+// reproduces the inner commands in it.
+void PixelsMovement::reproduceInnerCmds()
+{
   m_document->setMask(m_initialMask0.get());
   m_initialMask->copyFrom(m_initialMask0.get());
   if (m_site.layer()->isTilemap() && m_site.tilemapMode() == TilemapMode::Tiles) {
@@ -1576,10 +1759,6 @@ void PixelsMovement::reproduceAllTransformationsWithInnerCmds()
         break;
     }
   }
-
-  redrawExtraImage();
-  redrawCurrentMask();
-  updateDocumentMask();
 }
 
 #if _DEBUG
@@ -12,6 +12,7 @@
 #include "app/context_access.h"
 #include "app/extra_cel.h"
 #include "app/site.h"
+#include "app/tools/rotation_algorithm.h"
 #include "app/transformation.h"
 #include "app/tx.h"
 #include "app/ui/editor/handle_type.h"
@@ -87,6 +88,11 @@ public:
   void setDelegate(PixelsMovementDelegate* delegate);
   void setFastMode(const bool fastMode);
 
+  // Enables/disables stamping several cels at the same time in
+  // dropImage() (it's enabled by default, can be disabled to compare
+  // the result with the sequential path).
+  void setParallelStamp(const bool parallelStamp) { m_parallelStamp = parallelStamp; }
+
   void trim();
   void cutMask();
   void copyMask();
@@ -138,16 +144,21 @@ private:
   void adjustPivot();
   bool editMultipleCels() const;
   void stampImage(bool finalStamp);
+  bool canStampCelsInParallel(const CelList& cels) const;
+  void stampCelsInParallel(const CelList& cels, Cel* currentCel);
   void stampExtraCelImage();
   void onPivotChange();
   void onRotationAlgorithmChange();
   void redrawExtraImage(Transformation* transformation = nullptr);
+  gfx::Rect createExtraCel(ExtraCel* extraCel, gfx::Rect bounds);
   void redrawCurrentMask();
   void drawImage(const Transformation& transformation,
                  doc::Image* dst,
                  const gfx::PointF& pt,
                  const bool renderOriginalLayer);
   void drawMask(doc::Mask* dst, bool shrink);
+  color_t originalImageMaskColor(const bool renderOriginalLayer) const;
+  tools::RotationAlgorithm rotationAlgorithm(const Transformation& transformation);
   void drawParallelogram(const Transformation& transformation,
                          doc::Image* dst,
                          const doc::Image* src,
@@ -165,6 +176,7 @@ private:
   void shiftOriginalImage(const int dx, const int dy, const double angle);
   CelList getEditableCels();
   void reproduceAllTransformationsWithInnerCmds();
+  void reproduceInnerCmds();
 
   void alignMasksAndTransformData(const Mask* initialMask0,
                                   const Mask* initialMask,
@@ -206,6 +218,7 @@ private:
   // avoiding RotSprite on each mouse movement.
   bool m_fastMode;
   bool m_needsRotSpriteRedraw;
+  bool m_parallelStamp = true;
 
   // Commands used in the interaction with the transformed pixels.
   // This is used to re-create the whole interaction on each
@@ -0,0 +1,158 @@
+// Aseprite
+// Copyright (C) 2026  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#define TEST_APP
+#include "tests/app_test.h"
+
+#include "app/doc.h"
+#include "app/doc_undo.h"
+#include "app/pref/preferences.h"
+#include "app/test_context.h"
+#include "app/ui/editor/pixels_movement.h"
+#include "app/util/new_image_from_mask.h"
+#include "doc/doc.h"
+
+using namespace app;
+using namespace doc;
+
+typedef std::unique_ptr<Doc> DocPtr;
+
+// Creates a sprite with 3 layers and 2 frames, where the cel in
+// (layer 2, frame 1) is linked to the cel in (layer 2, frame 0).
+static Doc* make_doc(Context& ctx)
+{
+  Doc* doc = ctx.documents().add(16, 16);
+  Sprite* sprite = doc->sprite();
+  sprite->setTotalFrames(frame_t(2));
+
+  LayerImage* layers[3];
+  layers[0] = static_cast<LayerImage*>(sprite->root()->firstLayer());
+  for (int l = 1; l < 3; ++l) {
+    layers[l] = new LayerImage(sprite);
+    sprite->root()->addLayer(layers[l]);
+  }
+
+  for (int l = 0; l < 3; ++l) {
+    for (frame_t f = 0; f < 2; ++f) {
+      if (l == 1 && f == 1) {
+        layers[l]->addCel(Cel::MakeLink(f, layers[l]->cel(0)));
+        continue;
+      }
+
+      Cel* cel = layers[l]->cel(f);
+      if (!cel) {
+        ImageRef image(Image::create(IMAGE_RGB, 12, 10));
+        cel = new Cel(f, image);
+        cel->setPosition(l + f, 2 * l);
+        layers[l]->addCel(cel);
+      }
+
+      Image* image = cel->image();
+      for (int y = 0; y < image->height(); ++y) {
+        for (int x = 0; x < image->width(); ++x) {
+          put_pixel(image,
+                    x,
+                    y,
+                    ((x + y + l) % 5) == 0 ?
+                      rgba(0, 0, 0, 0) :
+                      rgba(16 * x, 16 * y, 64 * l + 32 * f, 255));
+        }
+      }
+    }
+  }
+
+  Mask mask;
+  mask.replace(gfx::Rect(2, 3, 9, 7));
+  doc->setMask(&mask);
+  return doc;
+}
+
+// Cuts the selection of all cels (the active cel is the linked one),
+// transforms it with inner commands (flip/shift) and a
+// move/rotation, and stamps it in all the cels.
+static void transform_cels(Context& ctx, Doc* doc, const bool parallelStamp)
+{
+  const LayerList layers = doc->sprite()->allLayers();
+
+  Site site = ctx.activeSite();
+  site.layer(layers[1]);
+  site.frame(1);
+
+  view::RealRange range;
+  range.startRange(layers[0], 0, view::Range::kCels);
+  range.endRange(layers[2], 1);
+  site.range(range);
+
+  ImageRef image(new_image_from_mask(site, Preferences::instance().experimental.newBlend()));
+  PixelsMovement pixelsMovement(&ctx, site, image.get(), doc->mask(), "Transformation");
+  pixelsMovement.setParallelStamp(parallelStamp);
+  pixelsMovement.cutMask();
+  pixelsMovement.flipImage(doc::algorithm::FlipType::FlipHorizontal);
+  pixelsMovement.shift(2, 1);
+  pixelsMovement.catchImage(gfx::PointF(5, 5), MovePixelsHandle);
+  pixelsMovement.moveImage(gfx::PointF(8, 6), PixelsMovement::NormalMovement);
+  pixelsMovement.rotate(30.0);
+  pixelsMovement.dropImage();
+}
+
+static void expect_same_sprite(const Doc* a, const Doc* b)
+{
+  const LayerList layersA = a->sprite()->allLayers();
+  const LayerList layersB = b->sprite()->allLayers();
+  ASSERT_EQ(layersA.size(), layersB.size());
+
+  for (std::size_t l = 0; l < layersA.size(); ++l) {
+    for (frame_t f = 0; f < a->sprite()->totalFrames(); ++f) {
+      const Cel* celA = layersA[l]->cel(f);
+      const Cel* celB = layersB[l]->cel(f);
+      ASSERT_EQ(celA == nullptr, celB == nullptr);
+      if (!celA)
+        continue;
+
+      EXPECT_EQ(celA->position().x, celB->position().x);
+      EXPECT_EQ(celA->position().y, celB->position().y);
+      EXPECT_EQ(celA->link() == nullptr, celB->link() == nullptr);
+      EXPECT_EQ(0, count_diff_between_images(celA->image(), celB->image()))
+        << "Different pixels in layer " << l << " frame " << f;
+    }
+  }
+
+  EXPECT_EQ(a->mask()->bounds(), b->mask()->bounds());
+}
+
+TEST(PixelsMovement, ParallelStampMatchesSequentialStamp)
+{
+  TestContext origCtx, seqCtx, parCtx;
+  DocPtr orig(make_doc(origCtx));
+  DocPtr seq(make_doc(seqCtx));
+  DocPtr par(make_doc(parCtx));
+  expect_same_sprite(seq.get(), par.get());
+
+  transform_cels(seqCtx, seq.get(), false);
+  transform_cels(parCtx, par.get(), true);
+  expect_same_sprite(seq.get(), par.get());
+
+  // The cut pixels were moved, so the cels cannot be the original ones
+  const Cel* seqCel = seq->sprite()->allLayers()[0]->cel(0);
+  const Cel* origCel = orig->sprite()->allLayers()[0]->cel(0);
+  EXPECT_NE(0, count_diff_between_images(seqCel->image(), origCel->image()));
+
+  // Both paths create one undoable transformation
+  for (Doc* doc : { seq.get(), par.get() }) {
+    ASSERT_TRUE(doc->undoHistory()->canUndo());
+    doc->undoHistory()->undo();
+    EXPECT_FALSE(doc->undoHistory()->canUndo());
+    expect_same_sprite(orig.get(), doc);
+  }
+
+  seq->undoHistory()->redo();
+  par->undoHistory()->redo();
+  expect_same_sprite(seq.get(), par.get());
+
+  orig->close();
+  seq->close();
+  par->close();
+}
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2020-2023  Igara Studio S.A.
+// Copyright (C) 2020-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -18,6 +18,7 @@
 #include "app/tools/ink.h"
 #include "app/ui/editor/editor.h"
 #include "app/ui/editor/editor_customization_delegate.h"
+#include "app/ui/editor/frame_prefetcher.h"
 #include "app/ui/editor/scrolling_state.h"
 #include "app/ui/skin/skin_theme.h"
 #include "app/ui_context.h"
@@ -50,6 +51,10 @@ PlayState::PlayState(const bool playOnce, const bool playAll, const bool playSub
     this);
 }
 
+PlayState::~PlayState()
+{
+}
+
 Tag* PlayState::playingTag() const
 {
   return m_tag;
@@ -109,6 +114,8 @@ void PlayState::onEnterState(Editor* editor)
     m_nextFrameTime = getNextFrameTime();
     m_curFrameTick = base::current_tick();
     m_playTimer.start();
+
+    m_prefetcher = std::make_unique<FramePrefetcher>(m_editor->document());
   }
 }
 
@@ -118,6 +125,7 @@ EditorState::LeaveAction PlayState::onLeaveState(Editor* editor, EditorState* ne
   // (we keep playing the animation).
   if (!m_toScroll) {
     m_playTimer.stop();
+    m_prefetcher.reset();
 
     if (m_playOnce || Preferences::instance().general.rewindOnStop())
       m_editor->setFrame(m_refFrame);
@@ -226,6 +234,9 @@ void PlayState::onPlaybackTick()
     m_nextFrameTime += getNextFrameTime();
   }
 
+  if (m_prefetcher)
+    m_prefetcher->prefetch(m_playback);
+
   m_curFrameTick = base::current_tick();
 }
 
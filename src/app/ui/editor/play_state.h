@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2020-2022  Igara Studio S.A.
+// Copyright (C) 2020-2026  Igara Studio S.A.
 // Copyright (C) 2001-2017  David Capello
 //
 // This program is distributed under the terms of
@@ -16,6 +16,8 @@
 #include "obs/connection.h"
 #include "ui/timer.h"
 
+#include <memory>
+
 namespace doc {
 class Tag;
 }
@@ -23,10 +25,12 @@ class Tag;
 namespace app {
 
 class CommandExecutionEvent;
+class FramePrefetcher;
 
 class PlayState : public StateWithWheelBehavior {
 public:
   PlayState(const bool playOnce, const bool playAll, const bool playSubtags);
+  ~PlayState();
 
   doc::Tag* playingTag() const;
 
@@ -40,6 +44,7 @@ public:
   bool onKeyUp(Editor* editor, ui::KeyMessage* msg) override;
   bool onSetCursor(Editor* editor, const gfx::Point& mouseScreenPos) override;
   void onRemoveTag(Editor* editor, doc::Tag* tag) override;
+  FramePrefetcher* getFramePrefetcher() override { return m_prefetcher.get(); }
 
 private:
   void onPlaybackTick();
@@ -66,6 +71,9 @@ private:
   doc::Tag* m_tag;
 
   obs::scoped_connection m_ctxConn;
+
+  // Renders the next frames in a background thread.
+  std::unique_ptr<FramePrefetcher> m_prefetcher;
 };
 
 } // namespace app
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2025  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -752,6 +752,11 @@ public:
   {
     m_expandCelCanvas->copyValidDestToSourceCanvas(rgn);
   }
+  void updateDirtyArea(const gfx::Region& dirtyArea) override
+  {
+    m_expandCelCanvas->notifyDestCanvasModified();
+    PaintToolLoopBase::updateDirtyArea(dirtyArea);
+  }
 
   bool useMask() override { return m_useMask; }
   bool getFilled() override { return m_filled; }
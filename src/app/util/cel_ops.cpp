@@ -450,6 +450,13 @@ Cel* create_cel_copy(CmdSequence* cmds,
                                  srcCel->layer()->isBackground(),
                                  dstSprite->transparentColor());
   }
+  // Copy of a uniform image (e.g. a background cel), we don't need
+  // to create its pixels
+  else if (srcImage->isUniform()) {
+    dstCel->data()->setImage(
+      ImageRef(Image::createUniform(dstCel->image()->spec(), srcImage->uniformColor())),
+      dstLayer);
+  }
   // Simple case, where we copy both images
   else {
     render::composite_image(dstCel->image(),
@@ -867,6 +874,8 @@ void modify_tilemap_cel_region(CmdSequence* cmds,
         }
         else {
           copy_image(tileDstImage.get(), tileImage.get(), tileRgn);
+          tileDstImage->incrementVersion();
+          tileset->incrementVersion();
           tileset->notifyTileContentChange(ti);
         }
       }
@@ -639,6 +639,9 @@ void ExpandCelCanvas::validateDestCanvas(const gfx::Region& rgn)
       fill_rect(m_dstImage.get(), rc, m_dstImage->maskColor());
   }
 
+  if (!rgnToValidate.isEmpty())
+    m_dstImage->incrementVersion();
+
   m_validDstRegion.createUnion(m_validDstRegion, rgnToValidate);
 }
 
@@ -682,6 +685,12 @@ void ExpandCelCanvas::invalidateDestCanvas(const gfx::Region& rgn)
   m_validDstRegion.createSubtraction(m_validDstRegion, rgnToInvalidate);
 }
 
+void ExpandCelCanvas::notifyDestCanvasModified()
+{
+  if (m_dstImage)
+    m_dstImage->incrementVersion();
+}
+
 void ExpandCelCanvas::copyValidDestToSourceCanvas(const gfx::Region& rgn)
 {
   EXP_TRACE("ExpandCelCanvas::copyValidDestToSourceCanvas", rgn.bounds());
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2025  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -91,6 +91,10 @@ public:
   void invalidateDestCanvas(const gfx::Region& rgn);
   void copyValidDestToSourceCanvas(const gfx::Region& rgn);
 
+  // Must be called each time pixels of getDestCanvas() are modified
+  // so caches of the image (e.g. mipmaps) are invalidated.
+  void notifyDestCanvasModified();
+
   const Cel* getCel() const { return m_cel; }
   const doc::Grid& getGrid() const { return m_grid; }
 
@@ -18,6 +18,7 @@
 #include "base/mask_shift.h"
 #include "base/scoped_value.h"
 #include "dio/aseprite_common.h"
+#include "dio/aseprite_lazy_cels.h"
 #include "dio/decode_delegate.h"
 #include "dio/file_interface.h"
 #include "dio/pixel_io.h"
@@ -55,6 +56,21 @@ bool AsepriteDecoder::decode()
     return false;
   }
 
+  // Use the embedded preview (if there is one) to avoid decoding all
+  // the layers/cels of the first frame.
+  if (delegate()->decodePreview()) {
+    std::unique_ptr<Sprite> preview(readPreviewSprite(&header));
+    if (preview) {
+      delegate()->onSprite(preview.release());
+      return true;
+    }
+  }
+
+  // Load cel pixels on demand
+  const std::string lazyCelsFilename = delegate()->lazyCelsFilename();
+  if (!lazyCelsFilename.empty())
+    m_lazyCels = std::make_shared<AsepriteLazyCels>(lazyCelsFilename, header);
+
   // Create the new sprite
   std::unique_ptr<Sprite> sprite(
     std::make_unique<Sprite>(ImageSpec(header.depth == 32 ? ColorMode::RGB :
@@ -207,6 +223,7 @@ bool AsepriteDecoder::decode()
           }
 
           case ASE_FILE_CHUNK_PATH:
+          case ASE_FILE_CHUNK_PREVIEW:
             // Ignore
             break;
 
@@ -805,6 +822,70 @@ void read_compressed_image(FileInterface* f,
 
 } // anonymous namespace
 
+//////////////////////////////////////////////////////////////////////
+// Preview Chunk
+//////////////////////////////////////////////////////////////////////
+
+Sprite* AsepriteDecoder::readPreviewSprite(const AsepriteHeader* header)
+{
+  const size_t frame_pos = tell();
+
+  AsepriteFrameHeader frame_header;
+  readFrameHeader(&frame_header);
+
+  if (frame_header.magic == ASE_FILE_FRAME_MAGIC) {
+    for (uint32_t c = 0; c < frame_header.chunks; c++) {
+      const size_t chunk_pos = tell();
+      const int chunk_size = read32();
+      const int chunk_type = read16();
+
+      if (chunk_type == ASE_FILE_CHUNK_PREVIEW) {
+        const int w = read16();
+        const int h = read16();
+        read32(); // Flags
+        readPadding(8);
+
+        if (w < 1 || h < 1)
+          break;
+
+        const ImageRef image(Image::create(IMAGE_RGB, w, h));
+        read_compressed_image(f(), delegate(), image.get(), header, chunk_pos + chunk_size);
+
+        auto sprite = std::make_unique<Sprite>(ImageSpec(ColorMode::RGB, w, h), 256);
+        sprite->setTotalFrames(frame_t(1));
+        sprite->setFrameDuration(0, frame_header.duration > 0 ? frame_header.duration :
+                                                                 header->speed);
+
+        auto layer = new LayerImage(sprite.get());
+        sprite->root()->addLayer(layer);
+        layer->addCel(new Cel(0, image));
+        return sprite.release();
+      }
+
+      // Stop at the first chunk with data of the sprite, the preview
+      // is always saved before them.
+      if (chunk_type == ASE_FILE_CHUNK_LAYER || chunk_type == ASE_FILE_CHUNK_CEL ||
+          chunk_size < 6)
+        break;
+
+      seek(chunk_pos + chunk_size);
+    }
+  }
+
+  // Go back to the first frame to decode the whole file
+  seek(frame_pos);
+  return nullptr;
+}
+
+void AsepriteDecoder::readCompressedPixels(Image* image,
+                                           const AsepriteHeader* header,
+                                           const size_t pos,
+                                           const size_t chunk_end)
+{
+  seek(pos);
+  read_compressed_image(f(), delegate(), image, header, chunk_end);
+}
+
 //////////////////////////////////////////////////////////////////////
 // Cel Chunk
 //////////////////////////////////////////////////////////////////////
@@ -897,8 +978,20 @@ Cel* AsepriteDecoder::readCelChunk(frame_t frame,
       int h = read16();
 
       if (w > 0 && h > 0) {
-        const ImageRef image(Image::create(pixelFormat, w, h));
-        read_compressed_image(f(), delegate(), image.get(), header, chunk_end);
+        ImageRef image;
+        if (m_lazyCels && w * h >= AsepriteLazyCels::kMinPixels) {
+          // The compressed pixels will be decoded from the file later
+          const size_t pos = tell();
+          image = m_lazyCels->createImage(pixelFormat,
+                                          w,
+                                          h,
+                                          pos,
+                                          chunk_end > pos ? chunk_end - pos : 0);
+        }
+        else {
+          image.reset(Image::create(pixelFormat, w, h));
+          read_compressed_image(f(), delegate(), image.get(), header, chunk_end);
+        }
 
         cel = std::make_unique<Cel>(frame, image);
         cel->setPosition(x, y);
@@ -20,11 +20,13 @@
 #include "doc/tileset.h"
 #include "doc/user_data.h"
 
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace doc {
 class Cel;
+class Image;
 class Layer;
 class Layer;
 class Mask;
@@ -35,14 +37,28 @@ class UserData;
 
 namespace dio {
 
+class AsepriteLazyCels;
+
 class AsepriteDecoder : public Decoder {
 public:
   bool decode() override;
   int celType() const { return m_celType; }
 
+  // Cels which pixels will be loaded on demand (only if
+  // DecodeDelegate::lazyCelsFilename() isn't empty).
+  const std::shared_ptr<AsepriteLazyCels>& lazyCels() const { return m_lazyCels; }
+
+  // Reads the compressed pixels of a cel in the given range of the
+  // file (used to load lazy cels).
+  void readCompressedPixels(doc::Image* image,
+                            const AsepriteHeader* header,
+                            size_t pos,
+                            size_t chunk_end);
+
 private:
   bool readHeader(AsepriteHeader* header);
   void readFrameHeader(AsepriteFrameHeader* frame_header);
+  doc::Sprite* readPreviewSprite(const AsepriteHeader* header);
   void readPadding(const int bytes);
   std::string readString();
   float readFloat();
@@ -78,6 +94,7 @@ private:
   doc::LayerList m_allLayers;
   std::vector<uint32_t> m_tilesetFlags;
   int m_celType = ASE_FILE_COMPRESSED_CEL;
+  std::shared_ptr<AsepriteLazyCels> m_lazyCels;
 };
 
 } // namespace dio
@@ -60,6 +60,10 @@ bool AsepriteEncoder::encode()
     frame_header.duration = sprite->frameDuration(frame);
 
     if (outputFrame == 0) {
+      // Preview image as the first chunk so it can be read quickly
+      if (const Image* preview = delegate()->previewImage())
+        writePreviewChunk(&frame_header, preview);
+
       // Check if we need the "external files" chunk
       writeExternalFilesChunk(&frame_header, ext_files, sprite);
 
@@ -482,12 +486,25 @@ public:
 
 class ImageScanlines : public ScanlinesGen {
   const Image* m_image;
+  // Only one row of pixels to save uniform images
+  ImageRef m_uniformRow;
 
 public:
-  ImageScanlines(const Image* image) : m_image(image) {}
+  ImageScanlines(const Image* image) : m_image(image)
+  {
+    if (image->isUniform()) {
+      m_uniformRow.reset(Image::create(image->pixelFormat(), image->width(), 1));
+      m_uniformRow->clear(image->uniformColor());
+    }
+  }
   gfx::Size getImageSize() const override { return gfx::Size(m_image->width(), m_image->height()); }
   int getScanlineSize() const override { return m_image->widthBytes(); }
-  const uint8_t* getScanlineAddress(int y) const override { return m_image->getPixelAddress(0, y); }
+  const uint8_t* getScanlineAddress(int y) const override
+  {
+    if (m_uniformRow)
+      return m_uniformRow->getPixelAddress(0, 0);
+    return m_image->getPixelAddress(0, y);
+  }
 };
 
 class TilesetScanlines : public ScanlinesGen {
@@ -636,6 +653,24 @@ void write_compressed_image(FileInterface* f,
 
 } // anonymous namespace
 
+//////////////////////////////////////////////////////////////////////
+// Preview Chunk
+//////////////////////////////////////////////////////////////////////
+
+void AsepriteEncoder::writePreviewChunk(AsepriteFrameHeader* frame_header, const Image* image)
+{
+  ASSERT(image->pixelFormat() == IMAGE_RGB);
+
+  const ChunkWriter chunk(this, frame_header, ASE_FILE_CHUNK_PREVIEW);
+  write16(image->width());
+  write16(image->height());
+  write32(0); // Flags
+  writePadding(8);
+
+  ImageScanlines scan(image);
+  write_compressed_image(f(), &scan, IMAGE_RGB);
+}
+
 //////////////////////////////////////////////////////////////////////
 // Cel Chunk
 //////////////////////////////////////////////////////////////////////
@@ -714,8 +749,10 @@ void AsepriteEncoder::writeCelChunk(AsepriteFrameHeader* frame_header,
         write16(image->width());
         write16(image->height());
 
+        const size_t pos = tell();
         ImageScanlines scan(image);
         write_compressed_image(f(), &scan, image->pixelFormat());
+        delegate()->compressedImageSaved(image, pos, tell() - pos);
       }
       else {
         // Width and height
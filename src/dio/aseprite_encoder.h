@@ -18,6 +18,7 @@
 #include <string>
 
 namespace doc {
+class Image;
 class Mask;
 class Palette;
 class Slice;
@@ -93,6 +94,8 @@ private:
                      const doc::layer_t layer_index);
   void writeCelExtraChunk(AsepriteFrameHeader* frame_header, const doc::Cel* cel);
 
+  void writePreviewChunk(AsepriteFrameHeader* frame_header, const doc::Image* image);
+
   void writeColorProfile(AsepriteFrameHeader* frame_header, const doc::Sprite* sprite);
 
   void writeMaskChunk(AsepriteFrameHeader* frame_header, doc::Mask* mask);
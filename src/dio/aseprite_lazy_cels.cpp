@@ -0,0 +1,288 @@
+// Aseprite Document IO Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "dio/aseprite_lazy_cels.h"
+
+#include "base/file_handle.h"
+#include "base/fs.h"
+#include "base/log.h"
+#include "dio/aseprite_decoder.h"
+#include "dio/decode_delegate.h"
+#include "dio/file_interface.h"
+#include "doc/image.h"
+#include "doc/image_loader.h"
+
+#include <exception>
+
+namespace dio {
+
+using namespace doc;
+
+namespace {
+
+class ErrorDelegate : public DecodeDelegate {
+public:
+  void error(const std::string& msg) override { m_errors += msg; }
+  const std::string& errors() const { return m_errors; }
+
+private:
+  std::string m_errors;
+};
+
+} // anonymous namespace
+
+class AsepriteLazyCels::Loader : public ImageLoader {
+public:
+  Loader(const std::shared_ptr<AsepriteLazyCels>& cels, const std::size_t index)
+    : m_cels(cels)
+    , m_index(index)
+  {
+  }
+
+  void loadPixels(Image* image) override { m_cels->loadPixels(image, m_index); }
+
+private:
+  std::shared_ptr<AsepriteLazyCels> m_cels;
+  std::size_t m_index;
+};
+
+AsepriteLazyCels::AsepriteLazyCels(const std::string& filename, const AsepriteHeader& header)
+  : m_filename(filename)
+  , m_header(header)
+{
+  updateFileInfo();
+}
+
+ImageRef AsepriteLazyCels::createImage(const PixelFormat pixelFormat,
+                                       const int width,
+                                       const int height,
+                                       const std::size_t pos,
+                                       const std::size_t size)
+{
+  std::size_t index;
+  {
+    const std::lock_guard lock(m_mutex);
+    index = m_entries.size();
+    m_entries.emplace_back();
+    m_entries.back().pos = pos;
+    m_entries.back().size = size;
+  }
+
+  ImageRef image(Image::createLazy(ImageSpec(ColorMode(pixelFormat), width, height),
+                                   std::make_shared<Loader>(shared_from_this(), index)));
+
+  const std::lock_guard lock(m_mutex);
+  m_entries[index].image = image;
+  return image;
+}
+
+bool AsepriteLazyCels::hasErrors() const
+{
+  const std::lock_guard lock(m_mutex);
+  return m_errors;
+}
+
+std::size_t AsepriteLazyCels::memSize() const
+{
+  const std::lock_guard lock(m_mutex);
+  return m_memSize;
+}
+
+void AsepriteLazyCels::setMaxMemSize(const std::size_t maxMemSize)
+{
+  const std::lock_guard lock(m_mutex);
+  m_maxMemSize = maxMemSize;
+}
+
+void AsepriteLazyCels::unloadImages()
+{
+  // Images are unloaded without locking m_mutex because
+  // Image::unload() locks the same mutex that is locked when the
+  // pixels are loaded.
+  std::vector<ImageRef> images;
+  {
+    const std::lock_guard lock(m_mutex);
+    if (m_saving)
+      return;
+
+    // Unload images until we use 3/4 of the limit, so we don't need
+    // to unload images each time a new one is loaded.
+    const std::size_t targetMemSize = m_maxMemSize / 4 * 3;
+    while (m_memSize > targetMemSize && !m_loaded.empty()) {
+      Entry& entry = m_entries[m_loaded.front()];
+      m_loaded.pop_front();
+      m_memSize -= entry.memSize;
+      entry.loaded = false;
+
+      // Modified images must be kept in memory (and they don't count
+      // as memory that can be released anymore)
+      ImageRef image = entry.image.lock();
+      if (image && image->version() == entry.version)
+        images.push_back(image);
+    }
+  }
+
+  for (const ImageRef& image : images)
+    image->unload();
+}
+
+bool AsepriteLazyCels::beginSave()
+{
+  std::vector<ImageRef> images;
+  {
+    const std::lock_guard lock(m_mutex);
+    m_saving = true;
+    m_savingImages.clear();
+    for (std::size_t i = 0; i < m_entries.size(); ++i) {
+      if (ImageRef image = m_entries[i].image.lock()) {
+        m_savingImages[image.get()] = i;
+        images.push_back(image);
+      }
+    }
+  }
+
+  // Accessing the pixels loads them
+  for (const ImageRef& image : images)
+    image->getPixelAddress(0, 0);
+
+  const std::lock_guard lock(m_mutex);
+  if (m_errors) {
+    m_saving = false;
+    m_savingImages.clear();
+    return false;
+  }
+  return true;
+}
+
+void AsepriteLazyCels::imageSaved(const Image* image, const std::size_t pos, const std::size_t size)
+{
+  const std::lock_guard lock(m_mutex);
+  auto it = m_savingImages.find(image);
+  if (!m_saving || it == m_savingImages.end())
+    return;
+
+  // All images are loaded and cannot be unloaded while we are
+  // saving, so we can already change their position in the file.
+  Entry& entry = m_entries[it->second];
+  entry.pos = pos;
+  entry.size = size;
+  m_savingImages.erase(it);
+}
+
+void AsepriteLazyCels::endSave(const bool saved)
+{
+  const std::lock_guard lock(m_mutex);
+  if (!m_saving)
+    return;
+
+  m_saving = false;
+
+  // Images that aren't in the new file cannot be loaded again
+  for (const auto& it : m_savingImages)
+    m_entries[it.second].size = 0;
+  m_savingImages.clear();
+  if (saved) {
+    updateFileInfo();
+  }
+  else {
+    for (Entry& entry : m_entries)
+      entry.size = 0;
+  }
+
+  // Loaded images that are in the file can be unloaded again
+  m_loaded.clear();
+  m_memSize = 0;
+  for (std::size_t i = 0; i < m_entries.size(); ++i) {
+    Entry& entry = m_entries[i];
+    entry.loaded = false;
+
+    ImageRef image = entry.image.lock();
+    if (image && entry.size > 0 && image->isLoaded()) {
+      entry.loaded = true;
+      entry.version = image->version();
+      entry.memSize = image->getMemSize();
+      m_memSize += entry.memSize;
+      m_loaded.push_back(i);
+    }
+  }
+}
+
+// Called from Image::materialize() with the pixels already cleared
+void AsepriteLazyCels::loadPixels(Image* image, const std::size_t index)
+{
+  std::size_t pos, size, fileSize;
+  base::Time fileTime;
+  {
+    const std::lock_guard lock(m_mutex);
+    pos = m_entries[index].pos;
+    size = m_entries[index].size;
+    fileSize = m_fileSize;
+    fileTime = m_fileTime;
+  }
+
+  ErrorDelegate delegate;
+  try {
+    // If the file was modified by other program the cel is left
+    // empty, we cannot know where its pixels are now.
+    const base::Time time = base::get_modification_time(m_filename);
+    if (size == 0) {
+      delegate.error("The cel pixels aren't in the file");
+    }
+    else if (base::file_size(m_filename) != fileSize || time < fileTime || fileTime < time) {
+      delegate.error("The file was modified");
+    }
+    else {
+      base::FileHandle handle(base::open_file(m_filename, "rb"));
+      if (handle) {
+        StdioFileInterface fileInterface(handle.get());
+        AsepriteDecoder decoder;
+        decoder.initialize(&delegate, &fileInterface);
+        decoder.readCompressedPixels(image, &m_header, pos, pos + size);
+      }
+      else {
+        delegate.error("Cannot open the file");
+      }
+    }
+  }
+  catch (const std::exception& e) {
+    delegate.error(e.what());
+  }
+
+  const std::lock_guard lock(m_mutex);
+  if (!delegate.errors().empty()) {
+    // The cel is left empty (or incomplete), we have to avoid
+    // overwriting the original file with these pixels.
+    LOG(ERROR,
+        "DIO: Error decoding cel pixels from %s: %s\n",
+        m_filename.c_str(),
+        delegate.errors().c_str());
+    m_errors = true;
+  }
+
+  // Cels that couldn't be decoded are kept in memory
+  Entry& entry = m_entries[index];
+  if (!entry.loaded && delegate.errors().empty()) {
+    entry.loaded = true;
+    entry.version = image->version();
+    entry.memSize = image->getMemSize();
+    m_memSize += entry.memSize;
+    m_loaded.push_back(index);
+  }
+}
+
+// Remembers the size/time of the file to know if it was modified by
+// other program.
+void AsepriteLazyCels::updateFileInfo()
+{
+  m_fileSize = base::file_size(m_filename);
+  m_fileTime = base::get_modification_time(m_filename);
+}
+
+} // namespace dio
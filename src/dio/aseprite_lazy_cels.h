@@ -0,0 +1,118 @@
+// Aseprite Document IO Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef DIO_ASEPRITE_LAZY_CELS_H_INCLUDED
+#define DIO_ASEPRITE_LAZY_CELS_H_INCLUDED
+#pragma once
+
+#include "base/time.h"
+#include "dio/aseprite_common.h"
+#include "doc/image_ref.h"
+#include "doc/object_version.h"
+#include "doc/pixel_format.h"
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dio {
+
+// Cels of a .aseprite file which pixels are decoded from the file
+// the first time they are accessed (see
+// DecodeDelegate::lazyCelsFilename()). Only the file position of the
+// compressed pixels of each cel is kept in memory, and the memory
+// used by decoded cels can be limited unloading the least recently
+// loaded cels that weren't modified.
+//
+// If the file is modified by other program, the cels that weren't
+// loaded cannot be decoded anymore (hasErrors() returns true).
+class AsepriteLazyCels : public std::enable_shared_from_this<AsepriteLazyCels> {
+public:
+  static constexpr std::size_t kDefaultMaxMemSize = 512 * 1024 * 1024;
+
+  // Smaller cels are decoded immediately, re-opening the file to
+  // decode them later would be slower than decoding them now.
+  static constexpr int kMinPixels = 64 * 64;
+
+  AsepriteLazyCels(const std::string& filename, const AsepriteHeader& header);
+
+  const std::string& filename() const { return m_filename; }
+
+  // Creates a lazy image which compressed pixels are in the
+  // [pos, pos+size) range of the file.
+  doc::ImageRef createImage(doc::PixelFormat pixelFormat,
+                            int width,
+                            int height,
+                            std::size_t pos,
+                            std::size_t size);
+
+  // Returns true if the pixels of some cel couldn't be decoded (the
+  // cel was left empty). In this case the document must not be
+  // saved, or the original pixels would be lost.
+  bool hasErrors() const;
+
+  // Memory used by loaded images that can be unloaded.
+  std::size_t memSize() const;
+  std::size_t maxMemSize() const { return m_maxMemSize; }
+  void setMaxMemSize(std::size_t maxMemSize);
+  bool exceedsMaxMemSize() const { return memSize() > m_maxMemSize; }
+
+  // Unloads the least recently loaded images which weren't modified
+  // (their version is the same as when they were loaded) until the
+  // used memory is below the limit. The caller must guarantee that
+  // no other thread is accessing the images (e.g. locking the
+  // document to write it).
+  void unloadImages();
+
+  // Functions to overwrite the file from where the cels are loaded:
+  // beginSave() loads all the images (returns false if some cel
+  // cannot be decoded, in this case the file must not be
+  // overwritten), imageSaved() is called for each image saved with
+  // compressed pixels in the new file, and endSave() makes the
+  // images unloadable again (they will be loaded from the new file).
+  // Images that weren't saved in the new file (or all of them if
+  // the file couldn't be saved) are kept in memory.
+  bool beginSave();
+  void imageSaved(const doc::Image* image, std::size_t pos, std::size_t size);
+  void endSave(bool saved);
+
+private:
+  class Loader;
+
+  struct Entry {
+    std::weak_ptr<doc::Image> image;
+    std::size_t pos = 0;  // Compressed pixels in the file
+    std::size_t size = 0; // (size == 0 if they aren't in the file)
+    doc::ObjectVersion version = 0; // Version when it was loaded
+    std::size_t memSize = 0;
+    bool loaded = false;
+  };
+
+  void loadPixels(doc::Image* image, std::size_t index);
+  void updateFileInfo();
+
+  std::string m_filename;
+  AsepriteHeader m_header;
+
+  mutable std::mutex m_mutex;
+  std::size_t m_fileSize = 0;
+  base::Time m_fileTime;
+  std::vector<Entry> m_entries;
+  std::deque<std::size_t> m_loaded; // Loaded entries in load order
+  std::size_t m_memSize = 0;
+  std::size_t m_maxMemSize = kDefaultMaxMemSize;
+  bool m_saving = false;
+  std::unordered_map<const doc::Image*, std::size_t> m_savingImages; // Image -> entry index
+  bool m_errors = false;
+};
+
+} // namespace dio
+
+#endif
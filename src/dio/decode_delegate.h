@@ -1,5 +1,5 @@
 // Aseprite Document IO Library
-// Copyright (c) 2023 Igara Studio S.A.
+// Copyright (c) 2023-2026 Igara Studio S.A.
 // Copyright (c) 2017 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -38,6 +38,16 @@ public:
   // to generate a thumbnail)
   virtual bool decodeOneFrame() { return false; }
 
+  // Return true if the embedded preview image is enough (e.g. to
+  // generate a thumbnail). If the file has a preview, the decoded
+  // sprite will be a one layer/frame RGB sprite with that image.
+  virtual bool decodePreview() { return false; }
+
+  // Returns the filename of the decoded file to load the pixels of
+  // big cels when they are accessed for first time (instead of
+  // decoding all cels now), or an empty string to decode all cels.
+  virtual std::string lazyCelsFilename() { return std::string(); }
+
   // Default color for slices without user data
   virtual doc::color_t defaultSliceColor() { return doc::rgba(0, 0, 255, 255); }
 
@@ -11,11 +11,13 @@
 #include "doc/frame.h"
 #include "doc/frames_sequence.h"
 
+#include <cstddef>
 #include <string>
 
 namespace doc {
+class Image;
 class Sprite;
-}
+} // namespace doc
 
 namespace dio {
 
@@ -41,6 +43,15 @@ public:
   virtual int preferredCelType() { return ASE_FILE_COMPRESSED_CEL; }
   virtual int preferredTilemapCelType() { return ASE_FILE_COMPRESSED_TILEMAP; }
 
+  // Returns a small IMAGE_RGB image (in sRGB) with the first frame
+  // of the sprite to be embedded in the file as a preview chunk, or
+  // nullptr if the preview shouldn't be saved.
+  virtual const doc::Image* previewImage() { return nullptr; }
+
+  // Called after the compressed pixels of a cel image were written
+  // in the [pos, pos+size) range of the file.
+  virtual void compressedImageSaved(const doc::Image* image, size_t pos, size_t size) {}
+
   doc::frame_t fromFrame() const { return framesSequence().firstFrame(); }
   doc::frame_t toFrame() const { return framesSequence().lastFrame(); }
   doc::frame_t frames() const { return (doc::frame_t)framesSequence().size(); }
@@ -17,8 +17,11 @@
 
 #include "base/base.h"
 #include "doc/algo.h"
+#include "doc/algorithm/select_by_color.h"
 #include "doc/image.h"
+#include "doc/image_ref.h"
 #include "doc/mask.h"
+#include "doc/mask_spans.h"
 #include "doc/primitives.h"
 #include "doc/primitives_fast.h"
 
@@ -369,6 +372,28 @@ static void replace_color(const Image* image,
   }
 }
 
+// Compares all pixels with select_by_color() (in several threads)
+// and then calls "proc" for each horizontal line of similar pixels.
+static void replace_similar_colors(const Image* image,
+                                   const gfx::Rect& bounds,
+                                   int src_color,
+                                   int tolerance,
+                                   void* data,
+                                   AlgoHLine proc)
+{
+  if (bounds.isEmpty())
+    return;
+
+  ImageRef bitmap(Image::create(IMAGE_BITMAP, bounds.w, bounds.h));
+  select_by_color(image, bounds, src_color, tolerance, true, bitmap.get());
+
+  const MaskSpans spans(bitmap.get(), bounds.origin());
+  for (int y = spans.bounds().y; y < spans.bounds().y2(); ++y) {
+    for (auto span = spans.rowBegin(y), end = spans.rowEnd(y); span != end; ++span)
+      (*proc)(span->x1, y, span->x2 - 1, data);
+  }
+}
+
 /* floodfill:
  *  Fills an enclosed area (starting at point x, y) with the specified color.
  */
@@ -392,13 +417,9 @@ void floodfill(const Image* image,
   if (!contiguous) {
     switch (image->pixelFormat()) {
       case IMAGE_RGB:
-        replace_color<RgbTraits>(image, bounds, src_color, tolerance, data, proc);
-        break;
       case IMAGE_GRAYSCALE:
-        replace_color<GrayscaleTraits>(image, bounds, src_color, tolerance, data, proc);
-        break;
       case IMAGE_INDEXED:
-        replace_color<IndexedTraits>(image, bounds, src_color, tolerance, data, proc);
+        replace_similar_colors(image, bounds, src_color, tolerance, data, proc);
         break;
       case IMAGE_TILEMAP:
         replace_color<TilemapTraits>(image, bounds, src_color, tolerance, data, proc);
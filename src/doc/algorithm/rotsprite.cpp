@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2020-2023  Igara Studio S.A.
+// Copyright (c) 2020-2026  Igara Studio S.A.
 // Copyright (c) 2001-2018 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -175,7 +175,9 @@ void rotsprite_image(Image* bmp,
                      int x4,
                      int y4)
 {
-  static ImageBufferPtr buf[3]; // TODO non-thread safe
+  // One set of buffers per thread (images can be transformed from
+  // worker threads, e.g. when several cels are stamped at once)
+  static thread_local ImageBufferPtr buf[3];
 
   for (int i = 0; i < 3; ++i)
     if (!buf[i])
@@ -0,0 +1,266 @@
+// Aseprite Document Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "doc/algorithm/select_by_color.h"
+
+#include "doc/image.h"
+#include "doc/primitives_fast.h"
+#include "doc/task_scheduler.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__x86_64__) || defined(_WIN64)
+  #include <emmintrin.h>
+#endif
+
+namespace doc { namespace algorithm {
+
+namespace {
+
+// Minimum number of pixels to compare rows in several threads
+constexpr int kMinPixelsForThreads = 256 * 256;
+
+// Number of rows that a thread compares each time
+constexpr int kRowsPerChunk = 16;
+
+template<typename ImageTraits>
+bool is_similar_color(color_t c, color_t color, int tolerance, bool transparentMatch)
+{
+  static_assert(false && sizeof(ImageTraits), "Invalid color comparison");
+  return false;
+}
+
+template<>
+bool is_similar_color<RgbTraits>(color_t c, color_t color, int tolerance, bool transparentMatch)
+{
+  if (transparentMatch && rgba_geta(c) == 0 && rgba_geta(color) == 0)
+    return true;
+
+  return (std::abs(int(rgba_getr(c)) - int(rgba_getr(color))) <= tolerance &&
+          std::abs(int(rgba_getg(c)) - int(rgba_getg(color))) <= tolerance &&
+          std::abs(int(rgba_getb(c)) - int(rgba_getb(color))) <= tolerance &&
+          std::abs(int(rgba_geta(c)) - int(rgba_geta(color))) <= tolerance);
+}
+
+template<>
+bool is_similar_color<GrayscaleTraits>(color_t c,
+                                       color_t color,
+                                       int tolerance,
+                                       bool transparentMatch)
+{
+  if (transparentMatch && graya_geta(c) == 0 && graya_geta(color) == 0)
+    return true;
+
+  return (std::abs(int(graya_getv(c)) - int(graya_getv(color))) <= tolerance &&
+          std::abs(int(graya_geta(c)) - int(graya_geta(color))) <= tolerance);
+}
+
+template<>
+bool is_similar_color<IndexedTraits>(color_t c,
+                                     color_t color,
+                                     int tolerance,
+                                     bool transparentMatch)
+{
+  return (std::abs(int(c) - int(color)) <= tolerance);
+}
+
+#if DOC_USE_BITMAP_AS_1BPP && (defined(__x86_64__) || defined(_WIN64))
+
+// Uses SSE2 to compare several pixels at once, writing whole bytes
+// (8 pixels) of the "dst" bitmap row. Returns the number of compared
+// pixels (a multiple of 8). "tolerance" must be in the [0, 255] range.
+template<typename ImageTraits>
+int select_row_sse2(const typename ImageTraits::pixel_t* src,
+                    uint8_t* dst,
+                    const int w,
+                    const color_t color,
+                    const int tolerance,
+                    const bool transparentMatch)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i ones = _mm_set1_epi32(-1);
+  const __m128i tol = _mm_set1_epi8(char(tolerance));
+
+  // Returns 0xff in each byte of "v" which is in the range
+  // [ref-tolerance, ref+tolerance] (each byte of a pixel is a color
+  // component)
+  auto similar_bytes = [zero, tol](const __m128i v, const __m128i ref) {
+    const __m128i diff = _mm_or_si128(_mm_subs_epu8(v, ref), _mm_subs_epu8(ref, v));
+    return _mm_cmpeq_epi8(_mm_subs_epu8(diff, tol), zero);
+  };
+
+  int x = 0;
+  if constexpr (ImageTraits::bytes_per_pixel == 4) {
+    const __m128i ref = _mm_set1_epi32(int(color));
+    const __m128i alphaMask = _mm_set1_epi32(int(rgba_a_mask));
+    const bool matchAlpha = (transparentMatch && rgba_geta(color) == 0);
+
+    // One bit for each of the 4 pixels
+    auto similar_pixels = [&](const typename ImageTraits::pixel_t* p) {
+      const __m128i v = _mm_loadu_si128((const __m128i*)p);
+      __m128i m = _mm_cmpeq_epi32(similar_bytes(v, ref), ones);
+      if (matchAlpha)
+        m = _mm_or_si128(m, _mm_cmpeq_epi32(_mm_and_si128(v, alphaMask), zero));
+      return _mm_movemask_ps(_mm_castsi128_ps(m));
+    };
+
+    for (; x + 8 <= w; x += 8)
+      dst[x / 8] = uint8_t(similar_pixels(src + x) | (similar_pixels(src + x + 4) << 4));
+  }
+  else if constexpr (ImageTraits::bytes_per_pixel == 2) {
+    const __m128i ref = _mm_set1_epi16(short(color));
+    const __m128i alphaMask = _mm_set1_epi16(short(graya_a_mask));
+    const bool matchAlpha = (transparentMatch && graya_geta(color) == 0);
+
+    for (; x + 8 <= w; x += 8) {
+      const __m128i v = _mm_loadu_si128((const __m128i*)(src + x));
+      __m128i m = _mm_cmpeq_epi16(similar_bytes(v, ref), ones);
+      if (matchAlpha)
+        m = _mm_or_si128(m, _mm_cmpeq_epi16(_mm_and_si128(v, alphaMask), zero));
+      // Pack the 8 16-bit results in 8 bytes to get one bit per pixel
+      dst[x / 8] = uint8_t(_mm_movemask_epi8(_mm_packs_epi16(m, zero)));
+    }
+  }
+  else if constexpr (ImageTraits::bytes_per_pixel == 1) {
+    const __m128i ref = _mm_set1_epi8(char(color));
+
+    for (; x + 16 <= w; x += 16) {
+      const int m = _mm_movemask_epi8(
+        similar_bytes(_mm_loadu_si128((const __m128i*)(src + x)), ref));
+      dst[x / 8] = uint8_t(m);
+      dst[x / 8 + 1] = uint8_t(m >> 8);
+    }
+  }
+  return x;
+}
+
+#endif
+
+template<typename ImageTraits>
+void select_row(const Image* image,
+                const gfx::Rect& bounds,
+                const int y,
+                const color_t color,
+                const int tolerance,
+                const bool transparentMatch,
+                Image* dst)
+{
+  using pixel_t = typename ImageTraits::pixel_t;
+
+  const auto* src = (const pixel_t*)image->getPixelAddress(bounds.x, bounds.y + y);
+  const int w = bounds.w;
+  int x = 0;
+
+#if DOC_USE_BITMAP_AS_1BPP
+  uint8_t* dstBits = dst->getPixelAddress(0, y);
+
+  #if defined(__x86_64__) || defined(_WIN64)
+  if (tolerance >= 0 && tolerance <= 255 &&
+      (ImageTraits::bytes_per_pixel == 4 || color <= ImageTraits::max_value)) {
+    x = select_row_sse2<ImageTraits>(src, dstBits, w, color, tolerance, transparentMatch);
+  }
+  #endif
+
+  for (; x < w; x += 8) {
+    uint8_t byte = 0;
+    for (int i = 0; i < 8 && x + i < w; ++i) {
+      if (is_similar_color<ImageTraits>(src[x + i], color, tolerance, transparentMatch))
+        byte |= (1 << i);
+    }
+    dstBits[x / 8] = byte;
+  }
+#else
+  for (; x < w; ++x) {
+    put_pixel_fast<BitmapTraits>(
+      dst,
+      x,
+      y,
+      is_similar_color<ImageTraits>(src[x], color, tolerance, transparentMatch) ? 1 : 0);
+  }
+#endif
+}
+
+template<typename ImageTraits>
+bool select_by_color_templ(const Image* image,
+                           const gfx::Rect& bounds,
+                           const color_t color,
+                           const int tolerance,
+                           const bool transparentMatch,
+                           Image* dst,
+                           CancelIO* cancel)
+{
+  const int nchunks = (bounds.h + kRowsPerChunk - 1) / kRowsPerChunk;
+  const int maxThreads = (bounds.w * bounds.h >= kMinPixelsForThreads ? 0 : 1);
+
+  return TaskScheduler::instance().parallelFor(
+    nchunks,
+    [&](const int chunk) {
+      const int y1 = chunk * kRowsPerChunk;
+      const int y2 = std::min(y1 + kRowsPerChunk, bounds.h);
+      for (int y = y1; y < y2; ++y)
+        select_row<ImageTraits>(image, bounds, y, color, tolerance, transparentMatch, dst);
+    },
+    maxThreads,
+    cancel);
+}
+
+} // anonymous namespace
+
+bool select_by_color(const Image* image,
+                     const gfx::Rect& bounds,
+                     const color_t color,
+                     const int tolerance,
+                     const bool transparentMatch,
+                     Image* dst,
+                     CancelIO* cancel)
+{
+  ASSERT(image);
+  ASSERT(dst);
+  ASSERT(image->bounds().contains(bounds));
+  ASSERT(dst->pixelFormat() == IMAGE_BITMAP);
+  ASSERT(dst->width() == bounds.w);
+  ASSERT(dst->height() == bounds.h);
+
+  if (bounds.isEmpty())
+    return true;
+
+  switch (image->pixelFormat()) {
+    case IMAGE_RGB:
+      return select_by_color_templ<RgbTraits>(image,
+                                              bounds,
+                                              color,
+                                              tolerance,
+                                              transparentMatch,
+                                              dst,
+                                              cancel);
+    case IMAGE_GRAYSCALE:
+      return select_by_color_templ<GrayscaleTraits>(image,
+                                                    bounds,
+                                                    color,
+                                                    tolerance,
+                                                    transparentMatch,
+                                                    dst,
+                                                    cancel);
+    case IMAGE_INDEXED:
+      return select_by_color_templ<IndexedTraits>(image,
+                                                  bounds,
+                                                  color,
+                                                  tolerance,
+                                                  transparentMatch,
+                                                  dst,
+                                                  cancel);
+  }
+
+  ASSERT(false);
+  return false;
+}
+
+}} // namespace doc::algorithm
@@ -0,0 +1,42 @@
+// Aseprite Document Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef DOC_ALGORITHM_SELECT_BY_COLOR_H_INCLUDED
+#define DOC_ALGORITHM_SELECT_BY_COLOR_H_INCLUDED
+#pragma once
+
+#include "doc/color.h"
+#include "gfx/fwd.h"
+
+namespace doc {
+class CancelIO;
+class Image;
+
+namespace algorithm {
+
+// Fills the "dst" bitmap (an IMAGE_BITMAP of the size of "bounds")
+// with 1 in pixels of "image" (inside "bounds") similar to the given
+// "color", i.e. the difference of each color component is less or
+// equal than "tolerance", and 0 in the other pixels. If
+// "transparentMatch" is true, all transparent pixels are similar to
+// a transparent color.
+//
+// Only RGB, grayscale, and indexed images are supported. Rows are
+// compared in several threads for big images. Returns false if the
+// operation was canceled with "cancel" (the "dst" content is
+// undefined in that case).
+bool select_by_color(const Image* image,
+                     const gfx::Rect& bounds,
+                     const color_t color,
+                     const int tolerance,
+                     const bool transparentMatch,
+                     Image* dst,
+                     CancelIO* cancel = nullptr);
+
+} // namespace algorithm
+} // namespace doc
+
+#endif
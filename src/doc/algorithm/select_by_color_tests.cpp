@@ -0,0 +1,106 @@
+// Aseprite Document Library
+// Copyright (c) 2026  Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "gtest/gtest.h"
+
+#include "doc/algorithm/select_by_color.h"
+
+#include "doc/algorithm/random_image.h"
+#include "doc/image.h"
+#include "doc/image_ref.h"
+#include "doc/mask.h"
+#include "doc/primitives.h"
+
+#include <cstdlib>
+
+using namespace doc;
+using namespace gfx;
+
+static bool is_similar(PixelFormat pf, color_t c, color_t color, int tolerance, bool transparent)
+{
+  switch (pf) {
+    case IMAGE_RGB:
+      if (transparent && rgba_geta(c) == 0 && rgba_geta(color) == 0)
+        return true;
+      return (std::abs(rgba_getr(c) - rgba_getr(color)) <= tolerance &&
+              std::abs(rgba_getg(c) - rgba_getg(color)) <= tolerance &&
+              std::abs(rgba_getb(c) - rgba_getb(color)) <= tolerance &&
+              std::abs(rgba_geta(c) - rgba_geta(color)) <= tolerance);
+    case IMAGE_GRAYSCALE:
+      if (transparent && graya_geta(c) == 0 && graya_geta(color) == 0)
+        return true;
+      return (std::abs(graya_getv(c) - graya_getv(color)) <= tolerance &&
+              std::abs(graya_geta(c) - graya_geta(color)) <= tolerance);
+    case IMAGE_INDEXED: return (std::abs(int(c) - int(color)) <= tolerance);
+  }
+  return false;
+}
+
+TEST(SelectByColor, CompareWithPixelByPixel)
+{
+  for (auto pf : { IMAGE_RGB, IMAGE_GRAYSCALE, IMAGE_INDEXED }) {
+    // Big enough to use several threads
+    ImageRef image(Image::create(pf, 301, 257));
+    doc::algorithm::random_image(image.get());
+
+    // Some transparent pixels
+    if (pf != IMAGE_INDEXED) {
+      for (int i = 0; i < 1000; ++i)
+        put_pixel(image.get(), (i * 37) % 301, (i * 91) % 257, 0);
+    }
+
+    const Rect bounds(3, 5, 290, 240);
+    for (const int tolerance : { 0, 1, 32, 255 }) {
+      for (const bool transparent : { false, true }) {
+        for (const color_t color : { get_pixel(image.get(), 10, 10), color_t(0) }) {
+          ImageRef bitmap(Image::create(IMAGE_BITMAP, bounds.w, bounds.h));
+          EXPECT_TRUE(doc::algorithm::select_by_color(image.get(),
+                                                      bounds,
+                                                      color,
+                                                      tolerance,
+                                                      transparent,
+                                                      bitmap.get()));
+
+          for (int y = 0; y < bounds.h; ++y) {
+            for (int x = 0; x < bounds.w; ++x) {
+              const color_t c = get_pixel(image.get(), bounds.x + x, bounds.y + y);
+              ASSERT_EQ(is_similar(pf, c, color, tolerance, transparent),
+                        get_pixel(bitmap.get(), x, y) != 0)
+                << "Pixel format=" << pf << " x=" << x << " y=" << y
+                << " tolerance=" << tolerance;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(SelectByColor, MaskByColor)
+{
+  ImageRef image(Image::create(IMAGE_INDEXED, 64, 32));
+  clear_image(image.get(), 0);
+  fill_rect(image.get(), 10, 4, 20, 8, 5);
+  put_pixel(image.get(), 40, 30, 6);
+
+  Mask mask;
+  EXPECT_TRUE(mask.byColor(image.get(), 5, 0));
+  EXPECT_EQ(Rect(10, 4, 11, 5), mask.bounds());
+
+  EXPECT_TRUE(mask.byColor(image.get(), 5, 1));
+  EXPECT_EQ(Rect(10, 4, 31, 27), mask.bounds());
+  EXPECT_TRUE(mask.containsPoint(40, 30));
+  EXPECT_FALSE(mask.containsPoint(9, 4));
+
+  EXPECT_TRUE(mask.byColor(image.get(), 7, 0));
+  EXPECT_TRUE(mask.isEmpty());
+}
+
+int main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2019-2023 Igara Studio S.A.
+// Copyright (c) 2019-2026 Igara Studio S.A.
 // Copyright (c) 2001-2016 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -18,10 +18,9 @@
 #include "doc/layer_tilemap.h"
 #include "doc/primitives.h"
 #include "doc/primitives_fast.h"
+#include "doc/task_scheduler.h"
 #include "doc/tileset.h"
 
-#include <thread>
-
 namespace doc { namespace algorithm {
 
 namespace {
@@ -136,24 +135,25 @@ bool shrink_bounds_templ(const Image* image, gfx::Rect& bounds, color_t refpixel
   // Pixels per row
   const int rowPixels = image->rowPixels();
   const int canvasSize = image->width() * image->height();
-  if ((std::thread::hardware_concurrency() >= 4) &&
+  TaskScheduler& scheduler = TaskScheduler::instance();
+  if ((scheduler.concurrency() >= 4) &&
       ((image->pixelFormat() == IMAGE_RGB && canvasSize >= 800 * 800) ||
        (image->pixelFormat() != IMAGE_RGB && canvasSize >= 500 * 500))) {
     gfx::Rect leftBounds(bounds), rightBounds(bounds), topBounds(bounds), bottomBounds(bounds);
 
-    // TODO use a base::thread_pool and a base::task for each border
-
-    std::thread left(
-      [&] { shrink_bounds_left_templ<ImageTraits>(image, leftBounds, refpixel, rowPixels); });
-    std::thread right(
-      [&] { shrink_bounds_right_templ<ImageTraits>(image, rightBounds, refpixel, rowPixels); });
-    std::thread top([&] { shrink_bounds_top_templ<ImageTraits>(image, topBounds, refpixel); });
-    std::thread bottom(
-      [&] { shrink_bounds_bottom_templ<ImageTraits>(image, bottomBounds, refpixel); });
-    left.join();
-    right.join();
-    top.join();
-    bottom.join();
+    // Shrink each border in parallel
+    scheduler.parallelFor(4, [&](int i) {
+      switch (i) {
+        case 0:
+          shrink_bounds_left_templ<ImageTraits>(image, leftBounds, refpixel, rowPixels);
+          break;
+        case 1:
+          shrink_bounds_right_templ<ImageTraits>(image, rightBounds, refpixel, rowPixels);
+          break;
+        case 2: shrink_bounds_top_templ<ImageTraits>(image, topBounds, refpixel); break;
+        case 3: shrink_bounds_bottom_templ<ImageTraits>(image, bottomBounds, refpixel); break;
+      }
+    });
     bounds = leftBounds;
     bounds &= rightBounds;
     bounds &= topBounds;
@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2018-2024 Igara Studio S.A.
+// Copyright (c) 2018-2026 Igara Studio S.A.
 // Copyright (c) 2001-2016 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -60,7 +60,47 @@ Image* Image::create(const ImageSpec& spec, const ImageBufferPtr& buffer)
 Image* Image::createCopy(const Image* image, const ImageBufferPtr& buffer)
 {
   ASSERT(image);
+
+  // Copying a uniform image doesn't need to create its pixels
+  if (image->isUniform())
+    return Image::createUniform(image->spec(), image->uniformColor());
+
   return crop_image(image, 0, 0, image->width(), image->height(), image->maskColor(), buffer);
 }
 
+// static
+Image* Image::createUniform(const ImageSpec& spec, const color_t color)
+{
+  ASSERT(spec.width() >= 1 && spec.height() >= 1);
+  if (spec.width() < 1 || spec.height() < 1)
+    return nullptr;
+
+  switch (spec.colorMode()) {
+    case ColorMode::RGB:       return new ImageImpl<RgbTraits>(spec, color);
+    case ColorMode::GRAYSCALE: return new ImageImpl<GrayscaleTraits>(spec, color);
+    case ColorMode::INDEXED:   return new ImageImpl<IndexedTraits>(spec, color);
+    case ColorMode::BITMAP:    return new ImageImpl<BitmapTraits>(spec, color);
+    case ColorMode::TILEMAP:   return new ImageImpl<TilemapTraits>(spec, color);
+  }
+  return nullptr;
+}
+
+// static
+Image* Image::createLazy(const ImageSpec& spec, const ImageLoaderPtr& loader)
+{
+  ASSERT(spec.width() >= 1 && spec.height() >= 1);
+  ASSERT(loader);
+  if (spec.width() < 1 || spec.height() < 1)
+    return nullptr;
+
+  switch (spec.colorMode()) {
+    case ColorMode::RGB:       return new ImageImpl<RgbTraits>(spec, loader);
+    case ColorMode::GRAYSCALE: return new ImageImpl<GrayscaleTraits>(spec, loader);
+    case ColorMode::INDEXED:   return new ImageImpl<IndexedTraits>(spec, loader);
+    case ColorMode::BITMAP:    return new ImageImpl<BitmapTraits>(spec, loader);
+    case ColorMode::TILEMAP:   return new ImageImpl<TilemapTraits>(spec, loader);
+  }
+  return nullptr;
+}
+
 } // namespace doc
@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2018-2025 Igara Studio S.A.
+// Copyright (c) 2018-2026 Igara Studio S.A.
 // Copyright (c) 2001-2016 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -13,6 +13,7 @@
 #include "doc/color_mode.h"
 #include "doc/image_buffer.h"
 #include "doc/image_iterators2.h"
+#include "doc/image_loader.h"
 #include "doc/image_spec.h"
 #include "doc/object.h"
 #include "doc/pixel_format.h"
@@ -20,6 +21,8 @@
 #include "gfx/rect.h"
 #include "gfx/size.h"
 
+#include <atomic>
+
 namespace doc {
 
 template<typename ImageTraits>
@@ -43,6 +46,14 @@ public:
   static Image* create(const ImageSpec& spec, const ImageBufferPtr& buffer = ImageBufferPtr());
   static Image* createCopy(const Image* image, const ImageBufferPtr& buffer = ImageBufferPtr());
 
+  // Creates an image with all its pixels of the given color without
+  // allocating its pixels (see isUniform()).
+  static Image* createUniform(const ImageSpec& spec, color_t color);
+
+  // Creates an image which pixels are loaded by the given loader the
+  // first time they are accessed (see isLoaded()).
+  static Image* createLazy(const ImageSpec& spec, const ImageLoaderPtr& loader);
+
   virtual ~Image();
 
   const ImageSpec& spec() const { return m_spec; }
@@ -74,6 +85,28 @@ public:
 
   int getMemSize() const override;
 
+  // Returns true if this image doesn't have pixels in memory yet
+  // because all of them are of the same uniformColor(). The pixels
+  // are created the first time they are accessed (e.g. with
+  // getPixelAddress()), so code which can handle uniform images
+  // (render, file encoders, etc.) should check this flag before
+  // accessing the pixels. clear() keeps the image uniform.
+  bool isUniform() const { return m_uniform; }
+  color_t uniformColor() const { return m_uniformColor; }
+
+  // Returns true if the pixels of this image come from an
+  // ImageLoader. A lazy image is not loaded until its pixels are
+  // accessed, and it can be unloaded to release its memory when it
+  // wasn't modified (the pixels will be loaded again if they are
+  // needed).
+  bool isLazy() const { return m_loader != nullptr; }
+  bool isLoaded() const { return !m_unloaded; }
+
+  // Releases the pixels of a lazy image. The caller must guarantee
+  // that the pixels weren't modified since they were loaded, and that
+  // no other thread is using them.
+  virtual void unload() = 0;
+
   template<typename ImageTraits>
   ImageBits<ImageTraits> lockBits(LockType lockType, const gfx::Rect& bounds)
   {
@@ -125,6 +158,13 @@ protected:
   // Number of bytes for each row.
   size_t m_rowBytes;
 
+  std::atomic<bool> m_uniform = false;
+  color_t m_uniformColor = 0;
+
+  // Lazy images
+  ImageLoaderPtr m_loader;
+  std::atomic<bool> m_unloaded = false;
+
 private:
   ImageSpec m_spec;
 };
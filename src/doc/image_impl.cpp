@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2025 Igara Studio S.A.
+// Copyright (c) 2025-2026 Igara Studio S.A.
 // Copyright (c) 2001-2015 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -13,8 +13,21 @@
 
 #include "doc/image_io.h"
 
+#include <mutex>
+
 namespace doc {
 
+namespace {
+
+// Two threads could be reading the same uniform/lazy image at the
+// same time (e.g. the UI thread and a background render), we use only
+// one mutex for all images as this happens only one time for each
+// image. It's recursive because an ImageLoader accesses the pixels of
+// the image that is being loaded.
+std::recursive_mutex g_materializeMutex;
+
+} // anonymous namespace
+
 ImageImplBase::ImageImplBase(const ImageSpec& spec, const ImageBufferPtr& buffer)
   : Image(spec)
   , m_buffer(buffer)
@@ -27,8 +40,54 @@ int ImageImplBase::getMemSize() const
          (m_buffer ? m_buffer->size() : 0);
 }
 
+void ImageImplBase::materialize() const
+{
+  const std::lock_guard lock(g_materializeMutex);
+
+  // The loader is accessing the pixels of this same image
+  if (m_loading)
+    return;
+
+  auto self = const_cast<ImageImplBase*>(this);
+  if (isUniform()) {
+    self->initialize();
+    self->fillPixels(m_uniformColor);
+    self->m_uniform = false;
+  }
+  else if (!isLoaded()) {
+    self->initialize();
+    self->m_loading = true;
+    m_loader->loadPixels(self);
+    self->m_loading = false;
+
+    // Other threads can access the pixels only after they are loaded
+    self->m_unloaded = false;
+  }
+}
+
+bool ImageImplBase::unloadPixels()
+{
+  ASSERT(isLazy());
+
+  const std::lock_guard lock(g_materializeMutex);
+  // Suspended images have their pixels in m_stream
+  if (!isLazy() || !isLoaded() || m_loading || m_stream)
+    return false;
+
+  m_unloaded = true;
+  m_buffer.reset();
+  return true;
+}
+
 void ImageImplBase::suspendObject()
 {
+  // Uniform images (or lazy images that are not loaded) don't have
+  // pixels to suspend
+  if (isUniform() || !isLoaded()) {
+    Image::suspendObject();
+    return;
+  }
+
   ASSERT(m_buffer);
   ASSERT(!m_stream);
 
@@ -43,6 +102,9 @@ void ImageImplBase::restoreObject()
 {
   Image::restoreObject();
 
+  if (isUniform() || !isLoaded())
+    return;
+
   ASSERT(!m_buffer);
   ASSERT(m_stream);
 
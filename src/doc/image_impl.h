@@ -34,6 +34,20 @@ protected:
   ImageImplBase(const ImageSpec& spec, const ImageBufferPtr& buffer);
   virtual void initialize() = 0;
 
+  // Fills all pixels without checking if the image is uniform.
+  virtual void fillPixels(color_t color) = 0;
+
+  // Creates the pixels of a uniform image or loads the pixels of a
+  // lazy image.
+  void materialize() const;
+
+  // Returns true if the pixels were released.
+  bool unloadPixels();
+
+  // True while the ImageLoader is filling the pixels (only accessed
+  // by the thread which is loading them).
+  bool m_loading = false;
+
 public:
   int getMemSize() const override;
   void suspendObject() override;
@@ -54,12 +68,16 @@ private:
   inline address_t getLineAddress(int y)
   {
     ASSERT(y >= 0 && y < height());
+    if (isUniform() || !isLoaded())
+      materialize();
     return m_rows[y];
   }
 
   inline const_address_t getLineAddress(int y) const
   {
     ASSERT(y >= 0 && y < height());
+    if (isUniform() || !isLoaded())
+      materialize();
     return m_rows[y];
   }
 
@@ -79,6 +97,34 @@ public:
     initialize();
   }
 
+  // Creates a uniform image, the pixels are allocated (and filled
+  // with the given color) in the first access to them.
+  ImageImpl(const ImageSpec& spec, const color_t uniformColor)
+    : ImageImplBase(spec, ImageBufferPtr())
+    , m_rows(nullptr)
+    , m_bits(nullptr)
+  {
+    ASSERT(Traits::color_mode == colorMode());
+
+    m_rowBytes = Traits::rowstride_bytes(width());
+    m_uniformColor = uniformColor;
+    m_uniform = true;
+  }
+
+  // Creates a lazy image, the pixels are allocated and loaded with
+  // the given loader in the first access to them.
+  ImageImpl(const ImageSpec& spec, const ImageLoaderPtr& loader)
+    : ImageImplBase(spec, ImageBufferPtr())
+    , m_rows(nullptr)
+    , m_bits(nullptr)
+  {
+    ASSERT(Traits::color_mode == colorMode());
+
+    m_rowBytes = Traits::rowstride_bytes(width());
+    m_loader = loader;
+    m_unloaded = true;
+  }
+
   int getMemSize() const override
   {
     return ImageImplBase::getMemSize() - sizeof(ImageImplBase) + sizeof(ImageImpl);
@@ -110,12 +156,14 @@ public:
 
   void clear(color_t color) override
   {
-    const int w = width();
-    const int h = height();
-    for (int y = 0; y < h; ++y) {
-      address_t p = address(0, y);
-      std::fill(p, p + w, color);
+    // A uniform image is still uniform after clearing it
+    if (isUniform()) {
+      m_uniformColor = color;
+      return;
     }
+    if (!isLoaded())
+      materialize();
+    fillPixels(color);
   }
 
   void copy(const Image* _src, gfx::Clip area) override
@@ -127,6 +175,15 @@ public:
     if (!area.clip(width(), height(), src->width(), src->height()))
       return;
 
+    if (src->isUniform()) {
+      fillRect(area.dst.x,
+               area.dst.y,
+               area.dst.x + area.size.w - 1,
+               area.dst.y + area.size.h - 1,
+               src->uniformColor());
+      return;
+    }
+
     for (int end_y = area.dst.y + area.size.h; area.dst.y < end_y; ++area.dst.y, ++area.src.y) {
       src_address = src->address(area.src.x, area.src.y);
       dst_address = address(area.dst.x, area.dst.y);
@@ -169,7 +226,25 @@ public:
     m_bits = nullptr;
   }
 
+  void unload() override
+  {
+    if (unloadPixels()) {
+      m_rows = nullptr;
+      m_bits = nullptr;
+    }
+  }
+
 private:
+  void fillPixels(color_t color) override
+  {
+    const int w = width();
+    const int h = height();
+    for (int y = 0; y < h; ++y) {
+      address_t p = m_rows[y];
+      std::fill(p, p + w, color);
+    }
+  }
+
   void initialize() override
   {
     ASSERT(Traits::color_mode == colorMode());
@@ -277,16 +352,16 @@ inline void ImageImpl<RgbTraits>::blendRect(int x1,
 }
 
 template<>
-inline void ImageImpl<IndexedTraits>::clear(color_t color)
+inline void ImageImpl<IndexedTraits>::fillPixels(color_t color)
 {
-  uint8_t* p = address(0, 0);
+  uint8_t* p = m_bits;
   std::fill(p, p + rowBytes() * height(), color);
 }
 
 template<>
-inline void ImageImpl<BitmapTraits>::clear(color_t color)
+inline void ImageImpl<BitmapTraits>::fillPixels(color_t color)
 {
-  uint8_t* p = address(0, 0);
+  uint8_t* p = m_bits;
   std::fill(p, p + rowBytes() * height(), (color ? 0xff : 0x00));
 }
 
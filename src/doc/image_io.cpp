@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2019-2025  Igara Studio S.A.
+// Copyright (c) 2019-2026  Igara Studio S.A.
 // Copyright (c) 2001-2018  David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -15,6 +15,7 @@
 #include "base/serialization.h"
 #include "doc/cancel_io.h"
 #include "doc/image.h"
+#include "doc/image_ref.h"
 #include "zlib.h"
 
 #include <algorithm>
@@ -43,6 +44,14 @@ bool write_image_pixels(std::ostream& os, const Image* image, CancelIO* cancel)
   // Number of bytes for visible pixels on each row
   const int widthBytes = image->widthBytes();
 
+  // For uniform images we compress the same row for each scanline
+  // (instead of creating all the pixels of the image).
+  ImageRef uniformRow;
+  if (image->isUniform()) {
+    uniformRow.reset(Image::create(image->pixelFormat(), image->width(), 1));
+    uniformRow->clear(image->uniformColor());
+  }
+
 #if 0
   {
     for (int c=0; c<image->height(); c++)
@@ -70,7 +79,8 @@ bool write_image_pixels(std::ostream& os, const Image* image, CancelIO* cancel)
         return false;
       }
 
-      zstream.next_in = (Bytef*)image->getPixelAddress(0, y);
+      zstream.next_in = (Bytef*)(uniformRow ? uniformRow->getPixelAddress(0, 0) :
+                                              image->getPixelAddress(0, y));
       zstream.avail_in = widthBytes;
       int flush = (y == image->height() - 1 ? Z_FINISH : Z_NO_FLUSH);
 
@@ -0,0 +1,33 @@
+// Aseprite Document Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef DOC_IMAGE_LOADER_H_INCLUDED
+#define DOC_IMAGE_LOADER_H_INCLUDED
+#pragma once
+
+#include <memory>
+
+namespace doc {
+
+class Image;
+
+// Loads the pixels of a lazy image (see Image::createLazy()).
+class ImageLoader {
+public:
+  virtual ~ImageLoader() {}
+
+  // Fills the pixels of the given image (they are already allocated
+  // and cleared). It's called the first time the pixels are accessed
+  // and each time they are accessed after an Image::unload(). It
+  // must not throw exceptions.
+  virtual void loadPixels(Image* image) = 0;
+};
+
+using ImageLoaderPtr = std::shared_ptr<ImageLoader>;
+
+} // namespace doc
+
+#endif
@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2018-2025 Igara Studio S.A.
+// Copyright (c) 2018-2026 Igara Studio S.A.
 // Copyright (c) 2001-2018 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -283,6 +283,95 @@ TYPED_TEST(ImageAllTypesNoBitmap, NewIterators)
   }
 }
 
+TYPED_TEST(ImageAllTypes, Uniform)
+{
+  using ImageTraits = TypeParam;
+
+  ImageSpec spec(ImageTraits::color_mode, 33, 15);
+  ImageRef image(Image::createUniform(spec, 1));
+  EXPECT_TRUE(image->isUniform());
+  EXPECT_EQ(1, image->uniformColor());
+  EXPECT_LT(image->getMemSize(), spec.bytesPerPixel() * spec.width() * spec.height());
+
+  // Clear keeps the image uniform
+  image->clear(0);
+  EXPECT_TRUE(image->isUniform());
+  EXPECT_EQ(0, image->uniformColor());
+
+  // A copy is uniform too
+  ImageRef copy(Image::createCopy(image.get()));
+  EXPECT_TRUE(copy->isUniform());
+  EXPECT_EQ(0, copy->uniformColor());
+
+  // Accessing pixels creates them
+  image->clear(1);
+  EXPECT_EQ(1, get_pixel(image.get(), 32, 14));
+  EXPECT_FALSE(image->isUniform());
+  for (int y = 0; y < image->height(); ++y)
+    for (int x = 0; x < image->width(); ++x)
+      EXPECT_EQ(1, get_pixel(image.get(), x, y));
+
+  put_pixel(image.get(), 2, 3, 0);
+  EXPECT_EQ(0, get_pixel(image.get(), 2, 3));
+  EXPECT_TRUE(copy->isUniform());
+
+  // Copy a uniform image into a regular one
+  image->copy(copy.get(), gfx::Clip(1, 1, 0, 0, 4, 4));
+  EXPECT_EQ(1, get_pixel(image.get(), 0, 0));
+  EXPECT_EQ(0, get_pixel(image.get(), 1, 1));
+  EXPECT_EQ(0, get_pixel(image.get(), 4, 4));
+  EXPECT_EQ(1, get_pixel(image.get(), 5, 5));
+  EXPECT_TRUE(copy->isUniform());
+}
+
+TYPED_TEST(ImageAllTypes, Lazy)
+{
+  using ImageTraits = TypeParam;
+
+  struct Loader : public ImageLoader {
+    int loads = 0;
+    void loadPixels(Image* image) override
+    {
+      ++loads;
+      for (int y = 0; y < image->height(); ++y)
+        for (int x = 0; x < image->width(); ++x)
+          put_pixel(image, x, y, (x + y) & 1);
+    }
+  };
+
+  auto loader = std::make_shared<Loader>();
+  ImageSpec spec(ImageTraits::color_mode, 33, 15);
+  ImageRef image(Image::createLazy(spec, loader));
+  EXPECT_TRUE(image->isLazy());
+  EXPECT_FALSE(image->isLoaded());
+  EXPECT_EQ(0, loader->loads);
+
+  // Accessing pixels loads them
+  EXPECT_EQ(1, get_pixel(image.get(), 1, 0));
+  EXPECT_TRUE(image->isLoaded());
+  EXPECT_EQ(1, loader->loads);
+  for (int y = 0; y < image->height(); ++y)
+    for (int x = 0; x < image->width(); ++x)
+      EXPECT_EQ((x + y) & 1, get_pixel(image.get(), x, y));
+  EXPECT_EQ(1, loader->loads);
+
+  // Unloading releases the pixels, they are loaded again in the next
+  // access
+  const int loadedMemSize = image->getMemSize();
+  image->unload();
+  EXPECT_FALSE(image->isLoaded());
+  EXPECT_LT(image->getMemSize(), loadedMemSize);
+  EXPECT_EQ(0, get_pixel(image.get(), 32, 14));
+  EXPECT_EQ(2, loader->loads);
+
+  // A copy is a regular image
+  image->unload();
+  ImageRef copy(Image::createCopy(image.get()));
+  EXPECT_FALSE(copy->isLazy());
+  EXPECT_EQ(1, get_pixel(copy.get(), 0, 1));
+  EXPECT_EQ(3, loader->loads);
+}
+
 int main(int argc, char** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
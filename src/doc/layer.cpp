@@ -363,19 +363,19 @@ void Layer::moveCel(Cel* cel, frame_t frame)
 
 void Layer::displaceFrames(frame_t fromThis, frame_t delta)
 {
-  Sprite* sprite = this->sprite();
+  const frame_t lastFrame = sprite()->lastFrame();
 
-  if (delta > 0) {
-    for (frame_t c = sprite->lastFrame(); c >= fromThis; --c) {
-      if (Cel* cel = this->cel(c))
-        moveCel(cel, c + delta);
-    }
-  }
-  else {
-    for (frame_t c = fromThis; c <= sprite->lastFrame(); ++c) {
-      if (Cel* cel = this->cel(c))
-        moveCel(cel, c + delta);
-    }
+  // All cels from "fromThis" are displaced by the same delta, so the
+  // m_cels order doesn't change and we can modify the frame of each
+  // cel in place (instead of calling moveCel() for each frame, which
+  // re-inserts each cel in the vector).
+  for (auto it = findFirstCelIteratorAfter(fromThis - 1), end = getCelEnd(); it != end; ++it) {
+    Cel* cel = *it;
+    if (cel->frame() > lastFrame)
+      break;
+
+    cel->setFrame(cel->frame() + delta);
+    cel->incrementVersion(); // TODO this should be in app::cmd module
   }
 
   for (Layer* layer : m_layers)
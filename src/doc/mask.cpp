@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (C) 2019-2025  Igara Studio S.A.
+// Copyright (C) 2019-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -9,37 +9,41 @@
   #include "config.h"
 #endif
 
+#include "doc/algorithm/select_by_color.h"
 #include "doc/image.h"
 #include "doc/mask.h"
+#include "doc/mask_spans.h"
 #include "gfx/point.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <limits>
 
 namespace doc {
 
 namespace {
 
+// Combines the pixels of "a" with the pixels of "b" in the given area
+// (which must be inside the bounds of both masks). The bitmaps are
+// modified directly, which is faster than converting both masks to
+// spans and the result back to a bitmap.
 template<typename Func>
-void for_each_mask_pixel(Mask& a, const Mask& b, Func f)
+void for_each_mask_pixel(Mask& a, const Mask& b, const gfx::Rect& area, Func f)
 {
-  a.reserve(b.bounds());
-
-  {
-    LockImageBits<BitmapTraits> aBits(a.bitmap());
-    auto aIt = aBits.begin();
-
-    auto bounds = a.bounds();
-    for (int y = 0; y < bounds.h; ++y) {
-      for (int x = 0; x < bounds.w; ++x, ++aIt) {
-        color_t aColor = *aIt;
-        color_t bColor = (b.containsPoint(bounds.x + x, bounds.y + y) ? 1 : 0);
-        *aIt = f(aColor, bColor);
-      }
-    }
-  }
-
-  a.shrink();
+  const gfx::Rect& aBounds = a.bounds();
+  const gfx::Rect& bBounds = b.bounds();
+  LockImageBits<BitmapTraits> aBits(
+    a.bitmap(),
+    Image::ReadWriteLock,
+    gfx::Rect(area.x - aBounds.x, area.y - aBounds.y, area.w, area.h));
+  const LockImageBits<BitmapTraits> bBits(
+    b.bitmap(),
+    gfx::Rect(area.x - bBounds.x, area.y - bBounds.y, area.w, area.h));
+
+  auto bIt = bBits.begin();
+  for (auto aIt = aBits.begin(), aEnd = aBits.end(); aIt != aEnd; ++aIt, ++bIt)
+    *aIt = f(*aIt, *bIt);
 }
 
 } // namespace
@@ -177,6 +181,38 @@ void Mask::fromImage(const Image* image, const gfx::Point& maskOrigin, uint8_t a
   }
 }
 
+void Mask::fromSpans(const MaskSpans& spans)
+{
+  const gfx::Rect& bounds = spans.bounds();
+
+  // If the mask is frozen we keep its bounds (it's not shrunk)
+  if (m_freezes > 0) {
+    if (!bounds.isEmpty())
+      reserve(bounds);
+    if (!m_bitmap)
+      return;
+  }
+  else {
+    if (spans.isEmpty()) {
+      clear();
+      return;
+    }
+    m_bounds = bounds;
+    m_bitmap.reset(Image::create(IMAGE_BITMAP, bounds.w, bounds.h, m_buffer));
+  }
+
+  clear_image(m_bitmap.get(), 0);
+  for (int y = bounds.y; y < bounds.y2(); ++y) {
+    for (auto span = spans.rowBegin(y), end = spans.rowEnd(y); span != end; ++span) {
+      draw_hline(m_bitmap.get(),
+                 span->x1 - m_bounds.x,
+                 y - m_bounds.y,
+                 span->x2 - 1 - m_bounds.x,
+                 1);
+    }
+  }
+}
+
 void Mask::offsetOrigin(int dx, int dy)
 {
   m_bounds.offset(dx, dy);
@@ -217,22 +253,41 @@ void Mask::replace(const gfx::Rect& bounds)
 
 void Mask::add(const doc::Mask& mask)
 {
-  for_each_mask_pixel(*this, mask, [](color_t a, color_t b) -> color_t { return a | b; });
+  if (!mask.bitmap())
+    return;
+
+  reserve(mask.bounds());
+  for_each_mask_pixel(*this, mask, mask.bounds(), [](color_t a, color_t b) -> color_t {
+    return a | b;
+  });
 }
 
 void Mask::subtract(const doc::Mask& mask)
 {
-  for_each_mask_pixel(*this, mask, [](color_t a, color_t b) -> color_t {
-    if (a)
-      return a - b;
-    else
-      return 0;
+  if (!m_bitmap || !mask.bitmap())
+    return;
+
+  const gfx::Rect area = m_bounds.createIntersection(mask.bounds());
+  if (area.isEmpty())
+    return;
+
+  for_each_mask_pixel(*this, mask, area, [](color_t a, color_t b) -> color_t {
+    return (b ? 0 : a);
   });
+  shrink();
 }
 
 void Mask::intersect(const doc::Mask& mask)
 {
-  for_each_mask_pixel(*this, mask, [](color_t a, color_t b) -> color_t { return a & b; });
+  // Crop the bitmap to the intersection with the other mask (it's
+  // cleared if the other mask is empty)
+  intersect(mask.bounds());
+  if (!m_bitmap)
+    return;
+
+  const gfx::Rect area = m_bounds.createIntersection(mask.bounds());
+  for_each_mask_pixel(*this, mask, area, [](color_t a, color_t b) -> color_t { return a & b; });
+  shrink();
 }
 
 void Mask::add(const gfx::Rect& bounds)
@@ -291,110 +346,35 @@ void Mask::intersect(const gfx::Rect& bounds)
   shrink();
 }
 
-void Mask::byColor(const Image* src, int color, int fuzziness)
+bool Mask::byColor(const Image* src, int color, int fuzziness, CancelIO* cancel)
 {
-  replace(src->bounds());
-
-  Image* dst = m_bitmap.get();
-
   switch (src->pixelFormat()) {
-    case IMAGE_RGB: {
-      const LockImageBits<RgbTraits> srcBits(src);
-      LockImageBits<BitmapTraits> dstBits(dst, Image::WriteLock);
-      LockImageBits<RgbTraits>::const_iterator src_it = srcBits.begin(), src_end = srcBits.end();
-      LockImageBits<BitmapTraits>::iterator dst_it = dstBits.begin();
-#ifdef _DEBUG
-      LockImageBits<BitmapTraits>::iterator dst_end = dstBits.end();
-#endif
-      int src_r, src_g, src_b, src_a;
-      int dst_r, dst_g, dst_b, dst_a;
-      color_t c;
-
-      dst_r = rgba_getr(color);
-      dst_g = rgba_getg(color);
-      dst_b = rgba_getb(color);
-      dst_a = rgba_geta(color);
-
-      for (; src_it != src_end; ++src_it, ++dst_it) {
-        ASSERT(dst_it != dst_end);
-        c = *src_it;
-
-        src_r = rgba_getr(c);
-        src_g = rgba_getg(c);
-        src_b = rgba_getb(c);
-        src_a = rgba_geta(c);
-
-        if (!((src_r >= dst_r - fuzziness) && (src_r <= dst_r + fuzziness) &&
-              (src_g >= dst_g - fuzziness) && (src_g <= dst_g + fuzziness) &&
-              (src_b >= dst_b - fuzziness) && (src_b <= dst_b + fuzziness) &&
-              (src_a >= dst_a - fuzziness) && (src_a <= dst_a + fuzziness)))
-          *dst_it = 0;
-      }
-      ASSERT(dst_it == dst_end);
-      break;
-    }
-
-    case IMAGE_GRAYSCALE: {
-      const LockImageBits<GrayscaleTraits> srcBits(src);
-      LockImageBits<BitmapTraits> dstBits(dst, Image::WriteLock);
-      LockImageBits<GrayscaleTraits>::const_iterator src_it = srcBits.begin(),
-                                                     src_end = srcBits.end();
-      LockImageBits<BitmapTraits>::iterator dst_it = dstBits.begin();
-#ifdef _DEBUG
-      LockImageBits<BitmapTraits>::iterator dst_end = dstBits.end();
-#endif
-      int src_k, src_a;
-      int dst_k, dst_a;
-      color_t c;
-
-      dst_k = graya_getv(color);
-      dst_a = graya_geta(color);
-
-      for (; src_it != src_end; ++src_it, ++dst_it) {
-        ASSERT(dst_it != dst_end);
-        c = *src_it;
-
-        src_k = graya_getv(c);
-        src_a = graya_geta(c);
-
-        if (!((src_k >= dst_k - fuzziness) && (src_k <= dst_k + fuzziness) &&
-              (src_a >= dst_a - fuzziness) && (src_a <= dst_a + fuzziness)))
-          *dst_it = 0;
-      }
-      ASSERT(dst_it == dst_end);
-      break;
-    }
-
-    case IMAGE_INDEXED: {
-      const LockImageBits<IndexedTraits> srcBits(src);
-      LockImageBits<BitmapTraits> dstBits(dst, Image::WriteLock);
-      LockImageBits<IndexedTraits>::const_iterator src_it = srcBits.begin(),
-                                                   src_end = srcBits.end();
-      LockImageBits<BitmapTraits>::iterator dst_it = dstBits.begin();
-#ifdef _DEBUG
-      LockImageBits<BitmapTraits>::iterator dst_end = dstBits.end();
-#endif
-      color_t c, min, max;
-
-      for (; src_it != src_end; ++src_it, ++dst_it) {
-        ASSERT(dst_it != dst_end);
-        c = *src_it;
-
-        if (color > fuzziness)
-          min = color - fuzziness;
-        else
-          min = 0;
-        max = color + fuzziness;
+    case IMAGE_RGB:
+    case IMAGE_GRAYSCALE:
+    case IMAGE_INDEXED:   break;
+    default:
+      replace(src->bounds());
+      shrink();
+      return true;
+  }
 
-        if (!((c >= min) && (c <= max)))
-          *dst_it = 0;
-      }
-      ASSERT(dst_it == dst_end);
-      break;
-    }
+  // The whole bitmap is overwritten by select_by_color()
+  m_bounds = src->bounds();
+  m_bitmap.reset(Image::create(IMAGE_BITMAP, m_bounds.w, m_bounds.h, m_buffer));
+
+  if (!algorithm::select_by_color(src,
+                                  src->bounds(),
+                                  color,
+                                  fuzziness,
+                                  false,
+                                  m_bitmap.get(),
+                                  cancel)) {
+    clear();
+    return false;
   }
 
   shrink();
+  return true;
 }
 
 void Mask::crop(const Image* image)
@@ -485,6 +465,49 @@ void Mask::shrink()
   if (m_freezes > 0)
     return;
 
+  int u, v, x1, y1, x2, y2;
+
+#if DOC_USE_BITMAP_AS_1BPP
+
+  // Look for the selected pixels checking whole bytes (8 pixels) of
+  // each row of the bitmap
+  x1 = y1 = std::numeric_limits<int>::max();
+  x2 = y2 = std::numeric_limits<int>::min();
+  if (m_bitmap) {
+    const int widthBytes = (m_bounds.w + 7) / 8;
+    // Ignore bits outside the bitmap in the last byte of each row
+    const uint8_t lastByteMask = uint8_t(0xff >> ((8 - (m_bounds.w & 7)) & 7));
+
+    for (v = 0; v < m_bounds.h; ++v) {
+      const uint8_t* row = m_bitmap->getPixelAddress(0, v);
+      auto byte_at = [row, widthBytes, lastByteMask](int i) -> uint8_t {
+        return (i == widthBytes - 1 ? row[i] & lastByteMask : row[i]);
+      };
+
+      int first = 0;
+      while (first < widthBytes && byte_at(first) == 0)
+        ++first;
+      if (first == widthBytes)
+        continue;
+
+      int last = widthBytes - 1;
+      while (byte_at(last) == 0)
+        --last;
+
+      for (u = 0; (byte_at(first) & (1 << u)) == 0; ++u)
+        ;
+      x1 = std::min(x1, m_bounds.x + first * 8 + u);
+      for (u = 7; (byte_at(last) & (1 << u)) == 0; --u)
+        ;
+      x2 = std::max(x2, m_bounds.x + last * 8 + u);
+
+      y1 = std::min(y1, m_bounds.y + v);
+      y2 = m_bounds.y + v;
+    }
+  }
+
+#else
+
 #define SHRINK_SIDE(u_begin, u_op, u_final, u_add, v_begin, v_op, v_final, v_add, U, V, var)       \
   {                                                                                                \
     for (u = u_begin; u u_op u_final; u u_add) {                                                   \
@@ -499,8 +522,6 @@ void Mask::shrink()
     }                                                                                              \
   }
 
-  int u, v, x1, y1, x2, y2;
-
   x1 = m_bounds.x;
   y1 = m_bounds.y;
   x2 = m_bounds.x + m_bounds.w - 1;
@@ -514,6 +535,10 @@ void Mask::shrink()
 
   SHRINK_SIDE(m_bounds.h - 1, >, 0, --, 0, <, m_bounds.w, ++, v, u, y2--);
 
+#undef SHRINK_SIDE
+
+#endif
+
   if ((x1 > x2) || (y1 > y2)) {
     clear();
   }
@@ -531,8 +556,6 @@ void Mask::shrink()
       crop_image(m_bitmap.get(), m_bounds.x - u, m_bounds.y - v, m_bounds.w, m_bounds.h, 0);
     m_bitmap.reset(image);
   }
-
-#undef SHRINK_SIDE
 }
 
 } // namespace doc
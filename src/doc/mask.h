@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2020-2025 Igara Studio S.A.
+// Copyright (c) 2020-2026 Igara Studio S.A.
 // Copyright (c) 2001-2018 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -19,6 +19,8 @@
 #include <string>
 
 namespace doc {
+class CancelIO;
+class MaskSpans;
 
 // Represents the selection (selected pixels, 0/1, 0=non-selected, 1=selected)
 //
@@ -77,6 +79,10 @@ public:
   void copyFrom(const Mask* sourceMask);
   void fromImage(const Image* image, const gfx::Point& maskOrigin, uint8_t alphaThreshold = 0);
 
+  // Converts the run-length representation of a selection to the
+  // bitmap of this mask.
+  void fromSpans(const MaskSpans& spans);
+
   // Replace the whole mask with the given region.
   void replace(const gfx::Rect& bounds);
   void replace(const doc::Mask& sourceMask) { copyFrom(&sourceMask); }
@@ -92,7 +98,10 @@ public:
   void subtract(const gfx::Rect& bounds);
   void intersect(const gfx::Rect& bounds);
 
-  void byColor(const Image* image, int color, int fuzziness);
+  // Selects the pixels of the image similar to the given color.
+  // Returns false if the operation was canceled (the mask is empty
+  // in that case).
+  bool byColor(const Image* image, int color, int fuzziness, CancelIO* cancel = nullptr);
   void crop(const Image* image);
 
   // Reserves a rectangle to draw onto the bitmap (you should call
@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2025 Igara Studio S.A.
+// Copyright (c) 2025-2026 Igara Studio S.A.
 // Copyright (c) 2001-2015 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -13,6 +13,7 @@
 
 #include "doc/image.h"
 #include "doc/mask.h"
+#include "doc/mask_spans.h"
 
 namespace doc {
 
@@ -31,8 +32,72 @@ void MaskBoundaries::regen(const Mask* mask)
   if (!mask || mask->isEmpty())
     return;
 
-  regen(mask->bitmap());
-  offset(mask->bounds().x, mask->bounds().y);
+  // Converting the bitmap to spans skips big uniform areas of the
+  // mask, and then the segments are created from the spans.
+  regen(MaskSpans(*mask));
+}
+
+void MaskBoundaries::regen(const MaskSpans& spans)
+{
+  reset();
+
+  if (spans.isEmpty())
+    return;
+
+  // Vertical segments of the previous row (to be expanded with the
+  // vertical edges of the current row at the same X position).
+  struct VertSeg {
+    int x;
+    bool open;
+    int seg;
+  };
+  std::vector<VertSeg> prevVertSegs, vertSegs;
+  std::vector<MaskSpans::Span> horzSpans;
+
+  const gfx::Rect& bounds = spans.bounds();
+  for (int y = bounds.y; y <= bounds.y2(); ++y) {
+    const MaskSpans::Span* prevRow = spans.rowBegin(y - 1);
+    const MaskSpans::Span* prevRowEnd = spans.rowEnd(y - 1);
+    const MaskSpans::Span* row = spans.rowBegin(y);
+    const MaskSpans::Span* rowEnd = spans.rowEnd(y);
+
+    // Horizontal segments between the previous row and this one,
+    // they are open when the pixels below them are selected.
+    for (const bool open : { true, false }) {
+      horzSpans.clear();
+      MaskSpans::combineRows(
+        prevRow,
+        prevRowEnd,
+        row,
+        rowEnd,
+        [open](bool prev, bool cur) { return (open ? !prev && cur : prev && !cur); },
+        horzSpans);
+      for (const auto& span : horzSpans)
+        m_segs.push_back(Segment(open, gfx::Rect(span.x1, y, span.x2 - span.x1, 0)));
+    }
+
+    // Vertical segments at the left (open) and right side of each
+    // span of this row.
+    vertSegs.clear();
+    auto prevIt = prevVertSegs.begin();
+    auto addVertSeg = [&](const int x, const bool open) {
+      while (prevIt != prevVertSegs.end() && prevIt->x < x)
+        ++prevIt;
+      if (prevIt != prevVertSegs.end() && prevIt->x == x && prevIt->open == open) {
+        ++m_segs[prevIt->seg].m_bounds.h;
+        vertSegs.push_back(*prevIt);
+      }
+      else {
+        m_segs.push_back(Segment(open, gfx::Rect(x, y, 0, 1)));
+        vertSegs.push_back(VertSeg{ x, open, int(m_segs.size() - 1) });
+      }
+    };
+    for (; row != rowEnd; ++row) {
+      addVertSeg(row->x1, true);
+      addVertSeg(row->x2, false);
+    }
+    std::swap(prevVertSegs, vertSegs);
+  }
 }
 
 void MaskBoundaries::regen(const Image* bitmap)
@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2020-2025 Igara Studio S.A.
+// Copyright (c) 2020-2026 Igara Studio S.A.
 // Copyright (c) 2001-2015 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -17,6 +17,7 @@
 namespace doc {
 class Image;
 class Mask;
+class MaskSpans;
 
 class MaskBoundaries {
 public:
@@ -47,6 +48,9 @@ public:
   void reset();
   void regen(const Mask* mask);
   void regen(const Image* bitmap);
+  // Generates the boundaries directly from the spans of the mask (the
+  // segments are in the same coordinates of the spans).
+  void regen(const MaskSpans& spans);
 
   const_iterator begin() const { return m_segs.begin(); }
   const_iterator end() const { return m_segs.end(); }
@@ -0,0 +1,219 @@
+// Aseprite Document Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "doc/mask_spans.h"
+
+#include "doc/image.h"
+#include "doc/mask.h"
+#include "doc/primitives_fast.h"
+
+#include <utility>
+
+namespace doc {
+
+MaskSpans::MaskSpans(const gfx::Rect& bounds)
+{
+  if (bounds.isEmpty())
+    return;
+
+  m_bounds = bounds;
+  m_rowIndexes.resize(bounds.h + 1);
+  m_spans.resize(bounds.h, Span{ bounds.x, bounds.x2() });
+  for (int i = 0; i <= bounds.h; ++i)
+    m_rowIndexes[i] = i;
+}
+
+MaskSpans::MaskSpans(const Mask& mask)
+{
+  if (!mask.isEmpty())
+    *this = MaskSpans(mask.bitmap(), mask.origin());
+}
+
+MaskSpans::MaskSpans(const Image* bitmap, const gfx::Point& origin)
+{
+  ASSERT(bitmap);
+  ASSERT(bitmap->pixelFormat() == IMAGE_BITMAP);
+
+  const int w = bitmap->width();
+  const int h = bitmap->height();
+  std::vector<int> rowIndexes;
+  std::vector<Span> spans;
+  rowIndexes.reserve(h + 1);
+
+  for (int y = 0; y < h; ++y) {
+    rowIndexes.push_back(int(spans.size()));
+
+    bool inside = false;
+    int x1 = 0;
+    for (int x = 0; x < w;) {
+#if DOC_USE_BITMAP_AS_1BPP
+      // Skip whole bytes without changes (8 pixels at once)
+      if ((x & 7) == 0 && x + 8 <= w) {
+        const uint8_t byte = *bitmap->getPixelAddress(x, y);
+        if (byte == (inside ? 0xff : 0)) {
+          x += 8;
+          continue;
+        }
+      }
+#endif
+      const bool selected = (get_pixel_fast<BitmapTraits>(bitmap, x, y) != 0);
+      if (selected != inside) {
+        if (selected)
+          x1 = x;
+        else
+          spans.push_back(Span{ origin.x + x1, origin.x + x });
+        inside = selected;
+      }
+      ++x;
+    }
+    if (inside)
+      spans.push_back(Span{ origin.x + x1, origin.x + w });
+  }
+  rowIndexes.push_back(int(spans.size()));
+
+  setRows(origin.y, std::move(rowIndexes), std::move(spans));
+}
+
+int MaskSpans::getMemSize() const
+{
+  return sizeof(MaskSpans) + int(m_rowIndexes.capacity() * sizeof(int)) +
+         int(m_spans.capacity() * sizeof(Span));
+}
+
+bool MaskSpans::containsPoint(int x, int y) const
+{
+  if (!m_bounds.contains(gfx::Point(x, y)))
+    return false;
+
+  // Find the first span which ends after x
+  const Span* end = rowEnd(y);
+  const Span* span =
+    std::upper_bound(rowBegin(y), end, x, [](int u, const Span& span) { return u < span.x2; });
+  return (span != end && span->x1 <= x);
+}
+
+const MaskSpans::Span* MaskSpans::rowBegin(int y) const
+{
+  if (y < m_bounds.y || y >= m_bounds.y2())
+    return nullptr;
+  return m_spans.data() + m_rowIndexes[y - m_bounds.y];
+}
+
+const MaskSpans::Span* MaskSpans::rowEnd(int y) const
+{
+  if (y < m_bounds.y || y >= m_bounds.y2())
+    return nullptr;
+  return m_spans.data() + m_rowIndexes[y - m_bounds.y + 1];
+}
+
+void MaskSpans::clear()
+{
+  m_bounds = gfx::Rect(0, 0, 0, 0);
+  m_rowIndexes.clear();
+  m_spans.clear();
+}
+
+void MaskSpans::offsetOrigin(int dx, int dy)
+{
+  m_bounds.offset(dx, dy);
+  for (Span& span : m_spans) {
+    span.x1 += dx;
+    span.x2 += dx;
+  }
+}
+
+void MaskSpans::add(const MaskSpans& other)
+{
+  combine(other, [](bool a, bool b) { return a || b; });
+}
+
+void MaskSpans::subtract(const MaskSpans& other)
+{
+  combine(other, [](bool a, bool b) { return a && !b; });
+}
+
+void MaskSpans::intersect(const MaskSpans& other)
+{
+  combine(other, [](bool a, bool b) { return a && b; });
+}
+
+void MaskSpans::invert(const gfx::Rect& area)
+{
+  combine(MaskSpans(area), [](bool a, bool b) { return !a && b; });
+}
+
+template<typename Op>
+void MaskSpans::combine(const MaskSpans& other, Op op)
+{
+  // Rows that can contain selected pixels in the result
+  gfx::Rect area;
+  if (op(true, false))
+    area |= m_bounds;
+  if (op(false, true))
+    area |= other.m_bounds;
+  if (op(true, true) && !op(true, false) && !op(false, true))
+    area = m_bounds.createIntersection(other.m_bounds);
+  if (area.isEmpty()) {
+    clear();
+    return;
+  }
+
+  std::vector<int> rowIndexes;
+  std::vector<Span> spans;
+  rowIndexes.reserve(area.h + 1);
+  spans.reserve(m_spans.size() + other.m_spans.size());
+
+  for (int y = area.y; y < area.y2(); ++y) {
+    rowIndexes.push_back(int(spans.size()));
+    combineRows(rowBegin(y), rowEnd(y), other.rowBegin(y), other.rowEnd(y), op, spans);
+  }
+  rowIndexes.push_back(int(spans.size()));
+
+  setRows(area.y, std::move(rowIndexes), std::move(spans));
+}
+
+// Removes empty rows from the top and bottom, and calculates the
+// bounds of the given spans.
+void MaskSpans::setRows(int y, std::vector<int>&& rowIndexes, std::vector<Span>&& spans)
+{
+  ASSERT(!rowIndexes.empty());
+
+  const int h = int(rowIndexes.size()) - 1;
+  int top = 0;
+  int bottom = h;
+  while (top < h && rowIndexes[top] == rowIndexes[top + 1])
+    ++top;
+  while (bottom > top && rowIndexes[bottom - 1] == rowIndexes[bottom])
+    --bottom;
+  if (top == bottom) {
+    clear();
+    return;
+  }
+
+  if (top > 0 || bottom < h) {
+    rowIndexes.erase(rowIndexes.begin() + bottom + 1, rowIndexes.end());
+    rowIndexes.erase(rowIndexes.begin(), rowIndexes.begin() + top);
+  }
+
+  int x1 = std::numeric_limits<int>::max();
+  int x2 = std::numeric_limits<int>::min();
+  for (int i = 0; i < bottom - top; ++i) {
+    if (rowIndexes[i] < rowIndexes[i + 1]) {
+      x1 = std::min(x1, spans[rowIndexes[i]].x1);
+      x2 = std::max(x2, spans[rowIndexes[i + 1] - 1].x2);
+    }
+  }
+
+  m_bounds = gfx::Rect(x1, y + top, x2 - x1, bottom - top);
+  m_rowIndexes = std::move(rowIndexes);
+  m_spans = std::move(spans);
+}
+
+} // namespace doc
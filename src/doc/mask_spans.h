@@ -0,0 +1,121 @@
+// Aseprite Document Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef DOC_MASK_SPANS_H_INCLUDED
+#define DOC_MASK_SPANS_H_INCLUDED
+#pragma once
+
+#include "base/debug.h"
+#include "gfx/point.h"
+#include "gfx/rect.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace doc {
+class Image;
+class Mask;
+
+// Run-length representation of a selection: each row of the mask is
+// a sorted list of horizontal spans of selected pixels. Boolean
+// operations are proportional to the number of spans (instead of the
+// number of pixels), so it's a lot cheaper than a bitmap for big
+// selections. Use Mask::fromSpans() to convert it to a bitmap.
+class MaskSpans {
+public:
+  // Selected pixels in [x1, x2) (absolute coordinates). Spans of the
+  // same row are sorted, and they don't overlap nor touch each other.
+  struct Span {
+    int x1, x2;
+    bool operator==(const Span& other) const { return x1 == other.x1 && x2 == other.x2; }
+  };
+
+  MaskSpans() {}
+  explicit MaskSpans(const gfx::Rect& bounds);
+  explicit MaskSpans(const Mask& mask);
+  MaskSpans(const Image* bitmap, const gfx::Point& origin);
+
+  bool isEmpty() const { return m_spans.empty(); }
+  const gfx::Rect& bounds() const { return m_bounds; }
+  int spansCount() const { return int(m_spans.size()); }
+  int getMemSize() const;
+
+  bool containsPoint(int x, int y) const;
+
+  // Spans of the given row (absolute "y" coordinate). Rows outside
+  // the bounds are empty.
+  const Span* rowBegin(int y) const;
+  const Span* rowEnd(int y) const;
+
+  void clear();
+  void offsetOrigin(int dx, int dy);
+
+  void add(const MaskSpans& other);
+  void subtract(const MaskSpans& other);
+  void intersect(const MaskSpans& other);
+
+  // Inverts the selection inside the given area (the result is
+  // always inside the area).
+  void invert(const gfx::Rect& area);
+
+  // Combines two rows of spans with the given boolean operation,
+  // op(inA, inB), adding the resulting spans to "out". op(false,
+  // false) must be false.
+  template<typename Op>
+  static void combineRows(const Span* a,
+                          const Span* aEnd,
+                          const Span* b,
+                          const Span* bEnd,
+                          Op op,
+                          std::vector<Span>& out)
+  {
+    bool inA = false;
+    bool inB = false;
+    bool in = false;
+    int x1 = 0;
+    while (a != aEnd || b != bEnd) {
+      // Next edge of each row
+      const int ax = (a != aEnd ? (inA ? a->x2 : a->x1) : std::numeric_limits<int>::max());
+      const int bx = (b != bEnd ? (inB ? b->x2 : b->x1) : std::numeric_limits<int>::max());
+      const int x = std::min(ax, bx);
+      if (ax == x) {
+        if (inA)
+          ++a;
+        inA = !inA;
+      }
+      if (bx == x) {
+        if (inB)
+          ++b;
+        inB = !inB;
+      }
+      const bool result = op(inA, inB);
+      if (result != in) {
+        if (result)
+          x1 = x;
+        else
+          out.push_back(Span{ x1, x });
+        in = result;
+      }
+    }
+    ASSERT(!in);
+  }
+
+private:
+  template<typename Op>
+  void combine(const MaskSpans& other, Op op);
+  void setRows(int y, std::vector<int>&& rowIndexes, std::vector<Span>&& spans);
+
+  gfx::Rect m_bounds;
+  // Spans of the row "m_bounds.y+i" are in the range
+  // [m_spans[m_rowIndexes[i]], m_spans[m_rowIndexes[i+1]])
+  std::vector<int> m_rowIndexes;
+  std::vector<Span> m_spans;
+};
+
+} // namespace doc
+
+#endif
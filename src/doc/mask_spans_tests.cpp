@@ -0,0 +1,165 @@
+// Aseprite Document Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include <gtest/gtest.h>
+
+#include "doc/mask.h"
+#include "doc/mask_boundaries.h"
+#include "doc/mask_spans.h"
+
+#include <set>
+#include <tuple>
+
+using namespace doc;
+
+// Random mask with holes
+static void fill_mask(Mask& mask, const gfx::Rect& bounds, unsigned seed)
+{
+  mask.replace(bounds);
+  for (int y = 0; y < bounds.h; ++y) {
+    for (int x = 0; x < bounds.w; ++x) {
+      seed = seed * 1103515245 + 12345;
+      if (((seed >> 16) & 3) == 0)
+        mask.bitmap()->putPixel(x, y, 0);
+    }
+  }
+  mask.shrink();
+}
+
+static void expect_same_pixels(const Mask& mask, const MaskSpans& spans)
+{
+  ASSERT_EQ(mask.isEmpty(), spans.isEmpty());
+  if (mask.isEmpty())
+    return;
+
+  EXPECT_EQ(mask.bounds(), spans.bounds());
+  const gfx::Rect bounds = mask.bounds().createUnion(spans.bounds()).enlarge(1);
+  for (int y = bounds.y; y < bounds.y2(); ++y) {
+    for (int x = bounds.x; x < bounds.x2(); ++x) {
+      ASSERT_EQ(mask.containsPoint(x, y), spans.containsPoint(x, y)) << "x=" << x << " y=" << y;
+    }
+  }
+}
+
+TEST(MaskSpans, Rect)
+{
+  MaskSpans spans(gfx::Rect(2, 3, 4, 5));
+  EXPECT_FALSE(spans.isEmpty());
+  EXPECT_EQ(gfx::Rect(2, 3, 4, 5), spans.bounds());
+  EXPECT_EQ(5, spans.spansCount());
+  EXPECT_TRUE(spans.containsPoint(2, 3));
+  EXPECT_TRUE(spans.containsPoint(5, 7));
+  EXPECT_FALSE(spans.containsPoint(6, 7));
+  EXPECT_FALSE(spans.containsPoint(5, 8));
+
+  spans.subtract(MaskSpans(gfx::Rect(3, 3, 2, 5)));
+  EXPECT_EQ(gfx::Rect(2, 3, 4, 5), spans.bounds());
+  EXPECT_EQ(10, spans.spansCount());
+  EXPECT_FALSE(spans.containsPoint(3, 4));
+
+  spans.intersect(MaskSpans(gfx::Rect(0, 0, 3, 5)));
+  EXPECT_EQ(gfx::Rect(2, 3, 1, 2), spans.bounds());
+
+  spans.invert(gfx::Rect(2, 3, 1, 2));
+  EXPECT_TRUE(spans.isEmpty());
+}
+
+TEST(MaskSpans, BooleanOperations)
+{
+  Mask a, b;
+  fill_mask(a, gfx::Rect(-3, 2, 40, 30), 1);
+  fill_mask(b, gfx::Rect(10, -5, 25, 45), 2);
+
+  const MaskSpans sa(a);
+  const MaskSpans sb(b);
+  expect_same_pixels(a, sa);
+  expect_same_pixels(b, sb);
+
+  // Expected results are computed pixel by pixel from the original
+  // masks, and compared with MaskSpans and Mask operations (which
+  // modify the bitmap directly)
+  const gfx::Rect area = a.bounds().createUnion(b.bounds()).enlarge(1);
+  for (int i = 0; i < 3; ++i) {
+    MaskSpans spans(sa);
+    Mask direct(a);
+    switch (i) {
+      case 0:
+        spans.add(sb);
+        direct.add(b);
+        break;
+      case 1:
+        spans.subtract(sb);
+        direct.subtract(b);
+        break;
+      case 2:
+        spans.intersect(sb);
+        direct.intersect(b);
+        break;
+    }
+
+    Mask converted;
+    converted.fromSpans(spans);
+    EXPECT_EQ(spans.bounds(), direct.bounds()) << "i=" << i;
+
+    for (int y = area.y; y < area.y2(); ++y) {
+      for (int x = area.x; x < area.x2(); ++x) {
+        const bool ina = a.containsPoint(x, y);
+        const bool inb = b.containsPoint(x, y);
+        bool expected = false;
+        switch (i) {
+          case 0: expected = (ina || inb); break;
+          case 1: expected = (ina && !inb); break;
+          case 2: expected = (ina && inb); break;
+        }
+        ASSERT_EQ(expected, spans.containsPoint(x, y)) << "i=" << i << " x=" << x << " y=" << y;
+        ASSERT_EQ(expected, converted.containsPoint(x, y))
+          << "i=" << i << " x=" << x << " y=" << y;
+        ASSERT_EQ(expected, direct.containsPoint(x, y)) << "i=" << i << " x=" << x << " y=" << y;
+      }
+    }
+  }
+
+  MaskSpans spans(sa);
+  spans.invert(a.bounds());
+  for (int y = area.y; y < area.y2(); ++y) {
+    for (int x = area.x; x < area.x2(); ++x) {
+      const bool expected = (a.bounds().contains(gfx::Point(x, y)) && !a.containsPoint(x, y));
+      ASSERT_EQ(expected, spans.containsPoint(x, y)) << "x=" << x << " y=" << y;
+    }
+  }
+}
+
+TEST(MaskSpans, Boundaries)
+{
+  Mask mask;
+  fill_mask(mask, gfx::Rect(5, 7, 33, 21), 3);
+
+  // Boundaries generated from the bitmap and from the spans must
+  // contain the same segments
+  MaskBoundaries fromBitmap, fromSpans;
+  fromBitmap.regen(mask.bitmap());
+  fromBitmap.offset(mask.bounds().x, mask.bounds().y);
+  fromSpans.regen(MaskSpans(mask));
+
+  using Seg = std::tuple<bool, int, int, int, int>;
+  std::multiset<Seg> a, b;
+  for (const auto& seg : fromBitmap)
+    a.insert(Seg(seg.open(), seg.bounds().x, seg.bounds().y, seg.bounds().w, seg.bounds().h));
+  for (const auto& seg : fromSpans)
+    b.insert(Seg(seg.open(), seg.bounds().x, seg.bounds().y, seg.bounds().w, seg.bounds().h));
+  EXPECT_FALSE(a.empty());
+  EXPECT_EQ(a, b);
+}
+
+int main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (c) 2020-2024 Igara Studio S.A.
+// Copyright (c) 2020-2026 Igara Studio S.A.
 //
 // This file is released under the terms of the MIT license.
 // Read LICENSE.txt for more information.
@@ -17,113 +17,131 @@
 namespace doc {
 
 //////////////////////////////////////////////////////////////////////
-// OctreeNode
+// OctreeMap::Node
 
-void OctreeNode::addColor(color_t c, int level, OctreeNode* parent, int paletteIndex, int levelDeep)
+void OctreeMap::Node::add(const Node& leaf)
+{
+  r += leaf.r;
+  g += leaf.g;
+  b += leaf.b;
+  a += leaf.a;
+  pixelCount += leaf.pixelCount;
+}
+
+color_t OctreeMap::Node::rgbaColor() const
+{
+  ASSERT(pixelCount > 0);
+
+  // Average of each component rounded up only when the remainder is
+  // greater than the half of the pixel count
+  auto average = [n = pixelCount](const uint64_t sum) -> int {
+    return int(sum / n + (sum % n > n / 2 ? 1 : 0));
+  };
+  return rgba(average(r), average(g), average(b), average(a));
+}
+
+//////////////////////////////////////////////////////////////////////
+// OctreeMap
+
+OctreeMap::OctreeMap() : m_nodes(1)
 {
-  m_parent = parent;
-  if (level >= levelDeep) {
-    m_leafColor.add(c);
-    m_paletteIndex = paletteIndex;
-    return;
-  }
-  int index = getHextet(c, level);
-  if (!m_children) {
-    m_children.reset(new std::array<OctreeNode, 16>());
-  }
-  (*m_children)[index].addColor(c, level + 1, this, paletteIndex, levelDeep);
 }
 
-int OctreeNode::mapColor(int r,
-                         int g,
-                         int b,
-                         int a,
-                         int mask_index,
-                         const Palette* palette,
-                         int level,
-                         const OctreeMap* octree) const
+void OctreeMap::addColor(const color_t color, const int levelDeep, const std::size_t count)
 {
-  // New behavior: if mapColor do not have an exact rgba match, it must calculate which
-  // color of the current palette is the bestfit and memorize the index in a octree leaf.
-  if (level >= 8) {
-    if (m_paletteIndex == -1)
-      m_paletteIndex = octree->findBestfit(r, g, b, a, mask_index);
-    return m_paletteIndex;
+  insertColor(color, levelDeep, 0, count);
+}
+
+void OctreeMap::insertColor(const color_t c,
+                            const int levelDeep,
+                            const int paletteIndex,
+                            const std::size_t count)
+{
+  NodeIndex node = kRoot;
+  for (int level = 0; level < levelDeep; ++level) {
+    NodeIndex children = m_nodes[node].children;
+    if (children == kNoChildren)
+      children = createChildren(node);
+    node = children + getHextet(c, level);
   }
-  int index = getHextet(r, g, b, a, level);
-  if (!m_children)
-    m_children.reset(new std::array<OctreeNode, 16>());
-  return (*m_children)[index].mapColor(r, g, b, a, mask_index, palette, level + 1, octree);
+
+  Node& leaf = m_nodes[node];
+  leaf.r += uint64_t(rgba_getr(c)) * count;
+  leaf.g += uint64_t(rgba_getg(c)) * count;
+  leaf.b += uint64_t(rgba_getb(c)) * count;
+  leaf.a += uint64_t(rgba_geta(c)) * count;
+  leaf.pixelCount += count;
+  leaf.paletteIndex = paletteIndex;
 }
 
-void OctreeNode::collectLeafNodes(OctreeNodes& leavesVector, int& paletteIndex)
+// Creates the 16 children of the given node at the end of the array
+// of nodes (references to nodes are invalidated) and returns the
+// index of the first child.
+OctreeMap::NodeIndex OctreeMap::createChildren(const NodeIndex node) const
 {
+  ASSERT(!m_nodes[node].hasChildren());
+
+  const NodeIndex children = NodeIndex(m_nodes.size());
+  m_nodes.resize(m_nodes.size() + 16);
+  for (int i = 0; i < 16; ++i)
+    m_nodes[children + i].parent = node;
+  m_nodes[node].children = children;
+  return children;
+}
+
+void OctreeMap::collectLeafNodes(const NodeIndex node, int& paletteIndex)
+{
+  const NodeIndex children = m_nodes[node].children;
   for (int i = 0; i < 16; i++) {
-    OctreeNode& child = (*m_children)[i];
+    const NodeIndex child = children + i;
 
-    if (child.isLeaf()) {
-      child.paletteIndex(paletteIndex);
-      leavesVector.push_back(&child);
+    if (m_nodes[child].isLeaf()) {
+      m_nodes[child].paletteIndex = paletteIndex;
+      m_leavesVector.push_back(child);
       paletteIndex++;
     }
-    else if (child.hasChildren()) {
-      child.collectLeafNodes(leavesVector, paletteIndex);
+    else if (m_nodes[child].hasChildren()) {
+      collectLeafNodes(child, paletteIndex);
     }
   }
 }
 
 // removeLeaves(): remove leaves from a common parent
 // auxParentVector: i/o addreess of an auxiliary parent leaf Vector from outside this function.
-// rootLeavesVector: i/o address of the m_root->m_leavesVector
-int OctreeNode::removeLeaves(OctreeNodes& auxParentVector, OctreeNodes& rootLeavesVector)
+int OctreeMap::removeLeaves(const NodeIndex node, NodeIndexes& auxParentVector)
 {
-  // Apply to OctreeNode which has children which are leaf nodes
+  // Apply to nodes which have children which are leaf nodes
   int result = 0;
+  const NodeIndex children = m_nodes[node].children;
   for (int i = 15; i >= 0; i--) {
-    OctreeNode& child = (*m_children)[i];
+    const NodeIndex child = children + i;
 
-    if (child.isLeaf()) {
-      m_leafColor.add(child.leafColor());
+    if (m_nodes[child].isLeaf()) {
+      m_nodes[node].add(m_nodes[child]);
       result++;
-      if (rootLeavesVector[rootLeavesVector.size() - 1] == &child)
-        rootLeavesVector.pop_back();
+      if (!m_leavesVector.empty() && m_leavesVector.back() == child)
+        m_leavesVector.pop_back();
     }
   }
-  auxParentVector.push_back(this);
+  auxParentVector.push_back(node);
   return result - 1;
 }
 
 // static
-int OctreeNode::getHextet(color_t c, int level)
+int OctreeMap::getHextet(color_t c, int level)
 {
   return ((c & (0x00000080 >> level)) ? 1 : 0) | ((c & (0x00008000 >> level)) ? 2 : 0) |
          ((c & (0x00800000 >> level)) ? 4 : 0) | ((c & (0x80000000 >> level)) ? 8 : 0);
 }
 
-int OctreeNode::getHextet(int r, int g, int b, int a, int level)
-{
-  return ((r & (0x80 >> level)) ? 1 : 0) | ((g & (0x80 >> level)) ? 2 : 0) |
-         ((b & (0x80 >> level)) ? 4 : 0) | ((a & (0x80 >> level)) ? 8 : 0);
-}
-
-// static
-color_t OctreeNode::hextetToBranchColor(int hextet, int level)
-{
-  return ((hextet & 1) ? 0x00000080 >> level : 0) | ((hextet & 2) ? 0x00008000 >> level : 0) |
-         ((hextet & 4) ? 0x00800000 >> level : 0) | ((hextet & 8) ? 0x80000000 >> level : 0);
-}
-
-//////////////////////////////////////////////////////////////////////
-// OctreeMap
-
 bool OctreeMap::makePalette(Palette* palette, int colorCount, const int levelDeep)
 {
-  if (m_root.hasChildren()) {
+  if (m_nodes[kRoot].hasChildren()) {
     // We create paletteIndex to get a "global like" variable, in collectLeafNodes
     // function, the purpose is having a incremental variable in the stack memory
     // sharend between all recursive calls of collectLeafNodes.
     int paletteIndex = 0;
-    m_root.collectLeafNodes(m_leavesVector, paletteIndex);
+    collectLeafNodes(kRoot, paletteIndex);
   }
 
   if (m_maskColor != DOC_OCTREE_IS_OPAQUE)
@@ -135,7 +153,7 @@ bool OctreeMap::makePalette(Palette* palette, int colorCount, const int levelDee
   if (levelDeep == 7 && m_leavesVector.size() < colorCount)
     return false;
 
-  OctreeNodes auxLeavesVector; // auxiliary collapsed node accumulator
+  NodeIndexes auxLeavesVector; // auxiliary collapsed node accumulator
   bool keepReducingMap = true;
 
   for (int level = levelDeep; level > -1; level--) {
@@ -153,17 +171,17 @@ bool OctreeMap::makePalette(Palette* palette, int colorCount, const int levelDee
         // So, we have to reduce color with other method:
         // Sort colors by pixelCount (most pixelCount on front of sortedVector),
         // then:
-        // Blend in pairs from the least pixelCount colors.
+        // Discard the least pixelCount colors.
         if (auxLeavesVector.size() <= 16 && colorCount < 16 && colorCount > 0) {
           // Sort colors:
-          OctreeNodes sortedVector;
+          NodeIndexes sortedVector;
           int auxVectorSize = auxLeavesVector.size();
           for (int k = 0; k < auxVectorSize; k++) {
-            size_t maximumCount = auxLeavesVector[0]->leafColor().pixelCount();
+            uint64_t maximumCount = m_nodes[auxLeavesVector[0]].pixelCount;
             int maximumIndex = 0;
             for (int j = 1; j < auxLeavesVector.size(); j++) {
-              if (auxLeavesVector[j]->leafColor().pixelCount() > maximumCount) {
-                maximumCount = auxLeavesVector[j]->leafColor().pixelCount();
+              if (m_nodes[auxLeavesVector[j]].pixelCount > maximumCount) {
+                maximumCount = m_nodes[auxLeavesVector[j]].pixelCount;
                 maximumIndex = j;
               }
             }
@@ -171,18 +189,16 @@ bool OctreeMap::makePalette(Palette* palette, int colorCount, const int levelDee
             auxLeavesVector.erase(auxLeavesVector.begin() + maximumIndex);
           }
           // End Sort colors.
-          // Blend colors:
+          // Discard colors:
           for (;;) {
             if (sortedVector.size() <= colorCount) {
               for (int k = 0; k < sortedVector.size(); k++)
                 m_leavesVector.push_back(sortedVector[k]);
               break;
             }
-            sortedVector[sortedVector.size() - 2]->leafColor().add(
-              sortedVector[sortedVector.size() - 1]->leafColor());
             sortedVector.pop_back();
           }
-          // End Blend colors:
+          // End Discard colors:
           keepReducingMap = false;
           break;
         }
@@ -190,7 +206,7 @@ bool OctreeMap::makePalette(Palette* palette, int colorCount, const int levelDee
           break;
       }
 
-      m_leavesVector.back()->parent()->removeLeaves(auxLeavesVector, m_leavesVector);
+      removeLeaves(m_nodes[m_leavesVector.back()].parent, auxLeavesVector);
     }
     if (keepReducingMap) {
       // Copy collapsed leaves to m_leavesVector
@@ -213,7 +229,7 @@ bool OctreeMap::makePalette(Palette* palette, int colorCount, const int levelDee
   }
 
   for (int i = 0; i < leafCount; i++)
-    palette->setEntry(i + aux, m_leavesVector[i]->leafColor().rgbaColor());
+    palette->setEntry(i + aux, m_nodes[m_leavesVector[i]].rgbaColor());
 
   return true;
 }
@@ -228,13 +244,24 @@ void OctreeMap::feedWithImage(const Image* image,
   color_t forceFullOpacity;
   const bool imageIsRGBA = (image->pixelFormat() == IMAGE_RGB);
 
-  auto add_color_to_octree = [this, &forceFullOpacity, levelDeep, imageIsRGBA](color_t color) {
+  // Consecutive pixels with the same color are added at once
+  color_t runColor = 0;
+  std::size_t runCount = 0;
+
+  auto add_color_to_octree = [&](color_t color) {
     const int alpha = (imageIsRGBA ? rgba_geta(color) : graya_geta(color));
     if (alpha) {
       color |= forceFullOpacity;
       color = (imageIsRGBA ? color :
                              rgba(graya_getv(color), graya_getv(color), graya_getv(color), alpha));
-      addColor(color, levelDeep);
+      if (runCount > 0 && color == runColor) {
+        ++runCount;
+        return;
+      }
+      if (runCount > 0)
+        addColor(runColor, levelDeep, runCount);
+      runColor = color;
+      runCount = 1;
     }
   };
 
@@ -250,19 +277,33 @@ void OctreeMap::feedWithImage(const Image* image,
       break;
     }
   }
+  if (runCount > 0)
+    addColor(runColor, levelDeep, runCount);
   m_maskColor = maskColor;
 }
 
 int OctreeMap::mapColor(color_t rgba) const
 {
-  return m_root.mapColor(rgba_getr(rgba),
-                         rgba_getg(rgba),
-                         rgba_getb(rgba),
-                         rgba_geta(rgba),
-                         m_maskIndex,
-                         m_palette,
-                         0,
-                         this);
+  // If there is no exact rgba match, we calculate which color of the
+  // current palette is the bestfit and memorize the index in a
+  // octree leaf.
+  NodeIndex node = kRoot;
+  for (int level = 0; level < 8; ++level) {
+    NodeIndex children = m_nodes[node].children;
+    if (children == kNoChildren)
+      children = createChildren(node);
+    node = children + getHextet(rgba, level);
+  }
+
+  Node& leaf = m_nodes[node];
+  if (leaf.paletteIndex == -1) {
+    leaf.paletteIndex = findBestfit(rgba_getr(rgba),
+                                    rgba_getg(rgba),
+                                    rgba_getb(rgba),
+                                    rgba_geta(rgba),
+                                    m_maskIndex);
+  }
+  return leaf.paletteIndex;
 }
 
 void OctreeMap::regenerateMap(const Palette* palette,
@@ -280,7 +321,8 @@ void OctreeMap::regenerateMap(const Palette* palette,
 
   m_palette = palette;
   m_fitCriteria = fitCriteria;
-  m_root = OctreeNode();
+  m_nodes.clear();
+  m_nodes.resize(1);
   m_leavesVector.clear();
   m_maskIndex = maskIndex;
   int maskColorBestFitIndex;
@@ -299,10 +341,10 @@ void OctreeMap::regenerateMap(const Palette* palette,
 
   for (int i = 0; i < palette->size(); i++) {
     if (i == maskIndex) {
-      m_root.addColor(palette->entry(i), 0, &m_root, maskColorBestFitIndex, 8);
+      insertColor(palette->entry(i), 8, maskColorBestFitIndex, 1);
       continue;
     }
-    m_root.addColor(palette->entry(i), 0, &m_root, i, 8);
+    insertColor(palette->entry(i), 8, i, 1);
   }
 
   m_modifications = palette->getModifications();
@@ -0,0 +1,89 @@
+// Aseprite Document Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "doc/algorithm/random_image.h"
+#include "doc/image.h"
+#include "doc/image_bits.h"
+#include "doc/image_ref.h"
+#include "doc/octree_map.h"
+#include "doc/palette.h"
+
+#include <benchmark/benchmark.h>
+
+using namespace doc;
+
+// Image with big areas of the same color (like pixel-art)
+static void flat_image(Image* image)
+{
+  const color_t colors[] = { rgba(0, 0, 0, 255),    rgba(255, 255, 255, 255),
+                             rgba(200, 40, 40, 255), rgba(40, 200, 40, 255),
+                             rgba(40, 40, 200, 255), rgba(200, 200, 40, 255) };
+  for (int y = 0; y < image->height(); ++y) {
+    for (int x = 0; x < image->width(); ++x)
+      image->putPixel(x, y, colors[((x / 16) + (y / 16)) % 6]);
+  }
+}
+
+void BM_OctreeMakePalette(benchmark::State& state)
+{
+  const bool random = state.range(0);
+  const int w = state.range(1);
+  const int h = state.range(2);
+  ImageRef img(Image::create(IMAGE_RGB, w, h));
+  if (random)
+    doc::algorithm::random_image(img.get());
+  else
+    flat_image(img.get());
+
+  for (auto _ : state) {
+    OctreeMap octree;
+    octree.feedWithImage(img.get(), false, DOC_OCTREE_IS_OPAQUE);
+    Palette palette(frame_t(0), 256);
+    octree.makePalette(&palette, 256);
+    benchmark::DoNotOptimize(palette.getEntry(0));
+  }
+}
+
+void BM_OctreeMapColor(benchmark::State& state)
+{
+  const int w = state.range(0);
+  const int h = state.range(1);
+  ImageRef img(Image::create(IMAGE_RGB, w, h));
+  doc::algorithm::random_image(img.get());
+
+  Palette palette(frame_t(0), 256);
+  for (int i = 0; i < palette.size(); ++i)
+    palette.setEntry(i, rgba((i * 37) & 255, (i * 91) & 255, (i * 13) & 255, 255));
+
+  for (auto _ : state) {
+    OctreeMap octree;
+    octree.regenerateMap(&palette, -1);
+    int c = 0;
+    for_each_pixel<RgbTraits>(img.get(), [&](color_t u) { c += octree.mapColor(u); });
+    benchmark::DoNotOptimize(c);
+  }
+}
+
+BENCHMARK(BM_OctreeMakePalette)
+  ->Args({ false, 256, 256 })
+  ->Args({ false, 1024, 1024 })
+  ->Args({ true, 256, 256 })
+  ->Args({ true, 1024, 1024 })
+  ->UseRealTime();
+
+BENCHMARK(BM_OctreeMapColor)->Args({ 256, 256 })->Args({ 1024, 1024 })->UseRealTime();
+
+int main(int argc, char** argv)
+{
+  Palette::initBestfit();
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -0,0 +1,122 @@
+// Aseprite Document Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include <gtest/gtest.h>
+
+#include "doc/image.h"
+#include "doc/image_ref.h"
+#include "doc/octree_map.h"
+#include "doc/palette.h"
+
+using namespace doc;
+
+TEST(OctreeMap, ExactColors)
+{
+  const color_t colors[] = { rgba(0, 0, 0, 255),
+                             rgba(255, 0, 0, 255),
+                             rgba(0, 255, 0, 255),
+                             rgba(0, 0, 255, 255) };
+  OctreeMap octree;
+  for (const color_t c : colors)
+    octree.addColor(c, 8);
+
+  Palette palette(frame_t(0), 256);
+  EXPECT_TRUE(octree.makePalette(&palette, 256, 8));
+  // Entry 0 is the mask color
+  ASSERT_EQ(5, palette.size());
+  EXPECT_EQ(0, palette.getEntry(0));
+  for (const color_t c : colors)
+    EXPECT_TRUE(palette.findExactMatch(c)) << std::hex << c;
+}
+
+TEST(OctreeMap, AverageColor)
+{
+  // Both colors fall in the same leaf (level 7) and are blended
+  OctreeMap octree;
+  octree.addColor(rgba(10, 20, 30, 255), 7, 1);
+  octree.addColor(rgba(11, 21, 31, 255), 7, 2);
+
+  Palette palette(frame_t(0), 256);
+  EXPECT_TRUE(octree.makePalette(&palette, 2, 8));
+  ASSERT_EQ(2, palette.size());
+  // (10+11*2)/3 = 10.66 -> 11, etc.
+  EXPECT_EQ(rgba(11, 21, 31, 255), palette.getEntry(1));
+}
+
+TEST(OctreeMap, RunsOfPixels)
+{
+  // Adding a color N times must be the same as adding it once with
+  // count=N
+  OctreeMap a, b;
+  for (int i = 0; i < 1000; ++i) {
+    a.addColor(rgba(i & 255, (i * 3) & 255, (i * 7) & 255, 255));
+    a.addColor(rgba(i & 255, (i * 3) & 255, (i * 7) & 255, 255));
+    b.addColor(rgba(i & 255, (i * 3) & 255, (i * 7) & 255, 255), 7, 2);
+  }
+
+  Palette palA(frame_t(0), 256), palB(frame_t(0), 256);
+  a.makePalette(&palA, 16);
+  b.makePalette(&palB, 16);
+  ASSERT_EQ(palA.size(), palB.size());
+  for (int i = 0; i < palA.size(); ++i)
+    EXPECT_EQ(palA.getEntry(i), palB.getEntry(i)) << "entry " << i;
+}
+
+TEST(OctreeMap, FeedWithImage)
+{
+  ImageRef image(Image::create(IMAGE_RGB, 64, 64));
+  for (int y = 0; y < image->height(); ++y) {
+    for (int x = 0; x < image->width(); ++x)
+      image->putPixel(x, y, (x < 32 ? rgba(255, 0, 0, 255) : rgba(0, 0, 255, 255)));
+  }
+
+  OctreeMap octree;
+  octree.feedWithImage(image.get(), false, DOC_OCTREE_IS_OPAQUE, 8);
+
+  Palette palette(frame_t(0), 256);
+  EXPECT_TRUE(octree.makePalette(&palette, 256, 8));
+  ASSERT_EQ(2, palette.size());
+  EXPECT_TRUE(palette.findExactMatch(rgba(255, 0, 0, 255)));
+  EXPECT_TRUE(palette.findExactMatch(rgba(0, 0, 255, 255)));
+}
+
+TEST(OctreeMap, LargeCounts)
+{
+  // More pixels than what a 32-bit accumulator can hold
+  const std::size_t count = std::size_t(1) << 26;
+  OctreeMap octree;
+  octree.addColor(rgba(200, 100, 50, 255), 8, count);
+  octree.addColor(rgba(201, 101, 51, 255), 8, count);
+
+  Palette palette(frame_t(0), 256);
+  EXPECT_TRUE(octree.makePalette(&palette, 2, 8));
+  ASSERT_EQ(2, palette.size());
+  // Same number of pixels of each color (remainder == n/2) is rounded down
+  EXPECT_EQ(rgba(200, 100, 50, 255), palette.getEntry(1));
+}
+
+TEST(OctreeMap, MapPaletteEntries)
+{
+  Palette palette(frame_t(0), 32);
+  for (int i = 0; i < palette.size(); ++i)
+    palette.setEntry(i, rgba(i * 8, 255 - i * 8, (i * 37) & 255, 255));
+
+  OctreeMap octree;
+  octree.regenerateMap(&palette, -1);
+  for (int i = 0; i < palette.size(); ++i)
+    EXPECT_EQ(i, octree.mapColor(palette.getEntry(i)));
+}
+
+int main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  Palette::initBestfit();
+  return RUN_ALL_TESTS();
+}
@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2020-2024 Igara Studio S.A.
+// Copyright (c) 2020-2026 Igara Studio S.A.
 //
 // This file is released under the terms of the MIT license.
 // Read LICENSE.txt for more information.
@@ -31,6 +31,12 @@ public:
   // Should return the best index in a palette that matches the given RGBA values.
   virtual int mapColor(const color_t rgba) const = 0;
 
+  // Calculates all the entries that mapColor() calculates on demand,
+  // so then mapColor() can be called from several threads at the
+  // same time. Returns false if the map doesn't support it (e.g. it
+  // has too many possible entries).
+  virtual bool calculateAllEntries() { return false; }
+
   virtual int maskIndex() const = 0;
 
   virtual RgbMapAlgorithm rgbmapAlgorithm() const = 0;
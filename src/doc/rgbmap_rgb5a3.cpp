@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2020-2024 Igara Studio S.A.
+// Copyright (c) 2020-2026 Igara Studio S.A.
 // Copyright (c) 2001-2015 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -45,6 +45,21 @@ void RgbMapRGB5A3::regenerateMap(const Palette* palette,
     entry |= INVALID;
 }
 
+bool RgbMapRGB5A3::calculateAllEntries()
+{
+  for (int i = 0; i < MAPSIZE; ++i) {
+    if (m_map[i] & INVALID) {
+      // Inverse of the index calculated in mapColor()
+      generateEntry(i,
+                    ((i >> 13) & 31) << 3,
+                    ((i >> 8) & 31) << 3,
+                    ((i >> 3) & 31) << 3,
+                    (i & 7) << 5);
+    }
+  }
+  return true;
+}
+
 int RgbMapRGB5A3::generateEntry(int i, int r, int g, int b, int a) const
 {
   return m_map[i] = findBestfit(scale_5bits_to_8bits(r >> 3),
@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2020-2024 Igara Studio S.A.
+// Copyright (c) 2020-2026 Igara Studio S.A.
 // Copyright (c) 2001-2016 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -51,6 +51,8 @@ public:
     return (v & INVALID) ? generateEntry(i, r, g, b, a) : v;
   }
 
+  bool calculateAllEntries() override;
+
   RgbMapAlgorithm rgbmapAlgorithm() const override { return RgbMapAlgorithm::RGB5A3; }
 
 private:
@@ -0,0 +1,61 @@
+// Aseprite Document Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include <gtest/gtest.h>
+
+#include "doc/octree_map.h"
+#include "doc/palette.h"
+#include "doc/rgbmap_rgb5a3.h"
+
+using namespace doc;
+
+static void fill_palette(Palette& palette)
+{
+  for (int i = 0; i < palette.size(); ++i)
+    palette.setEntry(i, rgba((i * 37) & 255, (i * 91) & 255, (i * 13) & 255, i < 8 ? i * 32 : 255));
+}
+
+TEST(RgbMap, CalculateAllEntries)
+{
+  Palette palette(frame_t(0), 64);
+  fill_palette(palette);
+
+  for (const FitCriteria fc : { FitCriteria::DEFAULT, FitCriteria::CIELAB }) {
+    RgbMapRGB5A3 lazy;
+    RgbMapRGB5A3 precalculated;
+    lazy.regenerateMap(&palette, 0, fc);
+    precalculated.regenerateMap(&palette, 0, fc);
+    EXPECT_TRUE(precalculated.calculateAllEntries());
+
+    for (int r = 0; r < 256; r += 5) {
+      for (int g = 0; g < 256; g += 7) {
+        for (int b = 0; b < 256; b += 11) {
+          for (int a = 0; a < 256; a += 51) {
+            const color_t c = rgba(r, g, b, a);
+            ASSERT_EQ(lazy.mapColor(c), precalculated.mapColor(c))
+              << "r=" << r << " g=" << g << " b=" << b << " a=" << a;
+          }
+        }
+      }
+    }
+  }
+
+  // Octree maps cannot calculate all their entries
+  OctreeMap octree;
+  octree.regenerateMap(&palette, 0);
+  EXPECT_FALSE(octree.calculateAllEntries());
+}
+
+int main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  Palette::initBestfit();
+  return RUN_ALL_TESTS();
+}
@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (C) 2018-2025  Igara Studio S.A.
+// Copyright (C) 2018-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -38,6 +38,17 @@ namespace doc {
 
 static gfx::Rect g_defaultGridBounds(0, 0, 16, 16);
 
+static std::unique_ptr<RgbMap> make_rgbmap(const RgbMapAlgorithm mapAlgo)
+{
+  switch (mapAlgo) {
+    case RgbMapAlgorithm::RGB5A3:  return std::make_unique<RgbMapRGB5A3>();
+    case RgbMapAlgorithm::DEFAULT:
+    case RgbMapAlgorithm::OCTREE:  return std::make_unique<OctreeMap>();
+  }
+  ASSERT(false);
+  return nullptr;
+}
+
 // static
 gfx::Rect Sprite::DefaultGridBounds()
 {
@@ -440,23 +451,34 @@ RgbMap* Sprite::rgbMap(const frame_t frame,
 {
   if (!m_rgbMap || m_rgbMap->rgbmapAlgorithm() != mapAlgo ||
       m_rgbMap->fitCriteria() != fitCriteria) {
-    switch (mapAlgo) {
-      case RgbMapAlgorithm::RGB5A3:  m_rgbMap.reset(new RgbMapRGB5A3); break;
-      case RgbMapAlgorithm::DEFAULT:
-      case RgbMapAlgorithm::OCTREE:  m_rgbMap.reset(new OctreeMap); break;
-      default:
-        m_rgbMap.reset(nullptr);
-        ASSERT(false);
-        return nullptr;
-    }
+    m_rgbMap = make_rgbmap(mapAlgo);
+    if (!m_rgbMap)
+      return nullptr;
     m_rgbMap->fitCriteria(fitCriteria);
   }
-  int maskIndex = palette(frame)->findMaskColor();
-  maskIndex = (maskIndex == -1 ? (forLayer == RgbMapFor::OpaqueLayer ? -1 : 0) : maskIndex);
-  m_rgbMap->regenerateMap(palette(frame), maskIndex, fitCriteria);
+  m_rgbMap->regenerateMap(palette(frame), rgbMapMaskIndex(frame, forLayer), fitCriteria);
   return m_rgbMap.get();
 }
 
+std::unique_ptr<RgbMap> Sprite::createRgbMap(const frame_t frame,
+                                             const RgbMapFor forLayer,
+                                             const RgbMapAlgorithm mapAlgo,
+                                             const FitCriteria fitCriteria) const
+{
+  std::unique_ptr<RgbMap> rgbmap = make_rgbmap(mapAlgo);
+  if (rgbmap) {
+    rgbmap->fitCriteria(fitCriteria);
+    rgbmap->regenerateMap(palette(frame), rgbMapMaskIndex(frame, forLayer), fitCriteria);
+  }
+  return rgbmap;
+}
+
+int Sprite::rgbMapMaskIndex(const frame_t frame, const RgbMapFor forLayer) const
+{
+  const int maskIndex = palette(frame)->findMaskColor();
+  return (maskIndex == -1 ? (forLayer == RgbMapFor::OpaqueLayer ? -1 : 0) : maskIndex);
+}
+
 //////////////////////////////////////////////////////////////////////
 // Frames
 
@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (C) 2018-2025  Igara Studio S.A.
+// Copyright (C) 2018-2026  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -169,6 +169,13 @@ public:
                  const RgbMapAlgorithm mapAlgo,
                  const FitCriteria fitCriteria = FitCriteria::DEFAULT) const;
 
+  // Creates a new RgbMap for the given frame which is not shared
+  // with the sprite (e.g. to use it from other threads).
+  std::unique_ptr<RgbMap> createRgbMap(const frame_t frame,
+                                       const RgbMapFor forLayer,
+                                       const RgbMapAlgorithm mapAlgo,
+                                       const FitCriteria fitCriteria) const;
+
   ////////////////////////////////////////
   // Frames
 
@@ -248,6 +255,8 @@ public:
   bool useLayerUuids() const { return m_useLayerUuids; }
 
 private:
+  int rgbMapMaskIndex(const frame_t frame, const RgbMapFor forLayer) const;
+
   Document* m_document;
   ImageSpec m_spec;
   PixelRatio m_pixelRatio;
@@ -0,0 +1,60 @@
+// Aseprite Document Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "doc/cel.h"
+#include "doc/image.h"
+#include "doc/image_ref.h"
+#include "doc/layer.h"
+#include "doc/sprite.h"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+using namespace doc;
+
+// Creates a sprite with the given number of layers and frames with
+// one (linked) cel in each frame of each layer.
+static std::shared_ptr<Sprite> make_long_timeline(const int layers, const int frames)
+{
+  auto spr = std::make_shared<Sprite>(ImageSpec(ColorMode::RGB, 16, 16), 256);
+  spr->setTotalFrames(frames);
+
+  ImageRef img(Image::create(IMAGE_RGB, 16, 16));
+  for (int i = 0; i < layers; ++i) {
+    auto lay = new LayerImage(spr.get());
+    spr->root()->addLayer(lay);
+
+    Cel* first = new Cel(frame_t(0), img);
+    lay->addCel(first);
+    for (frame_t frame = 1; frame < frames; ++frame)
+      lay->addCel(Cel::MakeLink(frame, first));
+  }
+  return spr;
+}
+
+void BM_AddRemoveFrameAtHead(benchmark::State& state)
+{
+  const int layers = state.range(0);
+  const int frames = state.range(1);
+  auto spr = make_long_timeline(layers, frames);
+  for (auto _ : state) {
+    spr->addFrame(frame_t(1));
+    spr->removeFrame(frame_t(1));
+  }
+}
+
+BENCHMARK(BM_AddRemoveFrameAtHead)
+  ->Args({ 1, 1000 })
+  ->Args({ 50, 1000 })
+  ->Args({ 50, 20000 })
+  ->UseRealTime();
+
+BENCHMARK_MAIN();
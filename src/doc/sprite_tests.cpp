@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2018-2022 Igara Studio S.A.
+// Copyright (c) 2018-2026 Igara Studio S.A.
 // Copyright (c) 2001-2016 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -207,6 +207,60 @@ TEST(Sprite, CelsRange)
   EXPECT_EQ(3, i);
 }
 
+TEST(Sprite, AddRemoveFrames)
+{
+  std::shared_ptr<Sprite> sprPtr(std::make_shared<Sprite>(ImageSpec(ColorMode::RGB, 32, 32), 256));
+  Sprite* spr = sprPtr.get();
+  spr->setTotalFrames(4);
+
+  LayerImage* lay1 = new LayerImage(spr);
+  LayerGroup* grp1 = new LayerGroup(spr);
+  LayerImage* lay2 = new LayerImage(spr);
+  spr->root()->addLayer(lay1);
+  spr->root()->addLayer(grp1);
+  grp1->addLayer(lay2);
+
+  ImageRef img(Image::create(IMAGE_RGB, 32, 32));
+  Cel* celA = new Cel(frame_t(0), img);
+  Cel* celB = new Cel(frame_t(1), img);
+  Cel* celC = new Cel(frame_t(3), img);
+  Cel* celD = new Cel(frame_t(2), img);
+  lay1->addCel(celA);
+  lay1->addCel(celB);
+  lay1->addCel(celC);
+  lay2->addCel(celD);
+
+  // Insert a frame before frame 1
+  spr->addFrame(frame_t(1));
+  EXPECT_EQ(5, spr->totalFrames());
+  EXPECT_EQ(0, celA->frame());
+  EXPECT_EQ(2, celB->frame());
+  EXPECT_EQ(4, celC->frame());
+  EXPECT_EQ(3, celD->frame());
+  EXPECT_EQ(nullptr, lay1->cel(frame_t(1)));
+  EXPECT_EQ(celB, lay1->cel(frame_t(2)));
+  EXPECT_EQ(celC, lay1->cel(frame_t(4)));
+  EXPECT_EQ(celD, lay2->cel(frame_t(3)));
+
+  // Remove the empty frame 3 of lay1
+  lay2->removeCel(celD);
+  spr->removeFrame(frame_t(3));
+  EXPECT_EQ(4, spr->totalFrames());
+  EXPECT_EQ(0, celA->frame());
+  EXPECT_EQ(2, celB->frame());
+  EXPECT_EQ(3, celC->frame());
+  EXPECT_EQ(celC, lay1->cel(frame_t(3)));
+  EXPECT_EQ(3, lay1->getCelsCount());
+  delete celD;
+
+  // Insert a frame at the beginning
+  spr->addFrame(frame_t(0));
+  EXPECT_EQ(1, celA->frame());
+  EXPECT_EQ(3, celB->frame());
+  EXPECT_EQ(4, celC->frame());
+  EXPECT_EQ(celA, *lay1->getCelBegin()); // Order is kept
+}
+
 int main(int argc, char** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
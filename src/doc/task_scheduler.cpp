@@ -0,0 +1,295 @@
+// Aseprite Document Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "doc/task_scheduler.h"
+
+#include "base/debug.h"
+#include "base/thread.h"
+#include "doc/cancel_io.h"
+
+#include <algorithm>
+
+namespace doc {
+
+struct TaskScheduler::Loop {
+  Loop(const LoopFunc& func, int n, int helpers) : func(func), n(n), helpers(helpers) {}
+
+  const LoopFunc& func;
+  const int n;
+  int helpers; // Workers that can still join the loop (guarded by TaskScheduler::m_mutex)
+  std::atomic<int> next{ 0 };
+  std::atomic<bool> stop{ false };
+  std::atomic<bool> canceled{ false };
+  std::mutex mutex;
+  std::condition_variable cond;
+  int running = 0; // Workers running this loop
+  std::exception_ptr error;
+};
+
+void TaskScheduler::Token::cancel()
+{
+  const std::lock_guard lock(m_mutex);
+  m_canceled = true;
+  m_cond.notify_all();
+}
+
+bool TaskScheduler::Token::completed() const
+{
+  const std::lock_guard lock(m_mutex);
+  return isCompleted();
+}
+
+void TaskScheduler::Token::wait()
+{
+  std::unique_lock lock(m_mutex);
+  m_cond.wait(lock, [this] { return isCompleted(); });
+}
+
+std::exception_ptr TaskScheduler::Token::error() const
+{
+  const std::lock_guard lock(m_mutex);
+  return m_error;
+}
+
+// Returns true if the task can be executed, i.e. it wasn't canceled
+// before it started.
+bool TaskScheduler::Token::start()
+{
+  const std::lock_guard lock(m_mutex);
+  m_started = !m_canceled;
+  return m_started;
+}
+
+void TaskScheduler::Token::setCompleted(std::exception_ptr error)
+{
+  const std::lock_guard lock(m_mutex);
+  m_completed = true;
+  m_error = error;
+  m_cond.notify_all();
+}
+
+// static
+TaskScheduler& TaskScheduler::instance()
+{
+  static TaskScheduler scheduler(std::max(1, int(std::thread::hardware_concurrency()) - 1));
+  return scheduler;
+}
+
+TaskScheduler::TaskScheduler(int nworkers)
+{
+  m_workers.reserve(nworkers);
+  for (int i = 0; i < nworkers; ++i)
+    m_workers.emplace_back([this] { workerProc(); });
+}
+
+TaskScheduler::~TaskScheduler()
+{
+  {
+    const std::lock_guard lock(m_mutex);
+    m_exiting = true;
+  }
+  m_cond.notify_all();
+  for (auto& worker : m_workers)
+    worker.join();
+
+  // Tasks that weren't executed are completed so nobody waits them
+  for (auto& queue : m_queues) {
+    for (auto& item : queue) {
+      if (item.task)
+        item.task->token->setCompleted(nullptr);
+    }
+  }
+}
+
+TaskScheduler::TokenRef TaskScheduler::run(TaskFunc&& func, Priority priority)
+{
+  auto task = std::make_unique<Task>();
+  task->func = std::move(func);
+  task->token = std::make_shared<Token>();
+  TokenRef token = task->token;
+
+  // Without workers the task is executed in the calling thread
+  if (m_workers.empty()) {
+    executeTask(*task);
+    return token;
+  }
+
+  {
+    const std::lock_guard lock(m_mutex);
+    m_queues[int(priority)].push_back(Item{ std::move(task), nullptr });
+  }
+  m_cond.notify_one();
+  return token;
+}
+
+bool TaskScheduler::parallelFor(const int n,
+                                const LoopFunc& func,
+                                int maxThreads,
+                                CancelIO* cancel,
+                                const Priority priority)
+{
+  if (n <= 0)
+    return true;
+
+  if (maxThreads <= 0)
+    maxThreads = concurrency();
+
+  const int helpers = std::min({ maxThreads - 1, n - 1, workersCount() });
+  const bool useWorkers = (helpers > 0);
+  Loop loop(func, n, helpers);
+  if (useWorkers) {
+    {
+      const std::lock_guard lock(m_mutex);
+      m_queues[int(priority)].push_back(Item{ nullptr, &loop });
+    }
+    if (helpers == 1)
+      m_cond.notify_one();
+    else
+      m_cond.notify_all();
+  }
+
+  runLoop(&loop, cancel);
+
+  if (useWorkers) {
+    // Avoid new workers joining the loop
+    {
+      const std::lock_guard lock(m_mutex);
+      auto& queue = m_queues[int(priority)];
+      auto it = std::find_if(queue.begin(), queue.end(), [&loop](const Item& item) {
+        return item.loop == &loop;
+      });
+      if (it != queue.end())
+        queue.erase(it);
+    }
+
+    // Wait the workers that are still processing indexes
+    std::unique_lock lock(loop.mutex);
+    loop.cond.wait(lock, [&loop] { return loop.running == 0; });
+  }
+
+  if (loop.error)
+    std::rethrow_exception(loop.error);
+
+  return !loop.canceled;
+}
+
+void TaskScheduler::workerProc()
+{
+  base::this_thread::set_name("tasks");
+
+  std::unique_lock lock(m_mutex);
+  while (true) {
+    m_cond.wait(lock, [this] { return m_exiting || hasItems(); });
+    if (m_exiting)
+      break;
+
+    Item item = takeItem();
+    lock.unlock();
+
+    if (item.task) {
+      executeTask(*item.task);
+      item.task.reset();
+    }
+    else if (item.loop) {
+      Loop* loop = item.loop;
+      runLoop(loop, nullptr);
+
+      // After this the loop can be destroyed by the calling thread
+      const std::lock_guard loopLock(loop->mutex);
+      if (--loop->running == 0)
+        loop->cond.notify_all();
+    }
+
+    lock.lock();
+  }
+}
+
+// static
+void TaskScheduler::executeTask(Task& task)
+{
+  Token& token = *task.token;
+  std::exception_ptr error;
+  if (token.start()) {
+    try {
+      task.func(token);
+    }
+    catch (...) {
+      error = std::current_exception();
+    }
+  }
+  // Destroy the function (and what it captures) before the task is
+  // marked as completed
+  task.func = nullptr;
+  token.setCompleted(error);
+}
+
+bool TaskScheduler::hasItems() const
+{
+  for (const auto& queue : m_queues) {
+    if (!queue.empty())
+      return true;
+  }
+  return false;
+}
+
+// Takes the next item with the highest priority, m_mutex must be locked
+TaskScheduler::Item TaskScheduler::takeItem()
+{
+  for (auto& queue : m_queues) {
+    while (!queue.empty()) {
+      Item& item = queue.front();
+      if (item.task) {
+        Item result = std::move(item);
+        queue.pop_front();
+        return result;
+      }
+
+      Loop* loop = item.loop;
+      ASSERT(loop);
+      if (loop->stop || loop->next >= loop->n || loop->helpers == 0) {
+        queue.pop_front();
+        continue;
+      }
+
+      {
+        const std::lock_guard loopLock(loop->mutex);
+        ++loop->running;
+      }
+      if (--loop->helpers == 0)
+        queue.pop_front();
+      return Item{ nullptr, loop };
+    }
+  }
+  return Item();
+}
+
+// static
+void TaskScheduler::runLoop(Loop* loop, CancelIO* cancel)
+{
+  try {
+    int i;
+    while (!loop->stop && (i = loop->next++) < loop->n) {
+      if (cancel && cancel->isCanceled()) {
+        loop->canceled = true;
+        loop->stop = true;
+        break;
+      }
+      loop->func(i);
+    }
+  }
+  catch (...) {
+    const std::lock_guard lock(loop->mutex);
+    if (!loop->error)
+      loop->error = std::current_exception();
+    loop->stop = true;
+  }
+}
+
+} // namespace doc
@@ -0,0 +1,150 @@
+// Aseprite Document Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef DOC_TASK_SCHEDULER_H_INCLUDED
+#define DOC_TASK_SCHEDULER_H_INCLUDED
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace doc {
+class CancelIO;
+
+// Pool of worker threads shared by all the operations that want to
+// run code in parallel, so we don't create (and destroy) threads for
+// each operation, and the number of busy threads doesn't exceed the
+// number of cores when several operations run at the same time.
+//
+// There are two kind of works:
+//
+// 1. Background tasks (run()) that are executed by one worker and
+//    can be canceled/waited using their token.
+//
+// 2. Parallel loops (parallelFor()) where the calling thread
+//    processes the loop indexes, and idle workers join to help it
+//    taking the next unprocessed index. As the calling thread never
+//    waits for an index that wasn't taken by a worker, parallel
+//    loops can be nested (e.g. used from background tasks) without
+//    deadlocks.
+//
+// Works with higher priority are taken first by idle workers.
+//
+// Instead of per-worker queues with work-stealing (laf's
+// base::thread_pool doesn't support it), all workers share one queue
+// per priority protected by m_mutex. The contention is low because
+// the mutex is locked only to queue/take whole works: a task is taken
+// once, a worker joins a loop once, and the indexes of a loop are
+// distributed with an atomic counter (Loop::next) without locking
+// m_mutex. Our works are coarse (frames, cels, files, or loops over
+// image rows), so a worker spends much more time running a work than
+// waiting the mutex.
+class TaskScheduler {
+public:
+  enum class Priority { High, Normal, Low };
+
+  class Token {
+  public:
+    bool canceled() const { return m_canceled; }
+    void cancel();
+
+    // Returns true when the task was executed, or when it was
+    // canceled before it started (so it will not be executed).
+    bool completed() const;
+
+    // Waits the task to complete (returns immediately if it was
+    // canceled before it started)
+    void wait();
+
+    // Exception thrown by the task (if any)
+    std::exception_ptr error() const;
+
+  private:
+    bool isCompleted() const { return m_completed || (m_canceled && !m_started); }
+    bool start();
+    void setCompleted(std::exception_ptr error);
+
+    std::atomic<bool> m_canceled{ false };
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_started = false;
+    bool m_completed = false;
+    std::exception_ptr m_error;
+
+    friend class TaskScheduler;
+  };
+
+  using TokenRef = std::shared_ptr<Token>;
+  using TaskFunc = std::function<void(Token&)>;
+  using LoopFunc = std::function<void(int)>;
+
+  // Scheduler shared by the whole program, with one worker less than
+  // hardware threads (the thread that calls parallelFor() is the
+  // remaining one).
+  static TaskScheduler& instance();
+
+  explicit TaskScheduler(int nworkers);
+  ~TaskScheduler();
+
+  int workersCount() const { return int(m_workers.size()); }
+
+  // Maximum number of threads that can run a parallelFor() (the
+  // workers plus the calling thread).
+  int concurrency() const { return workersCount() + 1; }
+
+  // Executes the given function in a worker thread (or in the
+  // calling thread if there are no workers). If the task is canceled
+  // before a worker takes it, the function is not called.
+  TokenRef run(TaskFunc&& func, Priority priority = Priority::Normal);
+
+  // Calls func(i) for each i in [0, n) using the calling thread and
+  // up to "maxThreads"-1 workers (all workers if maxThreads <= 0).
+  // Returns when all the calls have finished. The first exception
+  // thrown by "func" stops the loop and is re-thrown in the calling
+  // thread. Returns false if the loop was stopped because "cancel"
+  // was canceled (it's checked only from the calling thread, so it
+  // doesn't need to be thread-safe).
+  bool parallelFor(int n,
+                   const LoopFunc& func,
+                   int maxThreads = 0,
+                   CancelIO* cancel = nullptr,
+                   Priority priority = Priority::High);
+
+private:
+  struct Loop;
+  struct Task {
+    TaskFunc func;
+    TokenRef token;
+  };
+  // A queued item is a task or a loop
+  struct Item {
+    std::unique_ptr<Task> task;
+    Loop* loop = nullptr;
+  };
+
+  void workerProc();
+  bool hasItems() const;
+  Item takeItem();
+  static void executeTask(Task& task);
+  static void runLoop(Loop* loop, CancelIO* cancel);
+
+  std::vector<std::thread> m_workers;
+  std::deque<Item> m_queues[3]; // One queue for each priority
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cond;
+  bool m_exiting = false;
+};
+
+} // namespace doc
+
+#endif
@@ -0,0 +1,128 @@
+// Aseprite Document Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include <gtest/gtest.h>
+
+#include "doc/cancel_io.h"
+#include "doc/task_scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace doc;
+
+TEST(TaskScheduler, ParallelFor)
+{
+  TaskScheduler scheduler(3);
+  for (const int maxThreads : { 0, 1, 2, 8 }) {
+    std::vector<int> values(1000, 0);
+    EXPECT_TRUE(scheduler.parallelFor(
+      int(values.size()),
+      [&values](int i) { values[i] += i; },
+      maxThreads));
+    for (int i = 0; i < int(values.size()); ++i)
+      ASSERT_EQ(i, values[i]);
+  }
+}
+
+TEST(TaskScheduler, NestedParallelFor)
+{
+  TaskScheduler scheduler(2);
+  std::atomic<int> count(0);
+  scheduler.parallelFor(8, [&](int) {
+    scheduler.parallelFor(8, [&](int) {
+      scheduler.parallelFor(8, [&](int) { ++count; });
+    });
+  });
+  EXPECT_EQ(8 * 8 * 8, count);
+}
+
+TEST(TaskScheduler, Exceptions)
+{
+  TaskScheduler scheduler(3);
+  std::atomic<int> count(0);
+  EXPECT_THROW(scheduler.parallelFor(100,
+                                     [&](int i) {
+                                       ++count;
+                                       if (i == 10)
+                                         throw std::runtime_error("error");
+                                     }),
+               std::runtime_error);
+  EXPECT_GE(count, 11);
+
+  auto token = scheduler.run([](TaskScheduler::Token&) { throw std::runtime_error("error"); });
+  token->wait();
+  EXPECT_TRUE(token->completed());
+  EXPECT_TRUE(token->error() != nullptr);
+}
+
+TEST(TaskScheduler, CancelParallelFor)
+{
+  struct Cancel : public CancelIO {
+    bool isCanceled() override { return true; }
+  } cancel;
+
+  TaskScheduler scheduler(3);
+  std::atomic<int> count(0);
+  EXPECT_FALSE(scheduler.parallelFor(
+    1000,
+    [&](int) {
+      ++count;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    },
+    0,
+    &cancel));
+  EXPECT_LT(count, 1000);
+
+  // Loops without a cancel object are never canceled
+  EXPECT_TRUE(scheduler.parallelFor(10, [](int) {}));
+}
+
+TEST(TaskScheduler, RunTasks)
+{
+  TaskScheduler scheduler(1);
+  std::atomic<bool> blocked(true);
+  std::vector<int> order;
+
+  // The only worker is busy until "blocked" is false
+  auto first = scheduler.run([&](TaskScheduler::Token&) {
+    while (blocked)
+      std::this_thread::yield();
+  });
+
+  auto low = scheduler.run([&](TaskScheduler::Token&) { order.push_back(3); },
+                           TaskScheduler::Priority::Low);
+  auto normal = scheduler.run([&](TaskScheduler::Token&) { order.push_back(2); });
+  auto high = scheduler.run([&](TaskScheduler::Token&) { order.push_back(1); },
+                            TaskScheduler::Priority::High);
+  auto canceled = scheduler.run([&](TaskScheduler::Token&) { order.push_back(4); });
+  canceled->cancel();
+
+  // Canceled tasks that didn't start don't need to be waited
+  canceled->wait();
+  EXPECT_TRUE(canceled->completed());
+
+  // Loops are processed by the calling thread when workers are busy
+  int count = 0;
+  EXPECT_TRUE(scheduler.parallelFor(10, [&count](int) { ++count; }));
+  EXPECT_EQ(10, count);
+
+  blocked = false;
+  for (auto& token : { first, low, normal, high, canceled }) {
+    token->wait();
+    EXPECT_TRUE(token->completed());
+  }
+  EXPECT_EQ(std::vector<int>({ 1, 2, 3 }), order);
+}
+
+int main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
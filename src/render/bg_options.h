@@ -1,5 +1,5 @@
 // Aseprite Render Library
-// Copyright (c) 2022  Igara Studio S.A.
+// Copyright (c) 2022-2026  Igara Studio S.A.
 //
 // This file is released under the terms of the MIT license.
 // Read LICENSE.txt for more information.
@@ -27,6 +27,14 @@ struct BgOptions {
 
   static BgOptions MakeNone() { return BgOptions(BgType::NONE); }
   static BgOptions MakeTransparent() { return BgOptions(BgType::TRANSPARENT); }
+
+  bool operator==(const BgOptions& other) const
+  {
+    return (type == other.type && zoom == other.zoom &&
+            colorPixelFormat == other.colorPixelFormat && color1 == other.color1 &&
+            color2 == other.color2 && stripeSize == other.stripeSize);
+  }
+  bool operator!=(const BgOptions& other) const { return !operator==(other); }
 };
 
 } // namespace render
@@ -1,5 +1,5 @@
 // Aseprite Render Library
-// Copyright (c) 2020-2025 Igara Studio S.A.
+// Copyright (c) 2020-2026 Igara Studio S.A.
 // Copyright (c) 2017 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -40,6 +40,12 @@ public:
 
   int& operator()(int i, int j) { return m_matrix[(i % m_rows) * m_cols + (j % m_cols)]; }
 
+  bool operator==(const DitheringMatrix& other) const
+  {
+    return (m_rows == other.m_rows && m_cols == other.m_cols && m_matrix == other.m_matrix);
+  }
+  bool operator!=(const DitheringMatrix& other) const { return !operator==(other); }
+
 private:
   int m_rows, m_cols;
   std::vector<int> m_matrix;
@@ -0,0 +1,181 @@
+// Aseprite Render Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "render/mipmaps.h"
+
+#include "base/debug.h"
+#include "doc/image.h"
+#include "doc/image_traits.h"
+
+#include <algorithm>
+
+namespace render {
+
+using namespace doc;
+
+namespace {
+
+// Number of trailing zero bits of the given step (i.e. the exponent
+// of the greatest power of two that divides it).
+int power_of_two_factor(int step)
+{
+  int n = 0;
+  while (step > 1 && (step & 1) == 0) {
+    step >>= 1;
+    ++n;
+  }
+  return n;
+}
+
+template<typename ImageTraits>
+void sample_image(const Image* src, Image* dst, const int step)
+{
+  using pixel_t = typename ImageTraits::pixel_t;
+
+  for (int y = 0; y < dst->height(); ++y) {
+    auto s = (const pixel_t*)src->getPixelAddress(0, y * step);
+    auto d = (pixel_t*)dst->getPixelAddress(0, y);
+    for (int x = 0; x < dst->width(); ++x, s += step)
+      *d++ = *s;
+  }
+}
+
+// Creates a new image taking one pixel of each step x step block of
+// the "src" image. The size of the new image is rounded down so each
+// pixel of the level comes from an existent pixel of "src" (the
+// same clipping that composite_image_scale_down() does).
+ImageRef create_level(const Image* src, const int step)
+{
+  ImageSpec spec = src->spec();
+  spec.setSize(src->width() / step, src->height() / step);
+
+  ImageRef dst(Image::create(spec));
+  switch (src->pixelFormat()) {
+    case IMAGE_RGB:       sample_image<RgbTraits>(src, dst.get(), step); break;
+    case IMAGE_GRAYSCALE: sample_image<GrayscaleTraits>(src, dst.get(), step); break;
+    case IMAGE_INDEXED:   sample_image<IndexedTraits>(src, dst.get(), step); break;
+    default:              ASSERT(false); return ImageRef();
+  }
+  return dst;
+}
+
+} // anonymous namespace
+
+Mipmaps::Mipmaps(const std::size_t maxMemSize, const int minPixels)
+  : m_maxMemSize(maxMemSize)
+  , m_minPixels(minPixels)
+{
+}
+
+const Image* Mipmaps::getLevel(const Image* image, const int stepX, const int stepY, int& level)
+{
+  level = 0;
+
+  // Tilemaps (and bitmaps) are not supported
+  if (image->pixelFormat() != IMAGE_RGB && image->pixelFormat() != IMAGE_GRAYSCALE &&
+      image->pixelFormat() != IMAGE_INDEXED)
+    return image;
+
+  if (image->width() * image->height() < m_minPixels)
+    return image;
+
+  int wanted = std::min(power_of_two_factor(stepX), power_of_two_factor(stepY));
+  // Don't create levels with zero width/height
+  while (wanted > 0 && ((image->width() >> wanted) < 1 || (image->height() >> wanted) < 1))
+    --wanted;
+  wanted = std::min(wanted, kMaxLevel);
+  if (wanted == 0)
+    return image;
+
+  Pyramid& pyramid = getPyramid(image);
+  if (!pyramid.levels[wanted]) {
+    // Sample the new level from the finest available level
+    int from = wanted - 1;
+    while (from > 0 && !pyramid.levels[from])
+      --from;
+
+    const Image* src = (from == 0 ? image : pyramid.levels[from].get());
+    ImageRef newLevel = create_level(src, 1 << (wanted - from));
+    if (!newLevel)
+      return image;
+
+    pyramid.levels[wanted] = newLevel;
+    pyramid.memSize += newLevel->getMemSize();
+    m_memSize += newLevel->getMemSize();
+
+    shrinkToMaxMemSize();
+
+    // The pyramid of this image is the most recently used, so it's
+    // evicted only if its levels alone exceed the limit.
+    if (m_pyramids.empty() || m_pyramids.front().id != image->id())
+      return image;
+  }
+
+  level = wanted;
+  return m_pyramids.front().levels[wanted].get();
+}
+
+void Mipmaps::clear()
+{
+  m_pyramids.clear();
+  m_map.clear();
+  m_memSize = 0;
+}
+
+void Mipmaps::setMaxMemSize(const std::size_t maxMemSize)
+{
+  m_maxMemSize = maxMemSize;
+  shrinkToMaxMemSize();
+}
+
+Mipmaps::Pyramid& Mipmaps::getPyramid(const Image* image)
+{
+  const ObjectId id = image->id();
+  auto it = m_map.find(id);
+  if (it != m_map.end()) {
+    // Move to the front of the LRU list
+    m_pyramids.splice(m_pyramids.begin(), m_pyramids, it->second);
+
+    Pyramid& pyramid = m_pyramids.front();
+    if (pyramid.version == image->version() && pyramid.pixelFormat == image->pixelFormat() &&
+        pyramid.width == image->width() && pyramid.height == image->height()) {
+      return pyramid;
+    }
+
+    // The image was modified, discard all its levels
+    m_memSize -= pyramid.memSize;
+    pyramid.levels.fill(nullptr);
+    pyramid.memSize = 0;
+  }
+  else {
+    m_pyramids.emplace_front();
+    m_map[id] = m_pyramids.begin();
+  }
+
+  Pyramid& pyramid = m_pyramids.front();
+  pyramid.id = id;
+  pyramid.version = image->version();
+  pyramid.pixelFormat = image->pixelFormat();
+  pyramid.width = image->width();
+  pyramid.height = image->height();
+  return pyramid;
+}
+
+void Mipmaps::shrinkToMaxMemSize()
+{
+  while (m_memSize > m_maxMemSize && !m_pyramids.empty()) {
+    const Pyramid& pyramid = m_pyramids.back();
+    m_memSize -= pyramid.memSize;
+    m_map.erase(pyramid.id);
+    m_pyramids.pop_back();
+  }
+}
+
+} // namespace render
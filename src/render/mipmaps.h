@@ -0,0 +1,94 @@
+// Aseprite Render Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef RENDER_MIPMAPS_H_INCLUDED
+#define RENDER_MIPMAPS_H_INCLUDED
+#pragma once
+
+#include "doc/image_ref.h"
+#include "doc/object_id.h"
+#include "doc/object_version.h"
+#include "doc/pixel_format.h"
+
+#include <array>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace doc {
+class Image;
+}
+
+namespace render {
+
+// Cache of nearest-neighbor mipmap pyramids for doc::Image instances
+// (mainly cel images) used to render sprites zoomed out.
+//
+// The level N of an image contains the top-left pixel of each
+// 2^N x 2^N block of the original image. So compositing the level N
+// with a scale-down step of S/2^N produces exactly the same pixels as
+// compositing the original image with a step of S (no new colors are
+// created, the pixel-art look is preserved), but reading 4^N times
+// less memory.
+//
+// Levels are created lazily (only the requested one, from the
+// nearest finer level available) and the whole pyramid of an image
+// is discarded when the image version/spec changes. The least
+// recently used pyramids are evicted when the cache exceeds its
+// memory limit.
+class Mipmaps {
+public:
+  static constexpr int kMaxLevel = 8;
+  static constexpr std::size_t kDefaultMaxMemSize = 256 * 1024 * 1024;
+  static constexpr int kDefaultMinPixels = 256 * 256;
+
+  Mipmaps(std::size_t maxMemSize = kDefaultMaxMemSize, int minPixels = kDefaultMinPixels);
+  Mipmaps(const Mipmaps&) = delete;
+  Mipmaps& operator=(const Mipmaps&) = delete;
+
+  // Returns the best level of the given image to be composited with
+  // the given integer scale-down steps (e.g. stepX=4 for 25% zoom).
+  // The "level" output argument is the level number of the returned
+  // image, so the caller must composite it with a step of
+  // stepX/2^level and stepY/2^level. If there is no better level
+  // than the original image, the same image is returned with
+  // level=0.
+  const doc::Image* getLevel(const doc::Image* image, int stepX, int stepY, int& level);
+
+  void clear();
+
+  std::size_t memSize() const { return m_memSize; }
+  std::size_t maxMemSize() const { return m_maxMemSize; }
+  void setMaxMemSize(std::size_t maxMemSize);
+
+private:
+  struct Pyramid {
+    doc::ObjectId id;
+    doc::ObjectVersion version;
+    doc::PixelFormat pixelFormat;
+    int width;
+    int height;
+    std::array<doc::ImageRef, kMaxLevel + 1> levels;
+    std::size_t memSize = 0;
+  };
+  using Pyramids = std::list<Pyramid>;
+
+  Pyramid& getPyramid(const doc::Image* image);
+  void shrinkToMaxMemSize();
+
+  Pyramids m_pyramids; // Most recently used first
+  std::unordered_map<doc::ObjectId, Pyramids::iterator> m_map;
+  std::size_t m_memSize = 0;
+  std::size_t m_maxMemSize;
+  int m_minPixels;
+};
+
+using MipmapsPtr = std::shared_ptr<Mipmaps>;
+
+} // namespace render
+
+#endif
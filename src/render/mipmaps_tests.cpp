@@ -0,0 +1,146 @@
+// Aseprite Render Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include <gtest/gtest.h>
+
+#include "render/mipmaps.h"
+#include "render/render.h"
+
+#include "doc/cel.h"
+#include "doc/document.h"
+#include "doc/image.h"
+#include "doc/layer.h"
+#include "doc/primitives.h"
+#include "doc/sprite.h"
+
+#include <memory>
+
+using namespace doc;
+using namespace render;
+
+static void fill_with_coords(Image* image)
+{
+  for (int y = 0; y < image->height(); ++y)
+    for (int x = 0; x < image->width(); ++x)
+      put_pixel(image, x, y, rgba(x, y, x ^ y, 255));
+}
+
+TEST(Mipmaps, NearestLevels)
+{
+  ImageRef image(Image::create(IMAGE_RGB, 9, 8));
+  fill_with_coords(image.get());
+
+  Mipmaps mipmaps(Mipmaps::kDefaultMaxMemSize, 0);
+  int level;
+
+  // Odd steps cannot use a mipmap level
+  EXPECT_EQ(image.get(), mipmaps.getLevel(image.get(), 3, 3, level));
+  EXPECT_EQ(0, level);
+
+  const Image* level2 = mipmaps.getLevel(image.get(), 4, 8, level);
+  EXPECT_EQ(2, level);
+  ASSERT_NE(nullptr, level2);
+  EXPECT_EQ(2, level2->width());
+  EXPECT_EQ(2, level2->height());
+  for (int y = 0; y < level2->height(); ++y)
+    for (int x = 0; x < level2->width(); ++x)
+      EXPECT_EQ(get_pixel(image.get(), x * 4, y * 4), get_pixel(level2, x, y));
+
+  // The level is cached
+  EXPECT_EQ(level2, mipmaps.getLevel(image.get(), 12, 4, level));
+  EXPECT_EQ(2, level);
+
+  // Level 3 is limited by the image size
+  const Image* level3 = mipmaps.getLevel(image.get(), 16, 16, level);
+  EXPECT_EQ(3, level);
+  EXPECT_EQ(1, level3->width());
+  EXPECT_EQ(1, level3->height());
+  EXPECT_EQ(get_pixel(image.get(), 0, 0), get_pixel(level3, 0, 0));
+}
+
+TEST(Mipmaps, InvalidateByVersion)
+{
+  ImageRef image(Image::create(IMAGE_INDEXED, 4, 4));
+  clear_image(image.get(), 1);
+
+  Mipmaps mipmaps(Mipmaps::kDefaultMaxMemSize, 0);
+  int level;
+  const Image* level1 = mipmaps.getLevel(image.get(), 2, 2, level);
+  EXPECT_EQ(1, level);
+  EXPECT_EQ(1, get_pixel(level1, 1, 1));
+
+  put_pixel(image.get(), 2, 2, 5);
+  image->incrementVersion();
+
+  level1 = mipmaps.getLevel(image.get(), 2, 2, level);
+  EXPECT_EQ(1, level);
+  EXPECT_EQ(5, get_pixel(level1, 1, 1));
+}
+
+TEST(Mipmaps, MaxMemSize)
+{
+  ImageRef a(Image::create(IMAGE_RGB, 64, 64));
+  ImageRef b(Image::create(IMAGE_RGB, 64, 64));
+
+  Mipmaps mipmaps(Mipmaps::kDefaultMaxMemSize, 0);
+  int level;
+  mipmaps.getLevel(a.get(), 2, 2, level);
+  const std::size_t oneLevel = mipmaps.memSize();
+  EXPECT_LT(0, oneLevel);
+
+  mipmaps.getLevel(b.get(), 2, 2, level);
+  EXPECT_EQ(2 * oneLevel, mipmaps.memSize());
+
+  // Only the most recently used pyramid (b) is kept
+  mipmaps.setMaxMemSize(oneLevel);
+  EXPECT_EQ(oneLevel, mipmaps.memSize());
+
+  mipmaps.clear();
+  EXPECT_EQ(0, mipmaps.memSize());
+}
+
+TEST(Mipmaps, RenderSameResult)
+{
+  std::shared_ptr<Document> doc = std::make_shared<Document>();
+  doc->sprites().add(Sprite::MakeStdSprite(ImageSpec(ColorMode::RGB, 37, 29)));
+  Image* src = doc->sprite()->root()->firstLayer()->cel(0)->image();
+  fill_with_coords(src);
+
+  Render render;
+  render.setBgOptions(BgOptions::MakeTransparent());
+
+  for (int step : { 2, 4, 6, 8, 16 }) {
+    render.setProjection(Projection(PixelRatio(1, 1), Zoom(1, step)));
+
+    const int w = 37 / step + 1;
+    const int h = 29 / step + 1;
+    ImageRef expected(Image::create(IMAGE_RGB, w, h));
+    ImageRef result(Image::create(IMAGE_RGB, w, h));
+    clear_image(expected.get(), 0);
+    clear_image(result.get(), 0);
+
+    render.setMipmaps(nullptr);
+    render.renderSprite(expected.get(), doc->sprite(), frame_t(0), gfx::Clip(0, 0, 0, 0, w, h));
+
+    render.setMipmaps(std::make_shared<Mipmaps>(Mipmaps::kDefaultMaxMemSize, 0));
+    render.renderSprite(result.get(), doc->sprite(), frame_t(0), gfx::Clip(0, 0, 0, 0, w, h));
+
+    for (int y = 0; y < h; ++y)
+      for (int x = 0; x < w; ++x)
+        EXPECT_EQ(get_pixel(expected.get(), x, y), get_pixel(result.get(), x, y))
+          << " step=" << step << " x=" << x << " y=" << y;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
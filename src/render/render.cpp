@@ -23,8 +23,12 @@
 #include "doc/tilesets.h"
 #include "gfx/clip.h"
 #include "gfx/region.h"
+#include "render/tileset_atlas.h"
+#include "trace/trace.h"
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 #define TRACE_RENDER_CEL(...) // TRACE
 
@@ -513,6 +517,25 @@ CompositeImageFunc get_fastest_composition_path(const Projection& proj,
   }
 }
 
+template<class SrcTraits>
+bool is_composite_image_scale_down_from(const CompositeImageFunc func)
+{
+  return (func == composite_image_scale_down<RgbTraits, SrcTraits> ||
+          func == composite_image_scale_down<GrayscaleTraits, SrcTraits> ||
+          func == composite_image_scale_down<IndexedTraits, SrcTraits>);
+}
+
+// Returns true if the given function is one of the
+// composite_image_scale_down() specializations, i.e. the only
+// composite function where we can use a mipmap level of the source
+// image and get the same result.
+bool is_composite_image_scale_down(const CompositeImageFunc func)
+{
+  return (is_composite_image_scale_down_from<RgbTraits>(func) ||
+          is_composite_image_scale_down_from<GrayscaleTraits>(func) ||
+          is_composite_image_scale_down_from<IndexedTraits>(func));
+}
+
 bool has_visible_reference_layers(const LayerGroup* group)
 {
   for (const Layer* child : group->layers()) {
@@ -528,6 +551,9 @@ bool has_visible_reference_layers(const LayerGroup* group)
   return false;
 }
 
+// Maximum memory used by the images of Render::setPreviewLayersCache()
+constexpr std::size_t kMaxLayersCacheSize = 256 * 1024 * 1024;
+
 } // anonymous namespace
 
 Render::Render()
@@ -579,6 +605,11 @@ void Render::setProjection(const Projection& projection)
   m_proj = projection;
 }
 
+void Render::setMipmaps(const MipmapsPtr& mipmaps)
+{
+  m_mipmaps = mipmaps;
+}
+
 void Render::setBgOptions(const BgOptions& bg)
 {
   m_bg = bg;
@@ -602,6 +633,16 @@ void Render::setPreviewImage(const Layer* layer,
   m_previewTileset = tileset;
   m_previewPos = pos;
   m_previewBlendMode = blendMode;
+  m_layersCache = LayersCache();
+}
+
+void Render::setPreviewLayersCache(const gfx::Rect& bounds)
+{
+  m_layersCache = LayersCache();
+
+  // Two RGB images (below and above layers)
+  if (std::size_t(bounds.w) * bounds.h * 4 * 2 <= kMaxLayersCacheSize)
+    m_layersCache.bounds = bounds;
 }
 
 void Render::setExtraImage(ExtraType type,
@@ -623,6 +664,7 @@ void Render::removePreviewImage()
 {
   m_previewImage = nullptr;
   m_previewTileset = nullptr;
+  m_layersCache = LayersCache();
 }
 
 void Render::removeExtraImage()
@@ -700,13 +742,17 @@ void Render::renderSprite(Image* dstImage,
 
   // New Blending Method:
   if (m_newBlendMethod) {
-    // Clear dstImage with the bg_color (if the background is not a
-    // special background pattern like the checkered background, this
-    // is enough as a base color).
-    fill_rect(dstImage, area.dstBounds(), bg_color);
-
-    // Draw the Background layer - Onion skin behind the sprite - Transparent Layers
-    renderSpriteLayers(dstImage, area, frame, compositeImage);
+    // Composite only the preview layer if we have the other layers
+    // cached (e.g. while the user is painting)
+    if (!renderSpriteLayersWithCache(dstImage, area, frame, compositeImage, bg_color)) {
+      // Clear dstImage with the bg_color (if the background is not a
+      // special background pattern like the checkered background, this
+      // is enough as a base color).
+      fill_rect(dstImage, area.dstBounds(), bg_color);
+
+      // Draw the Background layer - Onion skin behind the sprite - Transparent Layers
+      renderSpriteLayers(dstImage, area, frame, compositeImage);
+    }
 
     // In case that we need a special background (e.g. like the
     // checkered pattern), we can draw the background in a temporal
@@ -773,6 +819,146 @@ void Render::renderSpriteLayers(Image* dstImage,
   renderPlan(plan, dstImage, area, frame, compositeImage, false, true, BlendMode::UNSPECIFIED);
 }
 
+bool Render::renderSpriteLayersWithCache(Image* dstImage,
+                                         const gfx::ClipF& areaF,
+                                         const frame_t frame,
+                                         const CompositeImageFunc compositeImage,
+                                         const color_t bg_color)
+{
+  if (m_layersCache.bounds.isEmpty() || !m_previewImage || !m_selectedLayer ||
+      m_selectedFrame != frame || m_onionskin.type() != OnionskinType::NONE ||
+      m_proj.scaleX() != 1.0 || m_proj.scaleY() != 1.0 || dstImage->pixelFormat() != IMAGE_RGB ||
+      // The extra cel is not cached, so it must be in the preview layer
+      (m_extraCel && m_extraType != ExtraType::NONE && m_currentLayer != m_selectedLayer)) {
+    return false;
+  }
+
+  const gfx::Clip area(areaF);
+  if (!m_layersCache.bounds.contains(area.srcBounds()))
+    return false;
+
+  if (m_layersCache.below) {
+    // The cache was created with other options (e.g. from other
+    // editor of the same sprite)
+    if (m_layersCache.sprite != m_sprite || m_layersCache.frame != frame ||
+        m_layersCache.flags != m_flags ||
+        m_layersCache.nonactiveLayersOpacity != m_nonactiveLayersOpacity ||
+        m_layersCache.selectedLayerForOpacity != m_selectedLayerForOpacity) {
+      return false;
+    }
+  }
+  else if (!createLayersCache(frame, compositeImage, bg_color)) {
+    // Don't try to create the cache again for this preview image
+    m_layersCache.bounds = gfx::Rect();
+    return false;
+  }
+
+  gfx::Rect src = area.srcBounds();
+  src.offset(-m_layersCache.bounds.x, -m_layersCache.bounds.y);
+
+  dstImage->copy(m_layersCache.below.get(), gfx::Clip(area.dst.x, area.dst.y, src));
+
+  doc::RenderPlan plan(m_composeGroups);
+  plan.addLayer(m_selectedLayer, frame);
+  m_globalOpacity = 255;
+  renderPlan(plan, dstImage, area, frame, compositeImage, true, true, BlendMode::UNSPECIFIED);
+
+  if (m_layersCache.above) {
+    CompositeImageFunc compositeAbove = getImageComposition(IMAGE_RGB, IMAGE_RGB, nullptr);
+    compositeAbove(dstImage,
+                   m_layersCache.above.get(),
+                   m_sprite->palette(frame),
+                   gfx::ClipF(area.dst.x, area.dst.y, src.x, src.y, src.w, src.h),
+                   255,
+                   BlendMode::NORMAL,
+                   1.0,
+                   1.0,
+                   m_newBlendMethod,
+                   notile);
+  }
+  return true;
+}
+
+bool Render::createLayersCache(const frame_t frame,
+                               const CompositeImageFunc compositeImage,
+                               const color_t bg_color)
+{
+  TRACE_ZONE("Render::createLayersCache");
+
+  doc::RenderPlan plan(m_composeGroups);
+  plan.addLayer(m_sprite->root(), frame);
+
+  const auto& items = plan.items();
+  const int nitems = int(items.size());
+  int layerIndex = -1;
+  for (int i = 0; i < nitems; ++i) {
+    if (items[i].layer == m_selectedLayer) {
+      layerIndex = i;
+      break;
+    }
+  }
+  // The preview layer is inside a group that is composed as a whole
+  if (layerIndex < 0)
+    return false;
+
+  for (int i = 0; i < nitems; ++i) {
+    // The background layer is always rendered first (see
+    // renderSpriteLayers()), so we can render the cached layers in
+    // one pass only if it is the first item (e.g. it's not the case
+    // if a cel has a negative z-index).
+    if (i > 0 && items[i].layer->isBackground())
+      return false;
+
+    // The layers above are merged in one image and then composited
+    // with the normal blend mode, so all of them must use the normal
+    // blend mode to get a similar result.
+    if (i > layerIndex && items[i].layer->blendMode() != BlendMode::NORMAL)
+      return false;
+  }
+
+  const gfx::Rect& bounds = m_layersCache.bounds;
+  const gfx::Clip area(0, 0, bounds);
+
+  m_globalOpacity = 255;
+  ImageRef below(Image::create(IMAGE_RGB, bounds.w, bounds.h));
+  clear_image(below.get(), bg_color);
+  renderPlanItems(plan,
+                  0,
+                  layerIndex,
+                  below.get(),
+                  area,
+                  frame,
+                  compositeImage,
+                  true,
+                  true,
+                  BlendMode::UNSPECIFIED);
+
+  ImageRef above;
+  if (layerIndex + 1 < nitems) {
+    above.reset(Image::create(IMAGE_RGB, bounds.w, bounds.h));
+    clear_image(above.get(), 0);
+    renderPlanItems(plan,
+                    layerIndex + 1,
+                    nitems,
+                    above.get(),
+                    area,
+                    frame,
+                    compositeImage,
+                    true,
+                    true,
+                    BlendMode::UNSPECIFIED);
+  }
+
+  m_layersCache.sprite = m_sprite;
+  m_layersCache.frame = frame;
+  m_layersCache.flags = m_flags;
+  m_layersCache.nonactiveLayersOpacity = m_nonactiveLayersOpacity;
+  m_layersCache.selectedLayerForOpacity = m_selectedLayerForOpacity;
+  m_layersCache.below = below;
+  m_layersCache.above = above;
+  return true;
+}
+
 void Render::renderBackground(Image* image,
                               const Layer* bgLayer,
                               const color_t bg_color,
@@ -972,7 +1158,34 @@ void Render::renderPlan(RenderPlan& plan,
                         const bool render_transparent,
                         const BlendMode blendMode)
 {
-  for (const auto& item : plan.items()) {
+  TRACE_ZONE("Render::renderPlan");
+
+  renderPlanItems(plan,
+                  0,
+                  int(plan.items().size()),
+                  image,
+                  area,
+                  frame,
+                  compositeImage,
+                  render_background,
+                  render_transparent,
+                  blendMode);
+}
+
+void Render::renderPlanItems(RenderPlan& plan,
+                             const int firstItem,
+                             const int lastItem,
+                             Image* image,
+                             const gfx::Clip& area,
+                             const frame_t frame,
+                             const CompositeImageFunc compositeImage,
+                             const bool render_background,
+                             const bool render_transparent,
+                             const BlendMode blendMode)
+{
+  const auto& items = plan.items();
+  for (int i = firstItem; i < lastItem; ++i) {
+    const auto& item = items[i];
     const Cel* cel = item.cel;
     const Layer* layer = item.layer;
 
@@ -1281,6 +1494,22 @@ void Render::renderCel(Image* dst_image,
 
     tilesToDraw &= cel_image->bounds();
 
+    // Draw all tiles at once from the RGB atlas of the tileset. The
+    // preview tileset is excluded because its tiles are modified
+    // without changing their versions.
+    if (dst_image->pixelFormat() == IMAGE_RGB && tileset != m_previewTileset &&
+        renderTilemapWithAtlas(dst_image,
+                               cel_image,
+                               tileset,
+                               pal,
+                               grid,
+                               area,
+                               opacity,
+                               blendMode,
+                               tilesToDraw.w * tilesToDraw.h)) {
+      return;
+    }
+
     TRACE_RENDER_CEL("Drawing tilemap (%d %d %d %d)\n",
                      tilesToDraw.x,
                      tilesToDraw.y,
@@ -1331,6 +1560,129 @@ void Render::renderCel(Image* dst_image,
   }
 }
 
+// Renders the whole tilemap reading the pixels of each tile from the
+// RGB atlas of the tileset. Each pixel of the destination is
+// sampled once from the canvas (nearest-neighbor, like
+// composite_image_general() does with an image), so the cost depends
+// on the number of destination pixels instead of the number of
+// visible tiles. Returns false if this path cannot be used, or if
+// creating/updating the atlas would convert more tiles than the
+// "visibleTiles" that the per-tile path would render.
+bool Render::renderTilemapWithAtlas(Image* dst_image,
+                                    const Image* cel_image,
+                                    const Tileset* tileset,
+                                    const Palette* pal,
+                                    const doc::Grid& grid,
+                                    const gfx::Clip& area,
+                                    const int opacity,
+                                    const BlendMode blendMode,
+                                    const int visibleTiles)
+{
+  ASSERT(dst_image->pixelFormat() == IMAGE_RGB);
+
+  // Only for rectangular grids where tiles don't overlap
+  const gfx::Size tileSize = grid.tileSize();
+  if (blendMode == BlendMode::SRC || grid.tileOffset() != gfx::Point(tileSize) ||
+      grid.oddRowOffset() != gfx::Point(0, 0) || grid.oddColOffset() != gfx::Point(0, 0)) {
+    return false;
+  }
+
+  // The atlas is shared with other renders (and kept between renders)
+  const TilesetAtlases::AtlasPtr atlas =
+    TilesetAtlases::instance()->getAtlas(tileset, pal, visibleTiles);
+  if (!atlas || atlas->tileSize != tileSize)
+    return false;
+
+  TRACE_ZONE("Render::renderTilemapWithAtlas");
+
+  if (cel_image->isUniform())
+    cel_image = getUniformImagePixels(cel_image);
+
+  const gfx::Rect dstBounds = area.dstBounds().createIntersection(dst_image->bounds());
+  if (dstBounds.isEmpty())
+    return true;
+
+  const double sx = m_proj.scaleX();
+  const double sy = m_proj.scaleY();
+  const double ox = m_proj.applyX(double(grid.origin().x));
+  const double oy = m_proj.applyY(double(grid.origin().y));
+  const int tw = tileSize.w;
+  const int th = tileSize.h;
+  const int minSize = std::min(tw, th);
+
+  // Tile column and x-coordinate inside the tile of each column of
+  // the destination (u=-1 if it's outside the tilemap).
+  std::vector<int> colTile(dstBounds.w, -1);
+  std::vector<int> colPixel(dstBounds.w, 0);
+  for (int x = 0; x < dstBounds.w; ++x) {
+    const double px = double(dstBounds.x + x - area.dst.x + area.src.x) - ox;
+    if (px < 0.0)
+      continue;
+    const int canvasX = int(px / sx);
+    const int u = canvasX / tw;
+    if (u < cel_image->width()) {
+      colTile[x] = u;
+      colPixel[x] = canvasX % tw;
+    }
+  }
+
+  BlenderHelper<RgbTraits, RgbTraits> blender(dst_image,
+                                              atlas->image.get(),
+                                              pal,
+                                              blendMode,
+                                              m_newBlendMethod);
+  const Image* atlasImage = atlas->image.get();
+
+  for (int y = 0; y < dstBounds.h; ++y) {
+    const double py = double(dstBounds.y + y - area.dst.y + area.src.y) - oy;
+    if (py < 0.0)
+      continue;
+    const int canvasY = int(py / sy);
+    const int v = canvasY / th;
+    if (v >= cel_image->height())
+      break;
+    const int tileY = canvasY % th;
+
+    auto tilesRow = get_pixel_address_fast<TilemapTraits>(cel_image, 0, v);
+    auto dstPtr = get_pixel_address_fast<RgbTraits>(dst_image, dstBounds.x, dstBounds.y + y);
+
+    for (int x = 0; x < dstBounds.w; ++x, ++dstPtr) {
+      const int u = colTile[x];
+      if (u < 0)
+        continue;
+
+      const tile_t t = tilesRow[u];
+      if (t == doc::notile)
+        continue;
+
+      const tile_index ti = tile_geti(t);
+      if (!atlas->isValidTile(ti))
+        continue;
+
+      int srcX = colPixel[x];
+      int srcY = tileY;
+      if (const tile_flags flags = tile_getf(t)) {
+        if (flags & tile_f_xflip)
+          srcX = tw - 1 - srcX;
+        if (flags & tile_f_yflip)
+          srcY = th - 1 - srcY;
+        if (flags & tile_f_dflip) {
+          std::swap(srcX, srcY);
+          // Same as composite_image_general_with_tile_flags()
+          if (srcX >= minSize || srcY >= minSize) {
+            *dstPtr = 0;
+            continue;
+          }
+        }
+      }
+
+      const auto srcPtr = get_pixel_address_fast<RgbTraits>(atlasImage, srcX, ti * th + srcY);
+      *dstPtr = blender(*dstPtr, *srcPtr, opacity);
+    }
+  }
+  return true;
+}
+
 void Render::renderImage(Image* dst_image,
                          const Image* cel_image,
                          const Palette* pal,
@@ -1346,12 +1698,32 @@ void Render::renderImage(Image* dst_image,
   if (srcBounds.isEmpty())
     return;
 
+  if (cel_image->isUniform())
+    cel_image = getUniformImagePixels(cel_image);
+
   // Get the function to composite the tile with the given flip flags
   if (tileFlags) {
     compositeImage =
       getImageComposition(dst_image->pixelFormat(), cel_image->pixelFormat(), nullptr, tileFlags);
   }
 
+  double sx = m_proj.scaleX() * celBounds.w / double(cel_image->width());
+  double sy = m_proj.scaleY() * celBounds.h / double(cel_image->height());
+
+  // Use a smaller level of the image when we are zooming out. The
+  // preview/extra images are excluded because they are modified
+  // without changing their version (e.g. in the middle of a stroke).
+  if (m_mipmaps && !tileFlags && sx < 1.0 && sy < 1.0 && cel_image != m_previewImage &&
+      cel_image != m_extraImage && is_composite_image_scale_down(compositeImage)) {
+    int level;
+    cel_image = m_mipmaps->getLevel(cel_image,
+                                    int(std::round(1.0 / sx)),
+                                    int(std::round(1.0 / sy)),
+                                    level);
+    sx *= double(1 << level);
+    sy *= double(1 << level);
+  }
+
   compositeImage(dst_image,
                  cel_image,
                  pal,
@@ -1363,8 +1735,8 @@ void Render::renderImage(Image* dst_image,
                             srcBounds.h),
                  opacity,
                  blendMode,
-                 m_proj.scaleX() * celBounds.w / double(cel_image->width()),
-                 m_proj.scaleY() * celBounds.h / double(cel_image->height()),
+                 sx,
+                 sy,
                  m_newBlendMethod,
                  tileFlags);
 }
@@ -1467,6 +1839,27 @@ bool Render::checkIfWeShouldUsePreview(const Cel* cel) const
   return false;
 }
 
+// Returns an image with the same pixels as the given uniform image.
+// The image is re-used between uniform images with the same spec and
+// color (e.g. the background cels of all frames), so we don't need to
+// create the pixels of each uniform image to render it.
+const Image* Render::getUniformImagePixels(const Image* image)
+{
+  ASSERT(image->isUniform());
+
+  if (!m_uniformImage || m_uniformImageColor != image->uniformColor() ||
+      m_uniformImage->pixelFormat() != image->pixelFormat() ||
+      m_uniformImage->size() != image->size() ||
+      m_uniformImage->maskColor() != image->maskColor()) {
+    // Create a new image (instead of clearing the old one) so a new
+    // image ID is used as mipmaps key.
+    m_uniformImage.reset(Image::create(image->spec()));
+    m_uniformImage->clear(image->uniformColor());
+    m_uniformImageColor = image->uniformColor();
+  }
+  return m_uniformImage.get();
+}
+
 void composite_image(Image* dst,
                      const Image* src,
                      const Palette* pal,
@@ -1,5 +1,5 @@
 // Aseprite Render Library
-// Copyright (c) 2019-2023 Igara Studio S.A.
+// Copyright (c) 2019-2026 Igara Studio S.A.
 // Copyright (c) 2001-2018 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -18,14 +18,17 @@
 #include "doc/tile.h"
 #include "gfx/clip.h"
 #include "gfx/point.h"
+#include "gfx/rect.h"
 #include "gfx/size.h"
 #include "render/bg_options.h"
 #include "render/extra_type.h"
+#include "render/mipmaps.h"
 #include "render/onionskin_options.h"
 #include "render/projection.h"
 
 namespace doc {
 class Cel;
+class Grid;
 class Image;
 class Layer;
 class Palette;
@@ -61,6 +64,11 @@ public:
   void setNewBlend(const bool newBlend);
   void setComposeGroups(bool composeGroup);
   void setProjection(const Projection& projection);
+
+  // Sets a cache of mipmap levels to be used to render cel images
+  // when the projection scales down the sprite (zoom < 100%). Can
+  // be nullptr to disable mipmaps (the default).
+  void setMipmaps(const MipmapsPtr& mipmaps);
   void setBgOptions(const BgOptions& bg);
   void setSelectedLayer(const Layer* layer);
 
@@ -74,6 +82,15 @@ public:
                        const BlendMode blendMode);
   void removePreviewImage();
 
+  // Caches the composite of the layers below and above the preview
+  // layer in the given sprite bounds (e.g. the visible area of the
+  // editor when the user starts a stroke), so renderSprite() only
+  // needs to composite the preview layer between both cached
+  // images. The cache is discarded with the next setPreviewImage()
+  // or removePreviewImage() call, so the other layers must not be
+  // modified meanwhile.
+  void setPreviewLayersCache(const gfx::Rect& bounds);
+
   // Sets an extra cel/image to be drawn after the current
   // layer/frame.
   void setExtraImage(ExtraType type,
@@ -130,6 +147,16 @@ private:
                           frame_t frame,
                           CompositeImageFunc compositeImage);
 
+  bool renderSpriteLayersWithCache(Image* dstImage,
+                                   const gfx::ClipF& area,
+                                   const frame_t frame,
+                                   const CompositeImageFunc compositeImage,
+                                   const color_t bg_color);
+
+  bool createLayersCache(const frame_t frame,
+                         const CompositeImageFunc compositeImage,
+                         const color_t bg_color);
+
   void renderBackground(Image* image,
                         const Layer* bgLayer,
                         const color_t bg_color,
@@ -151,6 +178,18 @@ private:
                   const bool render_transparent,
                   const BlendMode blendMode);
 
+  // Renders the items [firstItem, lastItem) of the plan.
+  void renderPlanItems(doc::RenderPlan& plan,
+                       const int firstItem,
+                       const int lastItem,
+                       Image* image,
+                       const gfx::Clip& area,
+                       const frame_t frame,
+                       const CompositeImageFunc compositeImage,
+                       const bool render_background,
+                       const bool render_transparent,
+                       const BlendMode blendMode);
+
   void renderCel(Image* dst_image,
                  const Cel* cel,
                  const Image* cel_image,
@@ -162,6 +201,16 @@ private:
                  const int opacity,
                  const BlendMode blendMode);
 
+  bool renderTilemapWithAtlas(Image* dst_image,
+                              const Image* cel_image,
+                              const Tileset* tileset,
+                              const Palette* pal,
+                              const doc::Grid& grid,
+                              const gfx::Clip& area,
+                              const int opacity,
+                              const BlendMode blendMode,
+                              const int visibleTiles);
+
   void renderImage(Image* dst_image,
                    const Image* cel_image,
                    const Palette* pal,
@@ -179,6 +228,8 @@ private:
 
   bool checkIfWeShouldUsePreview(const Cel* cel) const;
 
+  const Image* getUniformImagePixels(const Image* image);
+
   int m_flags;
   int m_nonactiveLayersOpacity;
   const Sprite* m_sprite;
@@ -202,6 +253,26 @@ private:
   OnionskinOptions m_onionskin;
   ImageBufferPtr m_tmpBuf;
   bool m_composeGroups = false;
+  MipmapsPtr m_mipmaps;
+  // Pixels of the last rendered uniform image (so we don't need to
+  // create the pixels of each uniform cel, e.g. background cels)
+  ImageRef m_uniformImage;
+  color_t m_uniformImageColor = 0;
+
+  // Composite of the layers below and above the preview layer (see
+  // setPreviewLayersCache()). The images are created in the first
+  // renderSprite() with the preview image.
+  struct LayersCache {
+    gfx::Rect bounds;
+    const Sprite* sprite = nullptr;
+    frame_t frame = -1;
+    int flags = 0;
+    int nonactiveLayersOpacity = 255;
+    const Layer* selectedLayerForOpacity = nullptr;
+    ImageRef below; // Layers below the preview layer (with the bg_color)
+    ImageRef above; // Layers above (nullptr if there are no layers above)
+  };
+  LayersCache m_layersCache;
 };
 
 void composite_image(Image* dst,
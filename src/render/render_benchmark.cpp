@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2019-2024 Igara Studio S.A.
+// Copyright (c) 2019-2026 Igara Studio S.A.
 //
 // This file is released under the terms of the MIT license.
 // Read LICENSE.txt for more information.
@@ -13,12 +13,17 @@
 #include "doc/cel.h"
 #include "doc/image.h"
 #include "doc/layer.h"
+#include "doc/layer_tilemap.h"
 #include "doc/palette.h"
 #include "doc/primitives.h"
 #include "doc/sprite.h"
+#include "doc/tileset.h"
+#include "doc/tilesets.h"
 
 #include <benchmark/benchmark.h>
 
+#include <memory>
+
 using namespace doc;
 using namespace render;
 
@@ -77,4 +82,51 @@ BENCHMARK(Bm_Render)
   ->Args({ 4096, 4096 })
   ->Unit(benchmark::kMicrosecond);
 
+// Renders an indexed tilemap of "tiles x tiles" tiles (of 16x16
+// pixels) with the given zoom out (scale = 1/zoomOut).
+static void Bm_RenderTilemap(benchmark::State& state)
+{
+  const int tiles = state.range(0);
+  const int zoomOut = state.range(1);
+  const int tileSize = 16;
+  const int w = tiles * tileSize;
+
+  std::unique_ptr<Sprite> spr(new Sprite(ImageSpec(ColorMode::INDEXED, w, w), 256));
+  auto tileset = new Tileset(spr.get(), Grid::MakeRect(gfx::Size(tileSize, tileSize)), 64);
+  for (tile_index ti = 1; ti < 64; ++ti) {
+    ImageRef tile(Image::create(IMAGE_INDEXED, tileSize, tileSize));
+    clear_image(tile.get(), 0);
+    fill_rect(tile.get(), ti % 8, ti / 8, tileSize - 1, tileSize - 1, ti);
+    tileset->set(ti, tile);
+  }
+  spr->tilesets()->add(tileset);
+
+  auto lay = new LayerTilemap(spr.get(), 0);
+  spr->root()->addLayer(lay);
+  ImageRef tilemap(Image::create(IMAGE_TILEMAP, tiles, tiles));
+  for (int y = 0; y < tiles; ++y) {
+    for (int x = 0; x < tiles; ++x) {
+      const tile_flags flags = ((x + y) % 2 ? tile_f_xflip : 0);
+      put_pixel(tilemap.get(), x, y, doc::tile((x * 7 + y * 13) % 64, flags));
+    }
+  }
+  lay->addCel(new Cel(frame_t(0), tilemap));
+
+  const int dstSize = w / zoomOut;
+  std::unique_ptr<Image> dst(Image::create(IMAGE_RGB, dstSize, dstSize));
+
+  Render render;
+  render.setProjection(Projection(PixelRatio(1, 1), Zoom(1, zoomOut)));
+  for (auto _ : state) {
+    clear_image(dst.get(), 0);
+    render.renderSprite(dst.get(), spr.get(), frame_t(0), gfx::Clip(0, 0, 0, 0, dstSize, dstSize));
+  }
+}
+
+BENCHMARK(Bm_RenderTilemap)
+  ->Args({ 64, 1 })
+  ->Args({ 256, 4 })
+  ->Args({ 1000, 16 })
+  ->Unit(benchmark::kMicrosecond);
+
 BENCHMARK_MAIN();
@@ -1,5 +1,5 @@
 // Aseprite Render Library
-// Copyright (c) 2019-2023 Igara Studio S.A.
+// Copyright (c) 2019-2026 Igara Studio S.A.
 // Copyright (c) 2001-2018 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -17,8 +17,12 @@
 #include "doc/document.h"
 #include "doc/image.h"
 #include "doc/layer.h"
+#include "doc/layer_tilemap.h"
 #include "doc/palette.h"
 #include "doc/primitives.h"
+#include "doc/tileset.h"
+#include "doc/tilesets.h"
+#include "render/tileset_atlas.h"
 
 #include <memory>
 
@@ -251,6 +255,241 @@ TEST(Render, BugWithMultiplesOf3ZoomFactors)
   }
 }
 
+TYPED_TEST(RenderAllModes, UniformImage)
+{
+  typedef TypeParam ImageTraits;
+
+  std::shared_ptr<Document> doc = std::make_shared<Document>();
+  doc->sprites().add(Sprite::MakeStdSprite(ImageSpec(ImageTraits::color_mode, 8, 8)));
+
+  Cel* cel = doc->sprite()->root()->firstLayer()->cel(0);
+  cel->setPosition(1, 1);
+  clear_image(cel->image(), 1);
+
+  std::unique_ptr<Image> expected(Image::create(ImageTraits::pixel_format, 8, 8));
+  std::unique_ptr<Image> result(Image::create(ImageTraits::pixel_format, 8, 8));
+
+  Render render;
+  for (int scale : { 1, 2 }) {
+    render.setProjection(Projection(PixelRatio(1, 1), Zoom(1, scale)));
+    const gfx::Clip area(0, 0, 0, 0, 8 / scale, 8 / scale);
+
+    cel->data()->setImage(ImageRef(Image::create(cel->image()->spec())), cel->layer());
+    clear_image(cel->image(), 1);
+    clear_image(expected.get(), 0);
+    render.renderSprite(expected.get(), doc->sprite(), frame_t(0), area);
+
+    cel->data()->setImage(ImageRef(Image::createUniform(cel->image()->spec(), 1)), cel->layer());
+    clear_image(result.get(), 0);
+    render.renderSprite(result.get(), doc->sprite(), frame_t(0), area);
+
+    // The uniform image doesn't need its pixels to be rendered
+    EXPECT_TRUE(cel->image()->isUniform());
+
+    for (int y = 0; y < 8; ++y)
+      for (int x = 0; x < 8; ++x)
+        EXPECT_EQ(get_pixel(expected.get(), x, y), get_pixel(result.get(), x, y))
+          << " scale=" << scale << " x=" << x << " y=" << y;
+  }
+}
+
+TEST(Render, PreviewLayersCache)
+{
+  std::shared_ptr<Document> doc = std::make_shared<Document>();
+  Sprite* sprite = Sprite::MakeStdSprite(ImageSpec(ColorMode::RGB, 8, 8));
+  doc->sprites().add(sprite);
+
+  // Three layers: bottom, middle (the preview layer), and top with
+  // opaque and transparent pixels
+  Layer* bottom = sprite->root()->firstLayer();
+  Image* bottomImage = bottom->cel(0)->image();
+  clear_image(bottomImage, rgba(0, 0, 255, 255));
+  fill_rect(bottomImage, 0, 0, 3, 7, rgba(0, 255, 0, 128));
+
+  LayerImage* layers[2];
+  for (LayerImage*& layer : layers) {
+    layer = new LayerImage(sprite);
+    sprite->root()->addLayer(layer);
+    ImageRef image(Image::create(IMAGE_RGB, 8, 8));
+    clear_image(image.get(), 0);
+    layer->addCel(new Cel(0, image));
+  }
+  LayerImage* middle = layers[0];
+  LayerImage* top = layers[1];
+  fill_rect(top->cel(0)->image(), 2, 2, 5, 5, rgba(255, 255, 0, 255));
+
+  ImageRef preview(Image::createCopy(middle->cel(0)->image()));
+  fill_rect(preview.get(), 1, 1, 6, 3, rgba(255, 0, 0, 192));
+
+  std::unique_ptr<Image> expected(Image::create(IMAGE_RGB, 8, 8));
+  std::unique_ptr<Image> result(Image::create(IMAGE_RGB, 8, 8));
+
+  Render render;
+  BgOptions bg;
+  bg.type = BgType::CHECKERED;
+  bg.colorPixelFormat = IMAGE_RGB;
+  bg.color1 = rgba(128, 128, 128, 255);
+  bg.color2 = rgba(64, 64, 64, 255);
+  bg.stripeSize = gfx::Size(2, 2);
+  render.setBgOptions(bg);
+  render.setPreviewImage(middle, 0, preview.get(), nullptr, gfx::Point(0, 0), BlendMode::NORMAL);
+
+  auto expectSameRenders = [&](const gfx::Clip& area) {
+    clear_image(result.get(), 0);
+    clear_image(expected.get(), 0);
+    Render other;
+    other.setBgOptions(bg);
+    other.setPreviewImage(middle, 0, preview.get(), nullptr, gfx::Point(0, 0), BlendMode::NORMAL);
+    other.renderSprite(expected.get(), sprite, frame_t(0), area);
+    render.renderSprite(result.get(), sprite, frame_t(0), area);
+    for (int y = 0; y < 8; ++y)
+      for (int x = 0; x < 8; ++x)
+        EXPECT_EQ(get_pixel(expected.get(), x, y), get_pixel(result.get(), x, y))
+          << " x=" << x << " y=" << y;
+  };
+
+  render.setPreviewLayersCache(sprite->bounds());
+  expectSameRenders(gfx::Clip(0, 0, sprite->bounds()));
+  expectSameRenders(gfx::Clip(1, 2, 3, 1, 4, 5));
+
+  // The preview image can be modified (it's not cached)
+  fill_rect(preview.get(), 4, 4, 7, 7, rgba(255, 0, 255, 255));
+  expectSameRenders(gfx::Clip(2, 2, 2, 2, 6, 6));
+
+  // Other layers are cached until the next setPreviewImage()
+  clear_image(bottomImage, rgba(0, 0, 0, 255));
+  render.renderSprite(result.get(), sprite, frame_t(0), gfx::Clip(0, 0, sprite->bounds()));
+  EXPECT_EQ(rgba(0, 0, 255, 255), get_pixel(result.get(), 7, 0));
+
+  render.setPreviewImage(middle, 0, preview.get(), nullptr, gfx::Point(0, 0), BlendMode::NORMAL);
+  render.setPreviewLayersCache(sprite->bounds());
+  expectSameRenders(gfx::Clip(0, 0, sprite->bounds()));
+  EXPECT_EQ(rgba(0, 0, 0, 255), get_pixel(result.get(), 7, 0));
+
+  // Layers above with other blend modes are not cached (the result
+  // must be the same anyway)
+  top->setBlendMode(BlendMode::MULTIPLY);
+  render.setPreviewImage(middle, 0, preview.get(), nullptr, gfx::Point(0, 0), BlendMode::NORMAL);
+  render.setPreviewLayersCache(gfx::Rect(0, 0, 4, 4));
+  expectSameRenders(gfx::Clip(0, 0, 0, 0, 4, 4));
+  // Outside the cached bounds
+  expectSameRenders(gfx::Clip(0, 0, sprite->bounds()));
+}
+
+TEST(Render, TilemapWithAtlas)
+{
+  std::shared_ptr<Document> doc = std::make_shared<Document>();
+  Sprite* sprite = Sprite::MakeStdSprite(ImageSpec(ColorMode::INDEXED, 4, 4));
+  doc->sprites().add(sprite);
+
+  Palette pal(frame_t(0), 8);
+  for (int i = 0; i < 8; ++i)
+    pal.setEntry(i, rgba(32 * i, 255 - 32 * i, 16 * i, 255));
+  sprite->setPalette(&pal, false);
+
+  // Two tiles of 2x2 (the index 0 is the transparent color)
+  auto tileset = new Tileset(sprite, Grid::MakeRect(gfx::Size(2, 2)), 3);
+  const color_t tilePixels[2][4] = {
+    { 1, 2, 3, 0 },
+    { 4, 5, 6, 7 }
+  };
+  for (int i = 0; i < 2; ++i) {
+    ImageRef tile(Image::create(IMAGE_INDEXED, 2, 2));
+    for (int j = 0; j < 4; ++j)
+      put_pixel(tile.get(), j % 2, j / 2, tilePixels[i][j]);
+    tileset->set(i + 1, tile);
+  }
+  sprite->tilesets()->add(tileset);
+
+  auto tilemap = new LayerTilemap(sprite, 0);
+  sprite->root()->addLayer(tilemap);
+  ImageRef tilemapImage(Image::create(IMAGE_TILEMAP, 2, 2));
+  put_pixel(tilemapImage.get(), 0, 0, doc::tile(1, 0));
+  put_pixel(tilemapImage.get(), 1, 0, doc::tile(2, tile_f_xflip));
+  put_pixel(tilemapImage.get(), 0, 1, doc::tile(1, tile_f_yflip));
+  put_pixel(tilemapImage.get(), 1, 1, doc::tile(2, tile_f_dflip));
+  tilemap->addCel(new Cel(0, tilemapImage));
+
+  // Same pixels in a regular layer
+  Layer* layer = sprite->root()->firstLayer();
+  const color_t expectedPixels[16] = { 1, 2, 5, 4, 3, 0, 7, 6, 3, 0, 4, 6, 1, 2, 5, 7 };
+  for (int j = 0; j < 16; ++j)
+    put_pixel(layer->cel(0)->image(), j % 4, j / 4, expectedPixels[j]);
+
+  std::unique_ptr<Image> expected(Image::create(IMAGE_RGB, 8, 8));
+  std::unique_ptr<Image> result(Image::create(IMAGE_RGB, 8, 8));
+
+  Render render;
+  for (const Zoom& zoom : { Zoom(1, 1), Zoom(2, 1), Zoom(1, 2) }) {
+    render.setProjection(Projection(PixelRatio(1, 1), zoom));
+    const gfx::Clip area(0, 0, 0, 0, zoom.apply(4), zoom.apply(4));
+
+    layer->setVisible(true);
+    tilemap->setVisible(false);
+    clear_image(expected.get(), rgba(0, 0, 0, 255));
+    render.renderSprite(expected.get(), sprite, frame_t(0), area);
+
+    layer->setVisible(false);
+    tilemap->setVisible(true);
+    clear_image(result.get(), rgba(0, 0, 0, 255));
+    render.renderSprite(result.get(), sprite, frame_t(0), area);
+
+    for (int y = 0; y < 8; ++y)
+      for (int x = 0; x < 8; ++x)
+        EXPECT_EQ(get_pixel(expected.get(), x, y), get_pixel(result.get(), x, y))
+          << " scale=" << zoom.scale() << " x=" << x << " y=" << y;
+  }
+
+  // The atlas is updated when a tile is modified
+  ImageRef tile = tileset->get(1);
+  put_pixel(tile.get(), 0, 0, 7);
+  tile->incrementVersion();
+  tileset->incrementVersion();
+  render.setProjection(Projection());
+  clear_image(result.get(), rgba(0, 0, 0, 255));
+  render.renderSprite(result.get(), sprite, frame_t(0), gfx::Clip(0, 0, 0, 0, 4, 4));
+  EXPECT_EQ(pal.getEntry(7), get_pixel(result.get(), 0, 0));
+}
+
+TEST(Render, TilesetAtlases)
+{
+  std::shared_ptr<Document> doc = std::make_shared<Document>();
+  Sprite* sprite = Sprite::MakeStdSprite(ImageSpec(ColorMode::RGB, 4, 4));
+  doc->sprites().add(sprite);
+
+  auto tileset = new Tileset(sprite, Grid::MakeRect(gfx::Size(2, 2)), 8);
+  for (tile_index ti = 0; ti < 8; ++ti)
+    clear_image(tileset->get(ti).get(), rgba(ti, 0, 0, 255));
+  sprite->tilesets()->add(tileset);
+
+  TilesetAtlases atlases;
+
+  // It's not worth to convert 8 tiles to render 4 tiles
+  EXPECT_EQ(nullptr, atlases.getAtlas(tileset, nullptr, 4));
+  EXPECT_EQ(0u, atlases.memSize());
+
+  TilesetAtlases::AtlasPtr atlas = atlases.getAtlas(tileset, nullptr, 8);
+  ASSERT_NE(nullptr, atlas);
+  EXPECT_EQ(8, atlas->tiles());
+  EXPECT_EQ(rgba(5, 0, 0, 255), get_pixel(atlas->image.get(), 1, 5 * 2 + 1));
+
+  // The same atlas is returned while the tileset isn't modified (even
+  // if there are no tiles to convert)
+  EXPECT_EQ(atlas, atlases.getAtlas(tileset, nullptr, 0));
+
+  // Modified tiles are converted in a copy of the atlas if it's used
+  clear_image(tileset->get(5).get(), rgba(0, 255, 0, 255));
+  tileset->get(5)->incrementVersion();
+  tileset->incrementVersion();
+  EXPECT_EQ(nullptr, atlases.getAtlas(tileset, nullptr, 0));
+  TilesetAtlases::AtlasPtr atlas2 = atlases.getAtlas(tileset, nullptr, 1);
+  ASSERT_NE(nullptr, atlas2);
+  EXPECT_NE(atlas, atlas2);
+  EXPECT_EQ(rgba(5, 0, 0, 255), get_pixel(atlas->image.get(), 1, 5 * 2 + 1));
+  EXPECT_EQ(rgba(0, 255, 0, 255), get_pixel(atlas2->image.get(), 1, 5 * 2 + 1));
+  EXPECT_EQ(rgba(4, 0, 0, 255), get_pixel(atlas2->image.get(), 1, 4 * 2 + 1));
+}
+
 int main(int argc, char** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
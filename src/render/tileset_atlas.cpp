@@ -0,0 +1,261 @@
+// Aseprite Render Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "render/tileset_atlas.h"
+
+#include "doc/image.h"
+#include "doc/image_traits.h"
+#include "doc/palette.h"
+#include "doc/sprite.h"
+#include "doc/tileset.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace render {
+
+using namespace doc;
+
+namespace {
+
+color_t convert_pixel_to_rgb(const PixelFormat pixelFormat,
+                             const color_t c,
+                             const color_t maskColor,
+                             const Palette* palette)
+{
+  if (c == maskColor)
+    return 0;
+
+  switch (pixelFormat) {
+    case IMAGE_RGB: return c;
+    case IMAGE_GRAYSCALE:
+      return rgba(graya_getv(c), graya_getv(c), graya_getv(c), graya_geta(c));
+    case IMAGE_INDEXED: return palette->getEntry(c);
+  }
+  return 0;
+}
+
+template<typename ImageTraits>
+void convert_tile_to_rgb(const Image* tile, Image* dst, const int dstY, const Palette* palette)
+{
+  using pixel_t = typename ImageTraits::pixel_t;
+
+  const color_t maskColor = tile->maskColor();
+  for (int y = 0; y < tile->height(); ++y) {
+    auto s = (const pixel_t*)tile->getPixelAddress(0, y);
+    auto d = (RgbTraits::pixel_t*)dst->getPixelAddress(0, dstY + y);
+    for (int x = 0; x < tile->width(); ++x, ++s, ++d)
+      *d = convert_pixel_to_rgb(ImageTraits::pixel_format, *s, maskColor, palette);
+  }
+}
+
+void convert_tile(const Image* tile, Image* dst, const int dstY, const Palette* palette)
+{
+  // Uniform tiles (e.g. empty tiles) don't need their pixels
+  if (tile->isUniform()) {
+    const color_t c = convert_pixel_to_rgb(tile->pixelFormat(),
+                                           tile->uniformColor(),
+                                           tile->maskColor(),
+                                           palette);
+    for (int y = 0; y < tile->height(); ++y) {
+      auto d = (RgbTraits::pixel_t*)dst->getPixelAddress(0, dstY + y);
+      std::fill(d, d + tile->width(), c);
+    }
+    return;
+  }
+
+  switch (tile->pixelFormat()) {
+    case IMAGE_RGB:       convert_tile_to_rgb<RgbTraits>(tile, dst, dstY, palette); break;
+    case IMAGE_GRAYSCALE: convert_tile_to_rgb<GrayscaleTraits>(tile, dst, dstY, palette); break;
+    case IMAGE_INDEXED:   convert_tile_to_rgb<IndexedTraits>(tile, dst, dstY, palette); break;
+  }
+}
+
+} // anonymous namespace
+
+// static
+TilesetAtlases* TilesetAtlases::instance()
+{
+  static TilesetAtlases atlases;
+  return &atlases;
+}
+
+TilesetAtlases::TilesetAtlases(const std::size_t maxMemSize) : m_maxMemSize(maxMemSize)
+{
+}
+
+TilesetAtlases::AtlasPtr TilesetAtlases::getAtlas(const Tileset* tileset,
+                                                  const Palette* palette,
+                                                  const int maxTilesToConvert)
+{
+  const std::lock_guard lock(m_mutex);
+
+  auto it = std::find_if(m_entries.begin(), m_entries.end(), [tileset](const Entry& entry) {
+    return entry.tilesetId == tileset->id();
+  });
+  if (it != m_entries.end()) {
+    // Move to the front of the LRU list
+    m_entries.splice(m_entries.begin(), m_entries, it);
+  }
+  else {
+    m_entries.emplace_front();
+    m_entries.front().tilesetId = tileset->id();
+  }
+
+  AtlasPtr atlas = updateEntry(m_entries.front(), tileset, palette, maxTilesToConvert);
+  if (!atlas) {
+    // Don't keep empty entries
+    if (!m_entries.front().atlas)
+      removeEntry(m_entries.begin());
+    return nullptr;
+  }
+
+  shrinkToMaxMemSize();
+  return atlas;
+}
+
+void TilesetAtlases::clear()
+{
+  const std::lock_guard lock(m_mutex);
+  m_entries.clear();
+  m_memSize = 0;
+}
+
+std::size_t TilesetAtlases::memSize() const
+{
+  const std::lock_guard lock(m_mutex);
+  return m_memSize;
+}
+
+// Converts the tiles that were modified since the last time the
+// atlas was used. Returns nullptr if the tileset cannot be converted
+// (in this case the atlas of the entry is discarded too), or if too
+// many tiles must be converted (the entry is kept as it is).
+TilesetAtlases::AtlasPtr TilesetAtlases::updateEntry(Entry& entry,
+                                                     const Tileset* tileset,
+                                                     const Palette* palette,
+                                                     const int maxTilesToConvert)
+{
+  auto discardAtlas = [this, &entry]() -> AtlasPtr {
+    m_memSize -= entry.memSize;
+    entry.memSize = 0;
+    entry.atlas.reset();
+    return nullptr;
+  };
+
+  if (!tileset->sprite())
+    return discardAtlas();
+
+  const gfx::Size tileSize = tileset->grid().tileSize();
+  const int ntiles = int(tileset->size());
+  const PixelFormat pixelFormat = tileset->sprite()->pixelFormat();
+  if (tileSize.w < 1 || tileSize.h < 1 || ntiles < 1 ||
+      std::size_t(tileSize.w) * tileSize.h * ntiles * 4 > m_maxMemSize ||
+      (pixelFormat == IMAGE_INDEXED && !palette)) {
+    return discardAtlas();
+  }
+
+  // Indexed tiles must be converted again if the palette changes
+  const ObjectId paletteId = (pixelFormat == IMAGE_INDEXED ? palette->id() : NullId);
+  const int paletteModifications = (pixelFormat == IMAGE_INDEXED ? palette->getModifications() :
+                                                                   0);
+
+  const bool sameLayout = (entry.atlas && entry.atlas->tileSize == tileSize &&
+                           entry.atlas->tiles() == ntiles && entry.pixelFormat == pixelFormat &&
+                           entry.paletteId == paletteId &&
+                           entry.paletteModifications == paletteModifications);
+
+  // Nothing was modified since the last time
+  if (sameLayout && entry.tilesetVersion == tileset->version())
+    return entry.atlas;
+
+  // Tiles that must be converted (or removed from the atlas)
+  std::vector<tile_index> modifiedTiles;
+  int tilesToConvert = 0;
+  for (tile_index ti = 0; ti < tile_index(ntiles); ++ti) {
+    const ImageRef tile = tileset->get(ti);
+    if (!tile) {
+      if (!sameLayout || entry.tileIds[ti] != NullId)
+        modifiedTiles.push_back(ti);
+      continue;
+    }
+
+    if (sameLayout && entry.tileIds[ti] == tile->id() &&
+        entry.tileVersions[ti] == tile->version()) {
+      continue;
+    }
+
+    if (tile->size() != tileSize || tile->pixelFormat() != pixelFormat)
+      return discardAtlas();
+
+    modifiedTiles.push_back(ti);
+    ++tilesToConvert;
+  }
+  if (tilesToConvert > maxTilesToConvert)
+    return nullptr;
+
+  std::shared_ptr<Atlas> atlas;
+  if (!sameLayout) {
+    atlas = std::make_shared<Atlas>();
+    atlas->image.reset(Image::create(IMAGE_RGB, tileSize.w, tileSize.h * ntiles));
+    atlas->tileSize = tileSize;
+    atlas->validTiles.assign(ntiles, 0);
+    entry.pixelFormat = pixelFormat;
+    entry.paletteId = paletteId;
+    entry.paletteModifications = paletteModifications;
+    entry.tileIds.assign(ntiles, NullId);
+    entry.tileVersions.assign(ntiles, 0);
+  }
+  else if (entry.atlas.use_count() > 1) {
+    // The atlas is being used by a render (maybe in other thread), so
+    // we modify a copy of it.
+    atlas = std::make_shared<Atlas>(*entry.atlas);
+    atlas->image.reset(Image::createCopy(entry.atlas->image.get()));
+  }
+  else {
+    atlas = entry.atlas;
+  }
+
+  for (const tile_index ti : modifiedTiles) {
+    const ImageRef tile = tileset->get(ti);
+    if (!tile) {
+      atlas->validTiles[ti] = 0;
+      entry.tileIds[ti] = NullId;
+      continue;
+    }
+
+    convert_tile(tile.get(), atlas->image.get(), ti * tileSize.h, palette);
+    atlas->validTiles[ti] = 1;
+    entry.tileIds[ti] = tile->id();
+    entry.tileVersions[ti] = tile->version();
+  }
+
+  m_memSize -= entry.memSize;
+  entry.memSize = atlas->image->getMemSize();
+  m_memSize += entry.memSize;
+  entry.atlas = atlas;
+  entry.tilesetVersion = tileset->version();
+  return atlas;
+}
+
+void TilesetAtlases::removeEntry(const Entries::iterator it)
+{
+  m_memSize -= it->memSize;
+  m_entries.erase(it);
+}
+
+void TilesetAtlases::shrinkToMaxMemSize()
+{
+  // Keep the most recently used entry (it was just returned)
+  while (m_memSize > m_maxMemSize && m_entries.size() > 1)
+    removeEntry(std::prev(m_entries.end()));
+}
+
+} // namespace render
@@ -0,0 +1,114 @@
+// Aseprite Render Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef RENDER_TILESET_ATLAS_H_INCLUDED
+#define RENDER_TILESET_ATLAS_H_INCLUDED
+#pragma once
+
+#include "doc/image_ref.h"
+#include "doc/object_id.h"
+#include "doc/object_version.h"
+#include "doc/pixel_format.h"
+#include "gfx/size.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace doc {
+class Palette;
+class Tileset;
+} // namespace doc
+
+namespace render {
+
+// Cache of the tiles of each tileset converted to RGB (one tile below
+// the other in one image), so a tilemap can be rendered reading the
+// pixels of its tiles directly (without converting the pixels of each
+// tile instance through the palette, or compositing tile by tile).
+//
+// Masked pixels of the tiles are converted to 0 (transparent). The
+// atlas is checked only when the tileset version changes, and in
+// that case just the tiles which image changed are converted again
+// (all tiles if the palette changes). The least recently used
+// atlases are evicted when the cache exceeds its memory limit.
+//
+// The cache is shared by all Render instances (see instance()) so
+// short-lived renders (thumbnails, export, etc.) reuse atlases
+// created by other renders. It can be used from several threads:
+// atlases are never modified while they are used by a render (a
+// modified copy replaces them in the cache).
+class TilesetAtlases {
+public:
+  static constexpr std::size_t kDefaultMaxMemSize = 128 * 1024 * 1024;
+
+  struct Atlas {
+    // RGB image of tileSize.w x (tileSize.h * number of tiles)
+    doc::ImageRef image;
+    gfx::Size tileSize;
+    // True for each tile index that has an image
+    std::vector<uint8_t> validTiles;
+
+    int tiles() const { return int(validTiles.size()); }
+    bool isValidTile(const int ti) const { return (ti >= 0 && ti < tiles() && validTiles[ti]); }
+  };
+
+  using AtlasPtr = std::shared_ptr<const Atlas>;
+
+  static TilesetAtlases* instance();
+
+  TilesetAtlases(std::size_t maxMemSize = kDefaultMaxMemSize);
+  TilesetAtlases(const TilesetAtlases&) = delete;
+  TilesetAtlases& operator=(const TilesetAtlases&) = delete;
+
+  // Returns the RGB atlas of the given tileset, or nullptr if the
+  // tileset cannot be converted to an atlas (e.g. its tiles have a
+  // different size than the grid, or it's too big for the cache) or
+  // if more than "maxTilesToConvert" tiles must be converted to
+  // create/update the atlas (e.g. it's not worth to convert the
+  // whole tileset to render a few tiles).
+  AtlasPtr getAtlas(const doc::Tileset* tileset,
+                    const doc::Palette* palette,
+                    int maxTilesToConvert);
+
+  void clear();
+
+  std::size_t memSize() const;
+
+private:
+  struct Entry {
+    doc::ObjectId tilesetId;
+    doc::ObjectVersion tilesetVersion = 0;
+    doc::ObjectId paletteId = doc::NullId;
+    int paletteModifications = 0;
+    doc::PixelFormat pixelFormat = doc::IMAGE_RGB;
+    std::shared_ptr<Atlas> atlas;
+    // Image ID/version of each tile converted in the atlas
+    std::vector<doc::ObjectId> tileIds;
+    std::vector<doc::ObjectVersion> tileVersions;
+    std::size_t memSize = 0;
+  };
+  using Entries = std::list<Entry>;
+
+  AtlasPtr updateEntry(Entry& entry,
+                       const doc::Tileset* tileset,
+                       const doc::Palette* palette,
+                       int maxTilesToConvert);
+  void removeEntry(Entries::iterator it);
+  void shrinkToMaxMemSize();
+
+  mutable std::mutex m_mutex;
+  Entries m_entries; // Most recently used first
+  std::size_t m_memSize = 0;
+  std::size_t m_maxMemSize;
+};
+
+} // namespace render
+
+#endif
@@ -0,0 +1,167 @@
+// Aseprite Trace Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "trace/trace.h"
+
+#include "base/fstream_path.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+
+namespace {
+
+struct ZoneData {
+  const char* name;
+  uint64_t start;
+  uint64_t end;
+};
+
+// Zones recorded by one thread. Each thread adds zones to its own
+// list, so threads don't compete for the same mutex (the mutex is
+// only needed to save zones while other threads are running).
+struct ThreadZones {
+  int tid = 0;
+  std::mutex mutex;
+  std::vector<ZoneData> zones;
+};
+
+// Limit of zones per thread (to avoid using all the memory if we
+// forget to stop the tracing).
+constexpr std::size_t kMaxZonesPerThread = 4 * 1024 * 1024;
+
+const auto g_epoch = std::chrono::steady_clock::now();
+
+std::mutex g_mutex; // To access g_threads/g_nextTid
+std::vector<std::shared_ptr<ThreadZones>> g_threads;
+int g_nextTid = 1;
+
+ThreadZones* thread_zones()
+{
+  thread_local std::shared_ptr<ThreadZones> zones;
+  if (!zones) {
+    zones = std::make_shared<ThreadZones>();
+
+    const std::lock_guard lock(g_mutex);
+    zones->tid = g_nextTid++;
+    g_threads.push_back(zones);
+  }
+  return zones.get();
+}
+
+std::vector<std::shared_ptr<ThreadZones>> all_threads()
+{
+  const std::lock_guard lock(g_mutex);
+  return g_threads;
+}
+
+void write_json_string(std::ostream& f, const char* s)
+{
+  f << '"';
+  for (; *s; ++s) {
+    if (*s == '"' || *s == '\\')
+      f << '\\';
+    f << *s;
+  }
+  f << '"';
+}
+
+} // anonymous namespace
+
+namespace details {
+
+std::atomic<bool> g_enabled(false);
+
+uint64_t now()
+{
+  return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - g_epoch)
+                    .count());
+}
+
+void add_zone(const char* name, const uint64_t start, const uint64_t end)
+{
+  if (!is_enabled())
+    return;
+
+  ThreadZones* thread = thread_zones();
+  const std::lock_guard lock(thread->mutex);
+  if (thread->zones.size() < kMaxZonesPerThread)
+    thread->zones.push_back(ZoneData{ name, start, end });
+}
+
+} // namespace details
+
+void start()
+{
+  {
+    const std::lock_guard lock(g_mutex);
+
+    // Forget threads that have finished (only g_threads references
+    // their zones)
+    g_threads.erase(std::remove_if(g_threads.begin(),
+                                   g_threads.end(),
+                                   [](const auto& thread) { return thread.use_count() == 1; }),
+                    g_threads.end());
+
+    for (auto& thread : g_threads) {
+      const std::lock_guard threadLock(thread->mutex);
+      thread->zones.clear();
+    }
+  }
+  details::g_enabled.store(true);
+}
+
+void stop()
+{
+  details::g_enabled.store(false);
+}
+
+std::size_t zones_count()
+{
+  std::size_t count = 0;
+  for (const auto& thread : all_threads()) {
+    const std::lock_guard lock(thread->mutex);
+    count += thread->zones.size();
+  }
+  return count;
+}
+
+bool save_chrome_json(const std::string& filename)
+{
+  std::ofstream f(FSTREAM_PATH(filename), std::ios::binary);
+  if (!f)
+    return false;
+
+  f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (const auto& thread : all_threads()) {
+    const std::lock_guard lock(thread->mutex);
+    for (const ZoneData& zone : thread->zones) {
+      if (!first)
+        f << ",\n";
+      first = false;
+
+      // "X" are complete events (with a start time and a duration)
+      f << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->tid << ",\"name\":";
+      write_json_string(f, zone.name);
+      f << ",\"ts\":" << zone.start << ",\"dur\":" << (zone.end - zone.start) << "}";
+    }
+  }
+  f << "]}\n";
+  return f.good();
+}
+
+} // namespace trace
@@ -0,0 +1,85 @@
+// Aseprite Trace Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef TRACE_TRACE_H_INCLUDED
+#define TRACE_TRACE_H_INCLUDED
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace trace {
+
+namespace details {
+
+extern std::atomic<bool> g_enabled;
+
+// Microseconds since the program started.
+uint64_t now();
+
+void add_zone(const char* name, uint64_t start, uint64_t end);
+
+} // namespace details
+
+// Returns true if zones are being recorded.
+inline bool is_enabled()
+{
+  return details::g_enabled.load(std::memory_order_relaxed);
+}
+
+// Starts recording the zones of all threads (previously recorded
+// zones are discarded).
+void start();
+
+// Stops recording zones. Recorded zones are kept until the next
+// start() so they can be saved.
+void stop();
+
+// Number of recorded zones.
+std::size_t zones_count();
+
+// Saves the recorded zones in the Chrome trace event format (JSON),
+// which can be opened in chrome://tracing or https://ui.perfetto.dev.
+// Returns false if the file cannot be written.
+bool save_chrome_json(const std::string& filename);
+
+// Records the time between its construction and destruction as a
+// zone with the given name. The name must be a string literal (only
+// the pointer is stored). When tracing is disabled it only checks a
+// flag, so zones can be used in hot paths.
+class Zone {
+public:
+  explicit Zone(const char* name)
+    : m_name(is_enabled() ? name : nullptr)
+    , m_start(m_name ? details::now() : 0)
+  {
+  }
+
+  ~Zone()
+  {
+    if (m_name)
+      details::add_zone(m_name, m_start, details::now());
+  }
+
+  Zone(const Zone&) = delete;
+  Zone& operator=(const Zone&) = delete;
+
+private:
+  const char* m_name;
+  uint64_t m_start;
+};
+
+} // namespace trace
+
+#define TRACE_ZONE_CONCAT2(a, b) a##b
+#define TRACE_ZONE_CONCAT(a, b)  TRACE_ZONE_CONCAT2(a, b)
+
+// Records the rest of the current scope as a zone.
+#define TRACE_ZONE(name) trace::Zone TRACE_ZONE_CONCAT(traceZone, __LINE__)(name)
+
+#endif
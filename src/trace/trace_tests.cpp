@@ -0,0 +1,72 @@
+// Aseprite Trace Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include <gtest/gtest.h>
+
+#include "trace/trace.h"
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace trace;
+
+TEST(Trace, Disabled)
+{
+  start();
+  stop();
+  {
+    TRACE_ZONE("Disabled");
+  }
+  EXPECT_EQ(std::size_t(0), zones_count());
+}
+
+TEST(Trace, Zones)
+{
+  start();
+  {
+    TRACE_ZONE("Outer");
+    {
+      TRACE_ZONE("Inner \"quoted\"");
+    }
+    std::thread thread([] { TRACE_ZONE("Thread"); });
+    thread.join();
+  }
+  stop();
+  EXPECT_EQ(std::size_t(3), zones_count());
+
+  {
+    TRACE_ZONE("Stopped");
+  }
+  EXPECT_EQ(std::size_t(3), zones_count());
+
+  ASSERT_TRUE(save_chrome_json("_test_trace.json"));
+
+  std::ifstream f("_test_trace.json");
+  std::stringstream buf;
+  buf << f.rdbuf();
+  const std::string json = buf.str();
+  EXPECT_EQ(std::size_t(0), json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"Outer\""));
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"Inner \\\"quoted\\\"\""));
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"Thread\""));
+  EXPECT_EQ(std::string::npos, json.find("Stopped"));
+
+  // Start discards previous zones
+  start();
+  stop();
+  EXPECT_EQ(std::size_t(0), zones_count());
+}
+
+int main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,4 +1,4 @@
--- Copyright (C) 2019-2025  Igara Studio S.A.
+-- Copyright (C) 2019-2026  Igara Studio S.A.
 -- Copyright (C) 2018  David Capello
 --
 -- This file is released under the terms of the MIT license.
@@ -751,3 +751,158 @@ do
     end
   end
 end
+
+-- Bulk pixel access
+do
+  local function expect_array(a, b)
+    expect_eq(#a, #b)
+    for i=1,#b do
+      expect_eq(a[i], b[i])
+    end
+  end
+
+  local img = Image(3, 2, ColorMode.INDEXED)
+  img:setPixels({ 1, 2, 3,
+                  4, 5, 6 })
+  expect_img(img, { 1, 2, 3,
+                    4, 5, 6 })
+  expect_array(img:getPixels(), { 1, 2, 3, 4, 5, 6 })
+  expect_array(img:getPixels(Rectangle(1, 0, 2, 2)), { 2, 3, 5, 6 })
+  expect_array(img:getPixels(Rectangle(2, 1, 5, 5)), { 6 })
+
+  img:setPixels(Rectangle(0, 1, 2, 1), { 7, 8 })
+  expect_img(img, { 1, 2, 3,
+                    7, 8, 6 })
+
+  local ok = pcall(function() img:setPixels({ 1, 2 }) end)
+  assert(not ok)
+
+  -- mapPixels() replaces pixels with the returned values (nil keeps the pixel)
+  img:mapPixels(function(v, x, y)
+    if y == 0 then return v + x*10 end
+  end)
+  expect_img(img, { 1, 12, 23,
+                    7, 8,  6 })
+
+  img:mapPixels(function(v, x, y) return 0 end, Rectangle(1, 1, 2, 1))
+  expect_img(img, { 1, 12, 23,
+                    7, 0,  0 })
+
+  -- forEachRow() writes the row only when the function returns true
+  local rows = {}
+  img:forEachRow(function(row, y)
+    rows[#rows+1] = { row[1], row[2], row[3] }
+    row[1] = 9
+  end)
+  expect_eq(#rows, 2)
+  expect_array(rows[1], { 1, 12, 23 })
+  expect_array(rows[2], { 7, 0, 0 })
+  expect_img(img, { 1, 12, 23,
+                    7, 0,  0 })
+
+  img:forEachRow(function(row, y)
+    row[1] = y
+    return true
+  end, Rectangle(1, 0, 1, 2))
+  expect_img(img, { 1, 0, 23,
+                    7, 1, 0 })
+
+  -- Bytes of a rectangle
+  expect_eq(img:getBytes(Rectangle(1, 0, 2, 2)), string.char(0, 23, 1, 0))
+  img:setBytes(Rectangle(0, 0, 1, 2), string.char(4, 5))
+  expect_img(img, { 4, 0, 23,
+                    5, 1, 0 })
+  img:setBytes(string.char(1, 2, 3, 4, 5, 6))
+  expect_img(img, { 1, 2, 3,
+                    4, 5, 6 })
+
+  -- Bytes view
+  local view = img.bytesView
+  expect_eq(#view, 6)
+  expect_eq(view[1], 1)
+  expect_eq(view[6], 6)
+  expect_eq(view[7], nil)
+  expect_eq(view:sub(2, 3), string.char(2, 3))
+  expect_eq(view:sub(-2), string.char(5, 6))
+  view[1] = 10
+  view:set(5, string.char(20, 30))
+  expect_img(img, { 10, 2, 3,
+                    4, 20, 30 })
+  expect_eq(img.bytes, view:sub(1))
+end
+
+-- Bulk pixel access on a cel image (undoable)
+do
+  local spr = Sprite(2, 2)
+  local image = app.site.image
+  local r = rgba(255, 0, 0, 255)
+  image:mapPixels(function(v, x, y) return r end)
+  expect_img(image, { r, r, r, r })
+  app.undo()
+  expect_img(image, { 0, 0, 0, 0 })
+
+  image:forEachRow(function(row, y) end)
+  image:setPixels(Rectangle(1, 1, 1, 1), { r })
+  expect_img(image, { 0, 0, 0, r })
+  app.undo()
+  expect_img(image, { 0, 0, 0, 0 })
+end
+
+-- Nested modifications of cel images from Lua callbacks
+do
+  local sprA = Sprite(2, 2)
+  local a = app.site.image
+  local sprB = Sprite(2, 2)
+  local b = app.site.image
+  local r = rgba(255, 0, 0, 255)
+  local g = rgba(0, 255, 0, 255)
+  a:mapPixels(function(v, x, y)
+    b:mapPixels(function() return g end)
+    return r
+  end)
+  expect_img(a, { r, r, r, r })
+  expect_img(b, { g, g, g, g })
+end
+
+-- All write paths increment the image version (used to invalidate
+-- caches of the image like mipmaps)
+do
+  local img = Image(2, 2, ColorMode.INDEXED)
+  local v = img.version
+
+  for it in img:pixels() do
+    it(1)
+  end
+  expect_img(img, { 1, 1, 1, 1 })
+  assert(img.version > v)
+  v = img.version
+
+  img.bytes = string.char(2, 2, 2, 2)
+  expect_img(img, { 2, 2, 2, 2 })
+  assert(img.version > v)
+  v = img.version
+
+  img:clear(3)
+  assert(img.version > v)
+  v = img.version
+
+  img:drawImage(Image(1, 1, ColorMode.INDEXED), Point(0, 0))
+  assert(img.version > v)
+  v = img.version
+
+  img:flip()
+  assert(img.version > v)
+  v = img.version
+
+  -- Painting a cel with a tool
+  local spr = Sprite(4, 4)
+  local cel = spr.cels[1]
+  v = cel.image.version
+  app.useTool{ tool='pencil', color=Color(255, 0, 0), points={ Point(1, 1) } }
+  assert(cel.image.version > v)
+  v = cel.image.version
+
+  -- Clearing a cel (undoable)
+  cel.image:clear()
+  assert(cel.image.version > v)
+end